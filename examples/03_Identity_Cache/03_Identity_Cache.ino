@@ -0,0 +1,87 @@
+/* **************************************************
+*
+*   Example Code for running ScioSense APC1 on I²C
+*   with the module identity cached in EEPROM
+*
+*  **************************************************
+*/
+
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include <apc1.h>
+#include <Wire.h>
+
+#define IDENTITY_ADDRESS 0
+
+APC1 apc1;
+
+bool loadIdentity(void* context, Apc1_Identity* identity)
+{
+    EEPROM.get(IDENTITY_ADDRESS, *identity);
+    return true; // the library rejects the identity, if its checksum does not match
+}
+
+void storeIdentity(void* context, const Apc1_Identity* identity)
+{
+    EEPROM.put(IDENTITY_ADDRESS, *identity);
+    #ifdef ESP32
+      EEPROM.commit();
+    #endif
+}
+
+void setup() {
+    Serial.begin(9600);
+    Serial.println("");
+
+    #ifdef ESP32
+      EEPROM.begin(sizeof(Apc1_Identity));
+    #endif
+
+    Wire.begin();
+
+    // initializing APC1 on I²C bus
+    apc1.begin(&Wire);
+
+    // after the first boot, init() skips reading the module name, serial number and firmware version
+    Apc1_IdentityCache cache = { loadIdentity, storeIdentity, NULL };
+    apc1.setIdentityCache(cache);
+
+    while (apc1.init() == false) {
+        Serial.println("Error -- The APC1 is not connected.");
+        delay(1000);
+    }
+
+    if (apc1.getIdentityState() == APC1_IDENTITY_STATE_CACHED) {
+        Serial.print("Cached ");
+    }
+
+    Serial.print("Module Name: ");
+    Serial.print((char*)apc1.moduleName);
+
+    Serial.print(", FW version: ");
+    Serial.print(apc1.fwVersion);
+
+    Serial.print(", Serial No.: ");
+    Serial.println((unsigned long)apc1.serialNumber);
+}
+
+void loop() {
+    if (apc1.update() == RESULT_OK) {
+        // the first valid frame validates the cached identity against the firmware version
+        if (apc1.getIdentityState() == APC1_IDENTITY_STATE_VALIDATED) {
+            Serial.print("Validated, ");
+        }
+
+        // the cache belongs to another device or firmware; init() reads the identity and stores it again
+        if (apc1.getIdentityState() == APC1_IDENTITY_STATE_MISMATCH) {
+            Serial.println("Cached identity does not match, reading it again");
+            apc1.init();
+        }
+
+        Serial.print("PM2.5: ");
+        Serial.println(apc1.getPM_2_5());
+    }
+
+    delay(1000);
+}
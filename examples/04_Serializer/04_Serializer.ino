@@ -0,0 +1,51 @@
+/* **************************************************
+*
+*   Example Code for running ScioSense APC1 on I²C
+*   with every sample written as one line of JSON
+*
+*  **************************************************
+*/
+
+#include <Arduino.h>
+
+#define APC1_WITH_SERIALIZER
+#include <apc1.h>
+#include <Wire.h>
+
+
+APC1 apc1;
+
+// static, to keep the line buffer off the stack
+static char line[APC1_SERIALIZER_BUFFER_SIZE];
+
+
+void setup() {
+    Serial.begin(9600);
+    Serial.println("");
+
+    Wire.begin();
+
+    // initializing APC1 on I²C bus
+    apc1.begin(&Wire);
+
+    while (apc1.init() == false) {
+        Serial.println("Error -- The APC1 is not connected.");
+        delay(1000);
+    }
+}
+
+void loop() {
+    if (apc1.update() == RESULT_OK) {
+        // one pass over the frame and a single write, instead of one print() per value;
+        // use APC1_FORMAT_CSV or APC1_FORMAT_LINE_PROTOCOL for the other formats
+        const uint32_t fields = APC1_FIELD_MASK(APC1_FIELD_PM_1_0) | APC1_FIELD_MASK(APC1_FIELD_PM_2_5) | APC1_FIELD_MASK(APC1_FIELD_PM_10)
+                              | APC1_FIELD_MASK(APC1_FIELD_TVOC)   | APC1_FIELD_MASK(APC1_FIELD_ECO2)
+                              | APC1_FIELD_MASK(APC1_FIELD_T_COMP) | APC1_FIELD_MASK(APC1_FIELD_RH_COMP)
+                              | APC1_FIELD_MASK(APC1_FIELD_AQI)    | APC1_FIELD_MASK(APC1_FIELD_ERROR_CODE);
+
+        size_t length = apc1.serialize(line, sizeof(line), APC1_FORMAT_JSON, fields, millis());
+        Serial.write((const uint8_t*)line, length);
+    }
+
+    delay(1000);
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+/* **************************************************
+*
+*   Example Code for running ScioSense APC1 on I²C
+*   with threshold alerts; only state changes are reported
+*
+*  **************************************************
+*/
+
+#include <Arduino.h>
+
+#define APC1_WITH_ALERTS
+#include <apc1.h>
+#include <Wire.h>
+
+
+APC1 apc1;
+
+// thresholds are in the units of the measurement frame; T and RH in 0.1
+static const Apc1_AlertRule rules[] = {
+    APC1_ALERT_ABOVE(APC1_FIELD_PM_2_5, 35, 10, 5),                 // PM2.5 > 35 µg/m³ for 5 samples; clears at <= 25
+    APC1_ALERT_RISE (APC1_FIELD_TVOC, 200, 100, 1),                 // TVOC rises by more than 200 ppb from one sample to the next
+    APC1_ALERT_ABOVE(APC1_FIELD_RH_COMP, 700, 50, 10),              // RH > 70.0 % for 10 samples; clears at <= 65.0 %
+    APC1_ALERT_ERROR(APC1_ERROR_CODE_FAN_SPEED_TOO_LOW | APC1_ERROR_CODE_FAN_STARTUP_ERROR, 3),
+};
+static Apc1_AlertState states[sizeof(rules) / sizeof(rules[0])];
+static Apc1_AlertEngine alerts;
+
+static const char* const names[] = { "PM2.5 high", "TVOC spike", "RH high", "Fan error" };
+
+
+void onAlert(void* context, const Apc1_AlertEvent* event) {
+    // e.g. wake the radio and send the event instead of every sample
+    Serial.print(names[event->rule]);
+    Serial.print(event->active ? ": raised at " : ": cleared at ");
+    Serial.println(event->value);
+}
+
+void setup() {
+    Serial.begin(9600);
+    Serial.println("");
+
+    Wire.begin();
+
+    // initializing APC1 on I²C bus
+    apc1.begin(&Wire);
+
+    while (apc1.init() == false) {
+        Serial.println("Error -- The APC1 is not connected.");
+        delay(1000);
+    }
+
+    if (Apc1_AlertEngine_Init(&alerts, rules, states, sizeof(rules) / sizeof(rules[0]), onAlert, NULL) != RESULT_OK) {
+        Serial.println("Error -- Invalid alert rules.");
+    }
+    apc1.setAlerts(&alerts);
+}
+
+void loop() {
+    // the rules are evaluated by update() on every valid frame
+    apc1.update();
+
+    delay(1000);
+}
\ No newline at end of file
@@ -0,0 +1,66 @@
+/* **************************************************
+*
+*   Example Code for running ScioSense APC1 on I²C
+*   duty cycled: the fan runs only for short bursts
+*
+*  **************************************************
+*/
+
+#include <Arduino.h>
+
+#define APC1_WITH_POWER
+#include <apc1.h>
+#include <Wire.h>
+
+
+APC1 apc1;
+Apc1_PowerManager power;
+
+
+void setup() {
+    Serial.begin(9600);
+    Serial.println("");
+
+    Wire.begin();
+
+    // initializing APC1 on I²C bus
+    apc1.begin(&Wire);
+
+    while (apc1.init() == false) {
+        Serial.println("Error -- The APC1 is not connected.");
+        delay(1000);
+    }
+
+    // wakes up every 1 to 15 minutes, depending on how fast PM2.5 changes
+    Apc1_PowerConfig config;
+    Apc1_PowerManager_DefaultConfig(&config);
+    Apc1_PowerManager_Init(&power, &config, millis());
+}
+
+void loop() {
+    switch (Apc1_PowerManager_Run(&power, &apc1, millis())) {
+        case APC1_POWER_EVENT_SAMPLE:
+            Serial.print("PM2.5: ");
+            Serial.println(apc1.getPM_2_5());
+            break;
+
+        case APC1_POWER_EVENT_CYCLE:
+            Serial.print("Mean PM2.5: ");
+            Serial.print(power.cycle.mean);
+            Serial.print(", fan on for ");
+            Serial.print(power.cycle.fanOnTime / 1000);
+            Serial.print(" s, next cycle in ");
+            Serial.print(power.cycle.interval / 1000);
+            Serial.print(" s, duty cycle ");
+            Serial.print(Apc1_PowerManager_GetDutyCycle(&power) / 10.0f);
+            Serial.println(" %");
+            break;
+
+        case APC1_POWER_EVENT_ERROR:
+            Serial.println("Error -- The APC1 did not change its operating mode; retrying.");
+            break;
+    }
+
+    // a battery node would sleep here
+    delay(Apc1_PowerManager_GetDelay(&power, millis()));
+}
\ No newline at end of file
@@ -0,0 +1,113 @@
+/* **************************************************
+*
+*   Example Code for running ScioSense APC1 on I²C
+*   with a telemetry pipeline: the frames go to a serial log and
+*   to a slow radio without ever holding back the sensor polling
+*
+*  **************************************************
+*/
+
+#include <Arduino.h>
+
+// a pool and stage table for this pipeline only, instead of the defaults of 8 each: one slot for
+// Push and length + 1 for each of the two sinks; the acquisition, a transform and the two sinks
+#define APC1_PIPELINE_POOL_SIZE     5
+#define APC1_PIPELINE_MAX_STAGES    4
+
+#define APC1_WITH_SERIALIZER
+#define APC1_WITH_PIPELINE
+
+#include <apc1.h>
+#include <Wire.h>
+
+
+APC1 apc1;
+
+// static, as the pool holds several frames
+static Apc1_Pipeline pipeline;
+static uint8_t logSink;
+static uint8_t radioSink;
+
+// enough for the JSON of the four fields and the timestamp; APC1_SERIALIZER_BUFFER_SIZE fits any output
+static char line[128];
+static uint32_t radioBusyUntil = 0;
+
+
+uint32_t pipelineMillis() {
+    return millis();
+}
+
+// transform: frames with fan errors are not reported
+Result dropFanErrors(void* context, Apc1_PipelineFrame* frame) {
+    const uint32_t fanErrors = APC1_ERROR_CODE_FAN_SPEED_TOO_LOW | APC1_ERROR_CODE_FAN_STARTUP_ERROR;
+    return (Apc1_GetFieldValue(frame->measurementData, APC1_FIELD_ERROR_CODE) & fanErrors) ? RESULT_INVALID : RESULT_OK;
+}
+
+Result writeLog(void* context, const Apc1_PipelineFrame* frame) {
+    Apc1_Serializer serializer;
+    serializer.format       = APC1_FORMAT_JSON;
+    serializer.fieldMask    = APC1_FIELD_MASK(APC1_FIELD_PM_2_5) | APC1_FIELD_MASK(APC1_FIELD_TVOC) | APC1_FIELD_MASK(APC1_FIELD_T_COMP) | APC1_FIELD_MASK(APC1_FIELD_RH_COMP);
+    serializer.hasTimestamp = true;
+    serializer.measurement  = NULL;
+
+    size_t length = Apc1_Serialize(&serializer, frame->measurementData, frame->timestamp, line, sizeof(line));
+    Serial.write((const uint8_t*)line, length);
+    return RESULT_OK;
+}
+
+// stands in for a radio which can send once every 10 s; while busy, the frame is kept
+// and newer frames replace each other in its queue of one
+Result sendRadio(void* context, const Apc1_PipelineFrame* frame) {
+    if ((int32_t)(millis() - radioBusyUntil) < 0) {
+        return RESULT_NOT_ALLOWED;
+    }
+
+    Serial.print("radio: PM2.5 ");
+    Serial.print(Apc1_GetFieldValue(frame->measurementData, APC1_FIELD_PM_2_5));
+    Serial.print(" of frame ");
+    Serial.println(frame->sequence);
+    radioBusyUntil = millis() + 10000;
+    return RESULT_OK;
+}
+
+void setup() {
+    Serial.begin(9600);
+    Serial.println("");
+
+    Wire.begin();
+
+    // initializing APC1 on I²C bus
+    apc1.begin(&Wire);
+
+    while (apc1.init() == false) {
+        Serial.println("Error -- The APC1 is not connected.");
+        delay(1000);
+    }
+
+    Apc1_Pipeline_Init(&pipeline, pipelineMillis, NULL);
+    Apc1_Pipeline_AddTransform(&pipeline, dropFanErrors, NULL);
+    logSink   = Apc1_Pipeline_AddSink(&pipeline, writeLog, NULL, APC1_PIPELINE_POLICY_DROP_OLDEST, 1);
+    radioSink = Apc1_Pipeline_AddSink(&pipeline, sendRadio, NULL, APC1_PIPELINE_POLICY_COALESCE, 1);
+}
+
+void loop() {
+    if (apc1.update() == RESULT_OK) {
+        apc1.addToPipeline(pipeline, millis() / 1000);
+    }
+
+    // one frame per sink and loop; the sinks could also be serviced by other tasks
+    Apc1_Pipeline_ServiceAll(&pipeline, 1);
+
+    static uint8_t loops = 0;
+    if (++loops == 60) {
+        Apc1_PipelineStats stats;
+        Apc1_Pipeline_GetStats(&pipeline, radioSink, &stats);
+        Serial.print("radio: frames replaced before sending: ");
+        Serial.print(stats.coalesced);
+        Serial.print(", max latency in ms: ");
+        Serial.println(stats.latencyMax);
+        loops = 0;
+    }
+
+    delay(1000);
+}
\ No newline at end of file
@@ -0,0 +1,305 @@
+// Feeds simulated 1 Hz frames with outages to an Apc1_AqiEngine and checks every hourly result
+// against a double precision reference which recomputes hourly means, NowCast, daily means, EPA
+// AQI and CAQI from the raw frames of the last 24 hours. It prints the largest deviations and the
+// cost per frame of the engine and of recomputing over the window, in ns and, on x86, in cycles.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_aqi_bench apc1_aqi_bench.cpp
+//   ./apc1_aqi_bench [days]
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Aqi.h"
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static uint64_t cycles()
+{
+#ifdef HAVE_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// the reference tables in µg/m³, independent of the ones of the engine
+struct Band
+{
+    double low, high;
+    double indexLow, indexHigh;
+};
+
+static constexpr Band US_PM25[]         = { { 0, 9.0, 0, 50 }, { 9.1, 35.4, 51, 100 }, { 35.5, 55.4, 101, 150 }, { 55.5, 125.4, 151, 200 }, { 125.5, 225.4, 201, 300 }, { 225.5, 325.4, 301, 500 } };
+static constexpr Band US_PM10[]         = { { 0, 54, 0, 50 }, { 55, 154, 51, 100 }, { 155, 254, 101, 150 }, { 255, 354, 151, 200 }, { 355, 424, 201, 300 }, { 425, 604, 301, 500 } };
+static constexpr Band CAQI_PM25[]       = { { 0, 15, 0, 25 }, { 15, 30, 25, 50 }, { 30, 55, 50, 75 }, { 55, 110, 75, 100 } };
+static constexpr Band CAQI_PM10[]       = { { 0, 25, 0, 25 }, { 25, 50, 25, 50 }, { 50, 90, 50, 75 }, { 90, 180, 75, 100 } };
+static constexpr Band CAQI_DAILY_PM25[] = { { 0, 10, 0, 25 }, { 10, 20, 25, 50 }, { 20, 30, 50, 75 }, { 30, 60, 75, 100 } };
+static constexpr Band CAQI_DAILY_PM10[] = { { 0, 15, 0, 25 }, { 15, 30, 25, 50 }, { 30, 50, 50, 75 }, { 50, 100, 75, 100 } };
+
+static_assert(sizeof(US_PM25) / sizeof(Band) == 6 && sizeof(CAQI_PM10) / sizeof(Band) == 4, "band tables");
+
+static constexpr double NONE = -1;
+
+template<size_t N>
+static double interpolate(const Band (&bands)[N], const double c, const double max)
+{
+    if (c < 0)
+    {
+        return NONE;
+    }
+
+    const Band* band = &bands[N - 1];
+    for (const Band& b : bands)
+    {
+        if (c <= b.high)
+        {
+            band = &b;
+            break;
+        }
+    }
+
+    return std::min(floor((band->indexHigh - band->indexLow) / (band->high - band->low) * (c - band->low) + band->indexLow + 0.5), max);
+}
+
+struct Reference
+{
+    double hourly25, hourly10;
+    double nowcast25, nowcast10;
+    double daily25, daily10;
+    double usAqi, usAqiDaily, caqi, caqiDaily;
+};
+
+struct Sample
+{
+    uint32_t timestamp;
+    uint16_t pm25, pm10;
+};
+
+static double nowcast(const double* hours)
+{
+    double min = 1e9, max = 0;
+    int recent = 0;
+    for (int i = 0; i < 12; i++)
+    {
+        if (hours[i] >= 0)
+        {
+            min = std::min(min, hours[i]);
+            max = std::max(max, hours[i]);
+            recent += (i < 3) ? 1 : 0;
+        }
+    }
+    if (recent < 2)
+    {
+        return NONE;
+    }
+    if (max == 0)
+    {
+        return 0;
+    }
+
+    const double w = std::max(min / max, 0.5);
+    double sum = 0, weights = 0;
+    for (int i = 0; i < 12; i++)
+    {
+        if (hours[i] >= 0)
+        {
+            sum     += pow(w, i) * hours[i];
+            weights += pow(w, i);
+        }
+    }
+
+    return floor(sum / weights * 10 + 1e-9) / 10;
+}
+
+// everything from the frames of the 24 hours up to and including the hour `last`
+static Reference recompute(const std::deque<Sample>& window, const uint32_t last, const uint16_t minSamples)
+{
+    double sum25[24] = { 0 }, sum10[24] = { 0 };
+    int count[24] = { 0 };
+    for (const Sample& sample : window)
+    {
+        const uint32_t age = last - sample.timestamp / 3600;
+        if (age < 24)
+        {
+            sum25[age] += sample.pm25;
+            sum10[age] += sample.pm10;
+            count[age]++;
+        }
+    }
+
+    double hours25[24], hours10[24];
+    double day25 = 0, day10 = 0;
+    int valid = 0;
+    for (int i = 0; i < 24; i++)
+    {
+        const bool enough = count[i] > 0 && count[i] >= minSamples;
+        hours25[i] = enough ? floor(sum25[i] / count[i] * 10 + 1e-9) / 10 : NONE;
+        hours10[i] = enough ? floor(sum10[i] / count[i] * 10 + 1e-9) / 10 : NONE;
+        if (enough)
+        {
+            day25 += hours25[i];
+            day10 += hours10[i];
+            valid++;
+        }
+    }
+
+    Reference r;
+    r.hourly25      = hours25[0];
+    r.hourly10      = hours10[0];
+    r.nowcast25     = nowcast(hours25);
+    r.nowcast10     = nowcast(hours10);
+    r.daily25       = (valid >= 18) ? floor(day25 / valid * 10 + 1e-9) / 10 : NONE;
+    r.daily10       = (valid >= 18) ? floor(day10 / valid * 10 + 1e-9) / 10 : NONE;
+    r.usAqi         = std::max(interpolate(US_PM25, r.nowcast25, 500), interpolate(US_PM10, (r.nowcast10 < 0) ? NONE : floor(r.nowcast10), 500));
+    r.usAqiDaily    = std::max(interpolate(US_PM25, r.daily25, 500), interpolate(US_PM10, (r.daily10 < 0) ? NONE : floor(r.daily10), 500));
+    r.caqi          = std::max(interpolate(CAQI_PM25, r.hourly25, 1e9), interpolate(CAQI_PM10, r.hourly10, 1e9));
+    r.caqiDaily     = std::max(interpolate(CAQI_DAILY_PM25, r.daily25, 1e9), interpolate(CAQI_DAILY_PM10, r.daily10, 1e9));
+    return r;
+}
+
+struct Deviation
+{
+    double max          = 0;
+    size_t mismatches   = 0;    // available in one, missing in the other
+    size_t different    = 0;
+
+    void add(const uint16_t value, const double reference, const double scale)
+    {
+        if ((value == APC1_AQI_NONE) != (reference < 0))
+        {
+            mismatches++;
+            return;
+        }
+        if (value == APC1_AQI_NONE)
+        {
+            return;
+        }
+
+        const double d = fabs(value * scale - reference);
+        max         = std::max(max, d);
+        different  += (d > 1e-6) ? 1 : 0;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    const uint32_t days = (argc > 1) ? strtoul(argv[1], NULL, 10) : 14;
+
+    Apc1_AqiConfig config;
+    Apc1_Aqi_DefaultConfig(&config);
+    Apc1_AqiEngine engine;
+    Apc1_Aqi_Init(&engine, &config);
+
+    // 1 Hz frames with a few outages of up to 3 h, starting at an odd time
+    ScioSense::Apc1Simulator::Environment environment(11);
+    ScioSense::Apc1Simulator::Random random(11);
+    std::vector<uint8_t> frames;
+    std::vector<uint32_t> timestamps;
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    const uint32_t first = 1700000000u + 1234;
+    uint32_t timestamp = first;
+
+    while (timestamp < first + days * 86400)
+    {
+        environment.step((uint64_t)timestamp * 1000);
+        environment.frame(frame, 0x25);
+        frames.insert(frames.end(), frame, frame + sizeof(frame));
+        timestamps.push_back(timestamp);
+
+        timestamp += (random.uniform() < 2.0f / 86400) ? 1 + random.next() % 10800 : 1;
+    }
+    const size_t count = timestamps.size();
+
+    // the engine, checked at every closed hour; µg/m³ deviations up to 0.1 come from the Q12 NowCast weights
+    Deviation hourly, nowcast, daily, usAqi, usAqiDaily, caqi, caqiDaily;
+    std::deque<Sample> window;
+    size_t hours = 0, available = 0;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        const uint8_t* data = &frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+        if (Apc1_Aqi_Add(&engine, timestamps[i], data) == RESULT_OK)
+        {
+            const Apc1_AqiIndices& x    = engine.indices;
+            const Reference r           = recompute(window, x.hour, config.minSamples);
+
+            hourly.add(x.hourly.pm25, r.hourly25, 0.1);         hourly.add(x.hourly.pm10, r.hourly10, 0.1);
+            nowcast.add(x.nowcast.pm25, r.nowcast25, 0.1);      nowcast.add(x.nowcast.pm10, r.nowcast10, 0.1);
+            daily.add(x.daily.pm25, r.daily25, 0.1);            daily.add(x.daily.pm10, r.daily10, 0.1);
+            usAqi.add(x.usAqi, r.usAqi, 1);
+            usAqiDaily.add(x.usAqiDaily, r.usAqiDaily, 1);
+            caqi.add(x.caqi, r.caqi, 1);
+            caqiDaily.add(x.caqiDaily, r.caqiDaily, 1);
+            hours++;
+            available += (x.usAqi != APC1_AQI_NONE) ? 1 : 0;
+        }
+
+        window.push_back({ timestamps[i], (uint16_t)Apc1_GetFieldValue(data, config.pm25Field), (uint16_t)Apc1_GetFieldValue(data, config.pm10Field) });
+        while (timestamps[i] / 3600 - window.front().timestamp / 3600 >= 25)
+        {
+            window.pop_front();
+        }
+    }
+
+    printf("%zu frames over %u days, %zu hours closed, %zu with a NowCast AQI\n\n", count, days, hours, available);
+    printf("%-16s %12s %12s %12s\n", "PM in µg/m³", "max |delta|", "different", "mismatches");
+    const struct { const char* name; const Deviation* d; } rows[] =
+    {
+        { "hourly PM",     &hourly  }, { "NowCast PM",    &nowcast }, { "daily PM",      &daily   },
+        { "EPA AQI",       &usAqi   }, { "EPA AQI daily", &usAqiDaily }, { "CAQI",        &caqi    }, { "CAQI daily",    &caqiDaily },
+    };
+    size_t errors = 0;
+    for (const auto& row : rows)
+    {
+        printf("%-14s %12.1f %12zu %12zu\n", row.name, row.d->max, row.d->different, row.d->mismatches);
+        errors += row.d->mismatches;
+    }
+
+    // cost per frame: the engine over all frames, recomputing over the window for a sample of them
+    Apc1_Aqi_Init(&engine, &config);
+    double t        = seconds();
+    uint64_t c      = cycles();
+    for (size_t i = 0; i < count; i++)
+    {
+        Apc1_Aqi_Add(&engine, timestamps[i], &frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH]);
+    }
+    const double engineNs       = (seconds() - t) / count * 1e9;
+    const double engineCycles   = (double)(cycles() - c) / count;
+
+    const size_t recomputes = std::min<size_t>(2000, window.size());
+    volatile double sink    = 0;
+    t = seconds();
+    c = cycles();
+    for (size_t i = 0; i < recomputes; i++)
+    {
+        sink = sink + recompute(window, window.back().timestamp / 3600, config.minSamples).usAqi;
+    }
+    const double windowNs       = (seconds() - t) / recomputes * 1e9;
+    const double windowCycles   = (double)(cycles() - c) / recomputes;
+
+    printf("\n%-30s %12s %12s\n", "per frame", "ns", "cycles");
+    printf("%-30s %12.1f %12.0f\n", "Apc1_Aqi_Add", engineNs, engineCycles);
+    printf("%-30s %12.1f %12.0f\n", "recompute over 24 h of frames", windowNs, windowCycles);
+#ifndef HAVE_TSC
+    printf("(no cycle counter on this platform)\n");
+#endif
+
+    return errors ? 2 : 0;
+}
@@ -0,0 +1,229 @@
+// Writes simulated APC1 measurements to a columnar archive (apc1_columnar.h) and queries it.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_archive apc1_archive.cpp
+//   ./apc1_archive write <file> [--days 365] [--interval ms]
+//   ./apc1_archive query <file> <field> [--from ms] [--to ms] [--above value]
+//   ./apc1_archive export <file> <field> [--from ms] [--to ms]
+//   ./apc1_archive distribution <file> [--from ms] [--to ms]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <vector>
+
+#include "apc1_columnar.h"
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Distribution.h"
+
+using namespace ScioSense::Apc1Columnar;
+
+static const char* const fieldNames[APC1_FIELD_COUNT] =
+{
+    "pm1.0", "pm2.5", "pm10", "pm1.0air", "pm2.5air", "pm10air",
+    "n0.3", "n0.5", "n1.0", "n2.5", "n5.0", "n10",
+    "tvoc", "eco2", "no2", "t", "rh", "traw", "rhraw",
+    "rs0", "rs1", "rs2", "rs3", "aqi", "error"
+};
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static uint64_t option(int argc, char** argv, const char* name, const uint64_t fallback)
+{
+    for (int i = 0; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], name) == 0)
+        {
+            return strtoull(argv[i + 1], NULL, 10);
+        }
+    }
+    return fallback;
+}
+
+static int write(const char* path, int argc, char** argv)
+{
+    const uint64_t days     = option(argc, argv, "--days", 365);
+    const uint64_t interval = option(argc, argv, "--interval", 1000);
+    const uint64_t rows     = days * 86400000ull / interval;
+
+    Writer writer;
+    if (!writer.open(path))
+    {
+        fprintf(stderr, "%s: cannot open or field mask mismatch\n", path);
+        return 1;
+    }
+
+    ScioSense::Apc1Simulator::Random jitter(7);
+    ScioSense::Apc1Simulator::Environment environment(1);
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    uint64_t timestamp = writer.lastTimestamp() ? writer.lastTimestamp() + interval : 1735689600000ull;  // 2025-01-01
+
+    const double start = seconds();
+    for (uint64_t i = 0; i < rows; i++)
+    {
+        environment.step(timestamp);
+        environment.frame(frame, 0x20);
+        if (!writer.append(timestamp, frame))
+        {
+            fprintf(stderr, "append failed\n");
+            return 1;
+        }
+        timestamp += interval + (jitter.next() % 5);
+    }
+    writer.close();
+
+    struct stat info;
+    stat(path, &info);
+    printf("%llu rows in %.2f s; %lld bytes, %.2f bytes/row (raw frames: 64)\n",
+        (unsigned long long)rows, seconds() - start, (long long)info.st_size, (double)info.st_size / (double)(rows ? rows : 1));
+    return 0;
+}
+
+static int query(const Reader& reader, const Apc1_Field field, int argc, char** argv)
+{
+    const uint64_t from     = option(argc, argv, "--from", 0);
+    const uint64_t to       = option(argc, argv, "--to", UINT64_MAX);
+    const uint32_t above    = (uint32_t)option(argc, argv, "--above", 250);
+
+    double t = seconds();
+    const Aggregate aggregate = reader.aggregate(field, from, to);
+    const double statsTime = seconds() - t;
+
+    t = seconds();
+    Aggregate scanned;
+    reader.scan(field, from, to, [&](uint64_t, uint32_t value) { scanned.add(value); });
+    const double scanTime = seconds() - t;
+
+    t = seconds();
+    const uint64_t count = reader.countAbove(field, above, from, to);
+    const double countTime = seconds() - t;
+
+    printf("%s: %llu rows, min %u, max %u, mean %.2f\n", fieldNames[field],
+        (unsigned long long)aggregate.count, aggregate.min, aggregate.max, aggregate.mean());
+    printf("  aggregate from statistics  %10.3f ms\n", statsTime * 1e3);
+    printf("  full decode scan           %10.3f ms (%.2f ns/row, %s)\n", scanTime * 1e3, scanTime * 1e9 / (double)(scanned.count ? scanned.count : 1),
+        (scanned.sum == aggregate.sum && scanned.count == aggregate.count) ? "matches" : "MISMATCH");
+    printf("  rows above %-6u %9llu  %10.3f ms\n", above, (unsigned long long)count, countTime * 1e3);
+
+    return (scanned.sum == aggregate.sum && scanned.count == aggregate.count) ? 0 : 2;
+}
+
+// writes the size distribution of every row as CSV; the particle count columns are decoded
+// into one array each and processed with Apc1_Distribution_Batch
+static int distribution(const Reader& reader, int argc, char** argv)
+{
+    const uint64_t from = option(argc, argv, "--from", 0);
+    const uint64_t to   = option(argc, argv, "--to", UINT64_MAX);
+    std::vector<uint64_t> timestamps;
+    std::vector<uint16_t> cumulative[APC1_DISTRIBUTION_BINS];
+
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        if (!(reader.fieldMask() & APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_0_3 + b)))
+        {
+            fprintf(stderr, "%s: field not in archive\n", fieldNames[APC1_FIELD_NOPARTICLES_0_3 + b]);
+            return 1;
+        }
+    }
+
+    double t = seconds();
+    reader.scan(APC1_FIELD_NOPARTICLES_0_3, from, to, [&](uint64_t timestamp, uint32_t value)
+    {
+        timestamps.push_back(timestamp);
+        cumulative[0].push_back((uint16_t)value);
+    });
+    for (uint8_t b = 1; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        cumulative[b].reserve(timestamps.size());
+        reader.scan(APC1_FIELD_NOPARTICLES_0_3 + b, from, to, [&](uint64_t, uint32_t value) { cumulative[b].push_back((uint16_t)value); });
+    }
+    const double decodeTime = seconds() - t;
+
+    const size_t rows = timestamps.size();
+    std::vector<float> numberTotal(rows), massTotal(rows), gmd(rows), gsd(rows);
+    Apc1_DistributionColumns columns = { };
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        columns.cumulative[b] = cumulative[b].data();
+    }
+    columns.numberTotal = numberTotal.data();
+    columns.massTotal   = massTotal.data();
+    columns.gmd         = gmd.data();
+    columns.gsd         = gsd.data();
+
+    t = seconds();
+    Apc1_Distribution_Batch(&columns, rows, APC1_DISTRIBUTION_DEFAULT_DENSITY);
+    const double batchTime = seconds() - t;
+
+    printf("timestamp,number_m3,mass_ug_m3,gmd_um,gsd\n");
+    for (size_t i = 0; i < rows; i++)
+    {
+        printf("%llu,%.0f,%.2f,%.3f,%.3f\n", (unsigned long long)timestamps[i], numberTotal[i], massTotal[i], gmd[i], gsd[i]);
+    }
+    fprintf(stderr, "%zu rows: decode %.3f ms, distribution %.3f ms (%.2f ns/row)\n", rows, decodeTime * 1e3, batchTime * 1e3,
+        batchTime * 1e9 / (double)(rows ? rows : 1));
+
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+        fprintf(stderr, "usage: %s write <file> [--days n] [--interval ms]\n"
+                        "       %s query|export <file> <field> [--from ms] [--to ms] [--above value]\n"
+                        "       %s distribution <file> [--from ms] [--to ms]\n", argv[0], argv[0], argv[0]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "write") == 0)
+    {
+        return write(argv[2], argc, argv);
+    }
+
+    Reader reader;
+    if (!reader.open(argv[2]))
+    {
+        fprintf(stderr, "%s: not an APC1 archive\n", argv[2]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "distribution") == 0)
+    {
+        return distribution(reader, argc, argv);
+    }
+
+    if (argc < 4)
+    {
+        fprintf(stderr, "%s: no field given\n", argv[1]);
+        return 1;
+    }
+
+    Apc1_Field field = APC1_FIELD_COUNT;
+    for (uint8_t f = 0; f < APC1_FIELD_COUNT; f++)
+    {
+        field = (strcmp(argv[3], fieldNames[f]) == 0) ? f : field;
+    }
+    if (field == APC1_FIELD_COUNT || !(reader.fieldMask() & APC1_FIELD_MASK(field)))
+    {
+        fprintf(stderr, "%s: field not in archive\n", argv[3]);
+        return 1;
+    }
+
+    if (strcmp(argv[1], "export") == 0)
+    {
+        reader.scan(field, option(argc, argv, "--from", 0), option(argc, argv, "--to", UINT64_MAX), [](uint64_t timestamp, uint32_t value)
+        {
+            printf("%llu,%u\n", (unsigned long long)timestamp, value);
+        });
+        return 0;
+    }
+
+    return query(reader, field, argc, argv);
+}
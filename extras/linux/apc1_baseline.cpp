@@ -0,0 +1,199 @@
+// Runs months of simulated 1 Hz frames through Apc1_Baseline. The gas resistances of the simulator
+// get a slow drift and a temperature and humidity dependence, and the ratios of these trackers are
+// compared with those of a tracker on the undisturbed resistances:
+//
+//      compensated     Apc1_Baseline with the default T/RH coefficients
+//      uncompensated   Apc1_Baseline with T/RH coefficients of 0
+//      fixed           RS divided by its mean over the first hour, i.e. without tracking
+//      restored        a reboot halfway: a new Apc1_Baseline loads the state the first one stored
+//      cold            the same reboot without a stored state
+//
+// It prints the mean and 99th percentile of |ln ratio - ln ratio of the reference| after the first
+// day (for restored and cold: in the day after the reboot), and the cost of an update.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_baseline apc1_baseline.cpp
+//   ./apc1_baseline [days] [drift % over the run]
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Baseline.h"
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// the persistent memory of the node
+struct Memory
+{
+    Apc1_BaselineState  state;
+    bool                valid   = false;
+    size_t              stores  = 0;
+};
+
+static bool load(void* context, Apc1_BaselineState* state)
+{
+    const Memory* memory = (const Memory*)context;
+    *state = memory->state;
+    return memory->valid;
+}
+
+static void store(void* context, const Apc1_BaselineState* state)
+{
+    Memory* memory  = (Memory*)context;
+    memory->state   = *state;
+    memory->valid   = true;
+    memory->stores++;
+}
+
+struct Error
+{
+    std::vector<float> values;
+
+    void add(const float ratio, const float reference)
+    {
+        values.push_back(fabsf(logf(ratio) - logf(reference)));
+    }
+
+    void print(const char* name)
+    {
+        double sum = 0;
+        for (float value : values)
+        {
+            sum += value;
+        }
+        std::sort(values.begin(), values.end());
+        const float p99 = values.empty() ? 0.0f : values[(size_t)(values.size() * 0.99)];
+        printf("%-16s %12.4f %12.4f\n", name, values.empty() ? 0.0 : sum / values.size(), p99);
+    }
+};
+
+int main(int argc, char** argv)
+{
+    const uint32_t days     = (argc > 1) ? strtoul(argv[1], NULL, 10) : 60;
+    const float drift       = (argc > 2) ? strtof(argv[2], NULL) : -30.0f;
+    const uint32_t duration = days * 86400;
+    const uint32_t first    = 1700000000u;
+    const uint32_t reboot   = first + duration / 2;
+
+    // the true sensitivities differ a bit from the default coefficients
+    static const float temperatureSensitivity[APC1_BASELINE_CHANNELS] = { -0.018f, -0.022f, -0.020f, -0.017f };
+    static const float humiditySensitivity[APC1_BASELINE_CHANNELS]    = { -0.011f, -0.009f, -0.012f, -0.010f };
+
+    Apc1_BaselineConfig config;
+    Apc1_Baseline_DefaultConfig(&config);
+    Apc1_BaselineConfig uncompensatedConfig = config;
+    for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+    {
+        uncompensatedConfig.temperatureCoefficient[channel] = 0.0f;
+        uncompensatedConfig.humidityCoefficient[channel]    = 0.0f;
+    }
+
+    Memory memory;
+    const Apc1_BaselineStore persistence = { load, store, &memory };
+    Apc1_Baseline reference, compensated, uncompensated, restored, cold;
+    Apc1_Baseline_Init(&reference, &config, NULL);
+    Apc1_Baseline_Init(&compensated, &config, &persistence);
+    Apc1_Baseline_Init(&uncompensated, &uncompensatedConfig, NULL);
+
+    ScioSense::Apc1Simulator::Environment environment(3);
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    uint8_t disturbed[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    double fixedSum[APC1_BASELINE_CHANNELS]     = { 0 };
+    float fixedBaseline[APC1_BASELINE_CHANNELS] = { 0 };
+    Error errorCompensated, errorUncompensated, errorFixed, errorRestored, errorCold;
+    std::vector<uint8_t> lastDay;
+    bool rebooted = false;
+
+    for (uint32_t timestamp = first; timestamp < first + duration; timestamp++)
+    {
+        const uint32_t elapsed = timestamp - first;
+        environment.step((uint64_t)timestamp * 1000);
+        environment.frame(frame, 0x25);
+
+        const float t   = (float)(int16_t)Apc1_GetFieldValue(frame, APC1_FIELD_T_COMP) * 0.1f;
+        const float rh  = (float)Apc1_GetFieldValue(frame, APC1_FIELD_RH_COMP) * 0.1f;
+        std::copy(frame, frame + sizeof(frame), disturbed);
+        for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+        {
+            const float rs      = (float)Apc1_GetFieldValue(frame, APC1_FIELD_RS0 + channel);
+            const float factor  = expf(log1pf(drift / 100.0f * elapsed / duration) + temperatureSensitivity[channel] * (t - 25.0f) + humiditySensitivity[channel] * (rh - 50.0f));
+            Apc1_SetFieldValue(disturbed, APC1_FIELD_RS0 + channel, (uint32_t)(rs * factor));
+        }
+
+        if (timestamp == reboot)
+        {
+            // power loss: the state stored last survives; the cold node has lost it
+            Apc1_Baseline_Init(&restored, &config, &persistence);
+            Apc1_Baseline_Init(&cold, &config, NULL);
+            rebooted = true;
+        }
+
+        Apc1_Baseline_Add(&reference, timestamp, frame);
+        Apc1_Baseline_Add(&compensated, timestamp, disturbed);
+        Apc1_Baseline_Add(&uncompensated, timestamp, disturbed);
+        if (rebooted)
+        {
+            Apc1_Baseline_Add(&restored, timestamp, disturbed);
+            Apc1_Baseline_Add(&cold, timestamp, disturbed);
+        }
+        if (duration - elapsed <= 86400)
+        {
+            lastDay.insert(lastDay.end(), disturbed, disturbed + sizeof(disturbed));
+        }
+
+        for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+        {
+            const float rs = (float)Apc1_GetFieldValue(disturbed, APC1_FIELD_RS0 + channel);
+            if (elapsed < 3600)
+            {
+                fixedSum[channel]      += logf(rs);
+                fixedBaseline[channel]  = (float)(fixedSum[channel] / (elapsed + 1));
+            }
+
+            const float expected = Apc1_Baseline_GetRatio(&reference, channel);
+            if (elapsed >= 86400)
+            {
+                errorCompensated.add(Apc1_Baseline_GetRatio(&compensated, channel), expected);
+                errorUncompensated.add(Apc1_Baseline_GetRatio(&uncompensated, channel), expected);
+                errorFixed.add(expf(logf(rs) - fixedBaseline[channel]), expected);
+            }
+            if (rebooted && timestamp - reboot < 86400)
+            {
+                errorRestored.add(Apc1_Baseline_GetRatio(&restored, channel), expected);
+                errorCold.add(Apc1_Baseline_GetRatio(&cold, channel), expected);
+            }
+        }
+    }
+
+    // cost of an update, replaying the last day into a new tracker
+    const size_t replay = lastDay.size() / APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH;
+    Apc1_Baseline timed;
+    Apc1_Baseline_Init(&timed, &config, NULL);
+    const double start = seconds();
+    for (size_t i = 0; i < replay; i++)
+    {
+        Apc1_Baseline_Add(&timed, first + (uint32_t)i, &lastDay[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH]);
+    }
+    const double cost = (seconds() - start) / replay;
+
+    printf("%u days at 1 Hz, drift %.0f %%, %zu states stored\n\n", days, drift, memory.stores);
+    printf("%-16s %12s %12s\n", "|ln ratio error|", "mean", "p99");
+    errorCompensated.print("compensated");
+    errorUncompensated.print("uncompensated");
+    errorFixed.print("fixed");
+    errorRestored.print("restored");
+    errorCold.print("cold");
+    printf("\nupdate %.1f ns, %zu bytes per tracker, %zu bytes stored\n", cost * 1e9, sizeof(Apc1_Baseline), sizeof(Apc1_BaselineState));
+
+    return 0;
+}
@@ -0,0 +1,144 @@
+#ifndef SCIOSENSE_APC1_BINARY_H
+#define SCIOSENSE_APC1_BINARY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "lib/apc1/ScioSense_Apc1_Binary.h"
+
+namespace ScioSense::Apc1Binary
+{
+    // Host side decoders for the uplink encodings of ScioSense_Apc1_Binary.h.
+
+    struct Measurement
+    {
+        uint8_t     schema;
+        uint64_t    serialNumber;
+        uint16_t    fwVersion;
+        uint64_t    timestamp;                      // 0 if not sent
+        uint32_t    fieldMask;                      // APC1_FIELD_MASK of the decoded values
+        uint32_t    values[APC1_FIELD_COUNT];       // unscaled, as in the measurement frame
+    };
+
+    static inline bool readCbor(const uint8_t*& data, const uint8_t* end, uint8_t& major, uint64_t& value)
+    {
+        if (data >= end)
+        {
+            return false;
+        }
+
+        major               = *data >> 5;
+        const uint8_t info  = *data++ & 0x1F;
+        if (info < 24)
+        {
+            value = info;
+            return true;
+        }
+        if (info > 27)
+        {
+            return false;                           // indefinite lengths and reserved values are never sent
+        }
+
+        const uint8_t size = (uint8_t)(1 << (info - 24));
+        if (end - data < size)
+        {
+            return false;
+        }
+
+        value = 0;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            value = (value << 8) | *data++;
+        }
+        return true;
+    }
+
+    // decodes a map written by Apc1_EncodeCbor; unknown keys are skipped if they hold an integer
+    static inline bool decodeCbor(const uint8_t* data, const size_t size, Measurement& measurement)
+    {
+        const uint8_t* end = data + size;
+        uint8_t major;
+        uint64_t entries;
+
+        measurement = Measurement();
+        if (!readCbor(data, end, major, entries) || major != 5)
+        {
+            return false;
+        }
+
+        for (uint64_t i = 0; i < entries; i++)
+        {
+            uint8_t keyMajor, valueMajor;
+            uint64_t key, value;
+            if (!readCbor(data, end, keyMajor, key) || !readCbor(data, end, valueMajor, value) || keyMajor > 1 || valueMajor != 0)
+            {
+                return false;
+            }
+
+            if (keyMajor == 1)
+            {
+                switch (-1 - (int64_t)key)
+                {
+                    case APC1_CBOR_KEY_SCHEMA:          measurement.schema          = (uint8_t)value;   break;
+                    case APC1_CBOR_KEY_SERIAL_NUMBER:   measurement.serialNumber    = value;            break;
+                    case APC1_CBOR_KEY_FW_VERSION:      measurement.fwVersion       = (uint16_t)value;  break;
+                    case APC1_CBOR_KEY_TIMESTAMP:       measurement.timestamp       = value;            break;
+                    default:                                                                            break;
+                }
+            }
+            else if (key < APC1_FIELD_COUNT)
+            {
+                measurement.values[key] = (uint32_t)value;
+                measurement.fieldMask  |= APC1_FIELD_MASK(key);
+            }
+        }
+
+        return data == end && measurement.schema == APC1_BINARY_SCHEMA_VERSION;
+    }
+
+    static inline uint64_t readPacked(const uint8_t*& data, const uint8_t size)
+    {
+        uint64_t value = 0;
+        for (uint8_t i = 0; i < size; i++)
+        {
+            value = (value << 8) | *data++;
+        }
+        return value;
+    }
+
+    // decodes the fixed layout written by Apc1_EncodePacked
+    static inline bool decodePacked(const uint8_t* data, const size_t size, Measurement& measurement)
+    {
+        measurement = Measurement();
+        if (size != APC1_BINARY_PACKED_SIZE || data[0] != APC1_BINARY_SCHEMA_VERSION)
+        {
+            return false;
+        }
+
+        measurement.schema          = (uint8_t)readPacked(data, 1);
+        measurement.serialNumber    = readPacked(data, 8);
+        measurement.fwVersion       = (uint16_t)readPacked(data, 2);
+        measurement.values[APC1_FIELD_ERROR_CODE] = (uint32_t)readPacked(data, 1);
+
+        for (Apc1_Field field = APC1_FIELD_PM_1_0; field <= APC1_FIELD_PM_10; field++)
+        {
+            measurement.values[field] = (uint32_t)readPacked(data, 2);
+        }
+        for (Apc1_Field field = APC1_FIELD_NOPARTICLES_0_3; field <= APC1_FIELD_ECO2; field++)
+        {
+            measurement.values[field] = (uint32_t)readPacked(data, 2);
+        }
+        measurement.values[APC1_FIELD_T_COMP]   = (uint32_t)readPacked(data, 2);
+        measurement.values[APC1_FIELD_RH_COMP]  = (uint32_t)readPacked(data, 2);
+        measurement.values[APC1_FIELD_AQI]      = (uint32_t)readPacked(data, 1);
+        for (Apc1_Field field = APC1_FIELD_RS0; field <= APC1_FIELD_RS3; field++)
+        {
+            measurement.values[field] = (uint32_t)readPacked(data, 3);
+        }
+
+        measurement.fieldMask = APC1_BINARY_PACKED_FIELD_MASK;
+        return true;
+    }
+}
+
+#endif // SCIOSENSE_APC1_BINARY_H
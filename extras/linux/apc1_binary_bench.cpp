@@ -0,0 +1,159 @@
+// Compares the CBOR, packed and JSON encodings of simulated APC1 frames: payload size,
+// encode and decode cost, and round trip correctness of the host decoders.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_binary_bench apc1_binary_bench.cpp
+//   ./apc1_binary_bench [frames]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "apc1_binary.h"
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Serializer.h"
+
+using ScioSense::Apc1Binary::Measurement;
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+struct Encoding
+{
+    const char* name;
+    size_t      minSize = SIZE_MAX;
+    size_t      maxSize = 0;
+    size_t      bytes   = 0;
+    size_t      overLora = 0;
+    double      encode  = 0;
+    double      decode  = 0;
+    size_t      errors  = 0;
+};
+
+static void add(Encoding& result, const size_t size)
+{
+    result.bytes   += size;
+    result.minSize  = (size < result.minSize) ? size : result.minSize;
+    result.maxSize  = (size > result.maxSize) ? size : result.maxSize;
+    result.overLora += (size > APC1_BINARY_LORA_PAYLOAD_SIZE) ? 1 : 0;
+}
+
+static bool matches(const Measurement& measurement, const ScioSense_Apc1& apc1, const uint32_t fieldMask)
+{
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if ((fieldMask & APC1_FIELD_MASK(field)) && measurement.values[field] != Apc1_GetFieldValue(apc1.measurementData, field))
+        {
+            return false;
+        }
+    }
+    return measurement.serialNumber == apc1.serialNumber && measurement.fwVersion == apc1.fwVersion;
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100000;
+    const uint32_t packedMask = APC1_BINARY_PACKED_FIELD_MASK;
+
+    // frames of a simulated day, so the value distribution is realistic
+    std::vector<ScioSense_Apc1> frames(count);
+    ScioSense::Apc1Simulator::Environment environment(3);
+    for (size_t i = 0; i < count; i++)
+    {
+        environment.step(i * 1000);
+        environment.frame(frames[i].measurementData, 0x25);
+        frames[i].serialNumber  = 0x0123456789ABCDEFull;
+        frames[i].fwVersion     = 0x25;
+    }
+
+    Encoding results[4];
+    results[0].name = "CBOR default fields";
+    results[1].name = "CBOR all fields";
+    results[2].name = "packed";
+    results[3].name = "JSON (same fields as packed)";
+
+    std::vector<uint8_t> buffer(count * APC1_SERIALIZER_BUFFER_SIZE);
+    std::vector<size_t> sizes(count);
+    const uint32_t cborMasks[2] = { APC1_BINARY_DEFAULT_FIELD_MASK, APC1_FIELD_MASK_ALL };
+    Measurement measurement;
+
+    for (int r = 0; r < 2; r++)
+    {
+        double t = seconds();
+        for (size_t i = 0; i < count; i++)
+        {
+            sizes[i] = Apc1_EncodeCbor(&frames[i], cborMasks[r], 0, &buffer[i * APC1_BINARY_CBOR_BUFFER_SIZE], APC1_BINARY_CBOR_BUFFER_SIZE);
+        }
+        results[r].encode = seconds() - t;
+
+        t = seconds();
+        for (size_t i = 0; i < count; i++)
+        {
+            results[r].errors += ScioSense::Apc1Binary::decodeCbor(&buffer[i * APC1_BINARY_CBOR_BUFFER_SIZE], sizes[i], measurement) ? 0 : 1;
+        }
+        results[r].decode = seconds() - t;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            add(results[r], sizes[i]);
+            ScioSense::Apc1Binary::decodeCbor(&buffer[i * APC1_BINARY_CBOR_BUFFER_SIZE], sizes[i], measurement);
+            results[r].errors += matches(measurement, frames[i], cborMasks[r]) ? 0 : 1;
+        }
+    }
+
+    double t = seconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        sizes[i] = Apc1_EncodePacked(&frames[i], &buffer[i * APC1_BINARY_PACKED_SIZE], APC1_BINARY_PACKED_SIZE);
+    }
+    results[2].encode = seconds() - t;
+
+    t = seconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        results[2].errors += ScioSense::Apc1Binary::decodePacked(&buffer[i * APC1_BINARY_PACKED_SIZE], sizes[i], measurement) ? 0 : 1;
+    }
+    results[2].decode = seconds() - t;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        add(results[2], sizes[i]);
+        ScioSense::Apc1Binary::decodePacked(&buffer[i * APC1_BINARY_PACKED_SIZE], sizes[i], measurement);
+        results[2].errors += matches(measurement, frames[i], packedMask) ? 0 : 1;   // simulated RS values stay below the 24 bit saturation
+    }
+
+    Apc1_Serializer serializer = { APC1_FORMAT_JSON, packedMask, false, NULL };
+    t = seconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        sizes[i] = Apc1_Serialize(&serializer, frames[i].measurementData, 0, (char*)&buffer[i * APC1_SERIALIZER_BUFFER_SIZE], APC1_SERIALIZER_BUFFER_SIZE);
+    }
+    results[3].encode = seconds() - t;
+    for (size_t i = 0; i < count; i++)
+    {
+        add(results[3], sizes[i] - 1);  // without the newline
+    }
+
+    printf("%zu frames; LoRaWAN payload limit %d bytes\n\n", count, APC1_BINARY_LORA_PAYLOAD_SIZE);
+    printf("%-30s %8s %8s %8s %10s %12s %12s %8s\n", "encoding", "min", "mean", "max", "> limit", "encode ns", "decode ns", "errors");
+    for (const Encoding& result : results)
+    {
+        printf("%-30s %8zu %8.1f %8zu %10zu %12.1f ", result.name, result.minSize, (double)result.bytes / count, result.maxSize,
+            result.overLora, result.encode * 1e9 / count);
+        if (result.decode > 0)
+        {
+            printf("%12.1f %8zu\n", result.decode * 1e9 / count, result.errors);
+        }
+        else
+        {
+            printf("%12s %8s\n", "-", "-");
+        }
+    }
+
+    return (results[0].errors + results[1].errors + results[2].errors) ? 2 : 0;
+}
@@ -0,0 +1,138 @@
+// Corrects simulated frames of many sensors, each with its own calibration table (linear or
+// piecewise) and hygroscopicity, with the FLOAT, FIXED and LUT methods of Apc1_Calibration. It
+// prints the largest deviation of each method from a double precision reference of the same
+// formulas, and the cost per frame of Apc1_Calibration_Apply and Apc1_Calibration_ApplyBatch.
+// The RH of the frames is spread over 0 - 99 %, so the steep part of the growth curve is covered.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_calib_bench apc1_calib_bench.cpp
+//   ./apc1_calib_bench [sensors] [frames per sensor]
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Calibration.h"
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+// the formulas of the module in double precision; 0.1 µg/m³
+static double reference(const Apc1_CalibrationTable& table, const uint8_t* frame, const Apc1_Field field)
+{
+    const double raw    = Apc1_GetFieldValue(frame, field);
+    const double rh     = fmin(Apc1_GetFieldValue(frame, APC1_FIELD_RH_COMP), table.rhLimit) / 10.0;
+    const uint8_t size  = field % APC1_CALIBRATION_SIZES;
+    double value        = raw * 10;
+
+    for (int i = table.segmentCount[size] - 1; i >= 0; i--)
+    {
+        if (table.segments[size][i].from <= raw)
+        {
+            value = raw * 10 * table.segments[size][i].gain / 4096.0 + table.segments[size][i].offset;
+            break;
+        }
+    }
+
+    value = fmin(fmax(value, 0), 65535);
+    return value / (1 + table.kappa / 1000.0 / 1.65 * rh / (100 - rh));
+}
+
+int main(int argc, char** argv)
+{
+    const size_t sensors    = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000;
+    const size_t perSensor  = (argc > 2) ? strtoul(argv[2], NULL, 10) : 1000;
+    const size_t count      = sensors * perSensor;
+
+    ScioSense::Apc1Simulator::Random random(5);
+    std::vector<Apc1_CalibrationTable> tables(sensors);
+    for (Apc1_CalibrationTable& table : tables)
+    {
+        table           = Apc1_CalibrationTable();
+        table.kappa     = (uint16_t)(100 + random.next() % 600);
+        table.rhLimit   = 950;
+        for (uint8_t size = 0; size < APC1_CALIBRATION_SIZES; size++)
+        {
+            // half of the units linear, the others with a second slope above 30 - 80 µg/m³
+            table.segmentCount[size]        = 1 + random.next() % 2;
+            table.segments[size][0].from    = 0;
+            table.segments[size][0].gain    = (uint16_t)(APC1_CALIBRATION_GAIN_ONE * (0.7f + 0.6f * random.uniform()));
+            table.segments[size][0].offset  = (int16_t)(random.next() % 61) - 30;
+            table.segments[size][1].from    = (uint16_t)(30 + random.next() % 51);
+            table.segments[size][1].gain    = (uint16_t)(APC1_CALIBRATION_GAIN_ONE * (0.5f + 0.5f * random.uniform()));
+            table.segments[size][1].offset  = (int16_t)(random.next() % 201);
+        }
+    }
+
+    ScioSense::Apc1Simulator::Environment environment(5);
+    std::vector<uint8_t> frames(count * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+    std::vector<const uint8_t*> framePointers(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t* frame = &frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+        environment.step((uint64_t)i * 1000);
+        environment.frame(frame, 0x25);
+        Apc1_SetFieldValue(frame, APC1_FIELD_RH_COMP, random.next() % 990);
+        framePointers[i] = frame;
+    }
+
+    static const char* names[3] = { "FLOAT", "FIXED", "LUT" };
+    std::vector<Apc1_CorrectedPM> corrected(count);
+
+    printf("%zu sensors, %zu frames each\n\n", sensors, perSensor);
+    printf("%-8s %14s %14s %14s %16s\n", "method", "max |delta|", "mean |delta|", "Apply ns", "ApplyBatch ns");
+
+    for (Apc1_CalibrationMethod method = APC1_CALIBRATION_METHOD_FLOAT; method <= APC1_CALIBRATION_METHOD_LUT; method++)
+    {
+        std::vector<Apc1_Calibrator> calibrators(sensors);
+        std::vector<const Apc1_Calibrator*> calibratorPointers(count);
+        for (size_t s = 0; s < sensors; s++)
+        {
+            if (Apc1_Calibration_Init(&calibrators[s], &tables[s], method) != RESULT_OK)
+            {
+                fprintf(stderr, "invalid table\n");
+                return 1;
+            }
+        }
+        // the frames of all sensors interleaved, as a gateway receives them
+        for (size_t i = 0; i < count; i++)
+        {
+            calibratorPointers[i] = &calibrators[i % sensors];
+        }
+
+        double t = seconds();
+        for (size_t i = 0; i < count; i++)
+        {
+            Apc1_Calibration_Apply(calibratorPointers[i], framePointers[i], &corrected[i]);
+        }
+        const double single = (seconds() - t) / count * 1e9;
+
+        t = seconds();
+        Apc1_Calibration_ApplyBatch(calibratorPointers.data(), framePointers.data(), count, corrected.data());
+        const double batch = (seconds() - t) / count * 1e9;
+
+        double max = 0, sum = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            for (Apc1_Field field = 0; field < APC1_CALIBRATION_PM_FIELDS; field++)
+            {
+                const double d = fabs(corrected[i].values[field] - reference(tables[i % sensors], framePointers[i], field));
+                max  = fmax(max, d);
+                sum += d;
+            }
+        }
+
+        printf("%-8s %11.2f ug %11.3f ug %14.1f %16.1f\n", names[method], max / 10, sum / 10 / (count * APC1_CALIBRATION_PM_FIELDS), single, batch);
+    }
+
+    printf("\ntable %zu bytes, calibrator %zu bytes per sensor\n", sizeof(Apc1_CalibrationTable), sizeof(Apc1_Calibrator));
+
+    return 0;
+}
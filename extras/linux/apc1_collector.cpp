@@ -0,0 +1,392 @@
+// Collects measurements from many APC1 sensors on serial ports with a single thread.
+// Each sensor is initialized with Apc1_Reset and then polled in passive mode: a timerfd
+// per sensor triggers the measurement request, the response is read non-blocking and
+// assembled with Apc1_FindMeasurementData and passed to Apc1_Ingest, which does the checks, phase
+// tracking and stats of Apc1_Update. All file descriptors are served by one epoll loop.
+// Measurements are written as CSV to stdout, the per-sensor Apc1_Stats to stderr on exit.
+// With --shm, every frame is also published to a shared memory latest-value table (see apc1_shm.h).
+// With --align, the sensors are merged to a common tick (see apc1_fleet.h) and every tick is written
+// as one CSV line per field with the values of all sensors side by side.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_collector apc1_collector.cpp -lrt
+//   ./apc1_collector [--interval ms] [--shm /apc1] [--align ms] /dev/ttyUSB0 /dev/ttyUSB1 ...
+//
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
+#include <sys/timerfd.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+#include "lib/io/ScioSense_IOInterface_Posix_Termios.h"
+#include "apc1_fleet.h"
+#include "apc1_shm.h"
+#include "lib/apc1/ScioSense_Apc1_Serializer.h"
+
+#define COLLECTOR_READ_TIMEOUT      (300)   // ms; blocking reads during initialization
+#define COLLECTOR_RX_BUFFER_SIZE    (4 * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH)
+
+struct Sensor
+{
+    const char*                     path;
+    uint32_t                        slot;
+    ScioSense_Apc1                  apc1;
+    ScioSense_Posix_Termios_Config  io;
+    int                             timer;
+    uint8_t                         rx[COLLECTOR_RX_BUFFER_SIZE];
+    size_t                          rxLength;
+    uint32_t                        requestTime;
+    bool                            awaiting;
+};
+
+static ScioSense::Apc1Shm::Publisher* publisher = NULL;
+static ScioSense::Apc1Fleet::Merger* merger = NULL;
+
+enum EventSource : uint8_t { SOURCE_SIGNAL, SOURCE_TIMER, SOURCE_SERIAL };
+
+struct EventTag
+{
+    EventSource source;
+    Sensor*     sensor;
+};
+
+static void printHeader()
+{
+    printf("time_ms,sensor,pm1_0,pm2_5,pm10,pm_air1_0,pm_air2_5,pm_air10,n0_3,n0_5,n1_0,n2_5,n5_0,n10,tvoc,eco2,t_comp,rh_comp,t_raw,rh_raw,rs0,rs1,rs2,rs3,aqi,error\n");
+}
+
+static void printMeasurement(Sensor* sensor, const uint32_t now)
+{
+    ScioSense_Apc1* apc1 = &sensor->apc1;
+
+    printf("%u,%s,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%u,%u,%u,%u,%u,%u\n",
+        now, sensor->path,
+        Apc1_GetPM_1_0(apc1), Apc1_GetPM_2_5(apc1), Apc1_GetPM_10(apc1),
+        Apc1_GetPMInAir_1_0(apc1), Apc1_GetPMInAir_2_5(apc1), Apc1_GetPMInAir_10(apc1),
+        Apc1_GetNoParticles_0_3(apc1), Apc1_GetNoParticles_0_5(apc1), Apc1_GetNoParticles_1_0(apc1),
+        Apc1_GetNoParticles_2_5(apc1), Apc1_GetNoParticles_5_0(apc1), Apc1_GetNoParticles_10(apc1),
+        Apc1_GetTVOC(apc1), Apc1_GetECO2(apc1),
+        Apc1_GetCompT(apc1), Apc1_GetCompRH(apc1), Apc1_GetRawT(apc1), Apc1_GetRawRH(apc1),
+        Apc1_GetRS0(apc1), Apc1_GetRS1(apc1), Apc1_GetRS2(apc1), Apc1_GetRS3(apc1),
+        Apc1_GetAQI(apc1), Apc1_GetError(apc1));
+}
+
+static void printAlignedHeader(const std::vector<Sensor*>& sensors)
+{
+    printf("time_ms,field");
+    for (Sensor* sensor : sensors)
+    {
+        printf(",%s", sensor->path);
+    }
+    printf("\n");
+}
+
+static void printAligned(const ScioSense::Apc1Fleet::Batch& batch)
+{
+    for (uint32_t tick = 0; tick < batch.ticks(); tick++)
+    {
+        uint32_t column = 0;
+        for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+        {
+            if (!(batch.fieldMask() & APC1_FIELD_MASK(field)))
+            {
+                continue;
+            }
+
+            // the batch holds unscaled field values; T and RH are in 0.1 units
+            const float scale = (field >= APC1_FIELD_T_COMP && field <= APC1_FIELD_RH_RAW) ? 0.1f : 1.0f;
+            printf("%llu,%s", (unsigned long long)batch.timestamps()[tick], Apc1_GetFieldName(field));
+            for (uint32_t sensor = 0; sensor < batch.sensors(); sensor++)
+            {
+                // missing values are empty
+                const float value = batch.value(tick, sensor, column) * scale;
+                (value == value) ? printf(",%.2f", value) : printf(",");
+            }
+            printf("\n");
+            column++;
+        }
+    }
+}
+
+static void printStats(Sensor* sensor)
+{
+    const Apc1_Stats* stats = &sensor->apc1.stats;
+
+    fprintf(stderr, "%s: frames %u, checksum errors %u, invalid %u, io errors %u, command errors %u, resyncs %u, discarded bytes %u\n",
+        sensor->path, stats->framesOk, stats->checksumErrors, stats->invalidFrames, stats->ioErrors, stats->commandErrors, stats->resyncs, stats->discardedBytes);
+}
+
+static bool initialize(Sensor* sensor)
+{
+    ScioSense_Apc1* apc1 = &sensor->apc1;
+
+    memset(apc1, 0, sizeof(ScioSense_Apc1));
+    if (ScioSense_Posix_Termios_Open(&sensor->io, sensor->path, COLLECTOR_READ_TIMEOUT) != RESULT_OK)
+    {
+        return false;
+    }
+
+    apc1->io.read           = ScioSense_Posix_Termios_Read;
+    apc1->io.write          = ScioSense_Posix_Termios_Write;
+    apc1->io.clear          = ScioSense_Posix_Termios_Clear;
+    apc1->io.wait           = ScioSense_Posix_Termios_Wait;
+    apc1->io.millis         = ScioSense_Posix_Termios_Millis;
+    apc1->io.protocol       = APC1_PROTOCOL_UART;
+    apc1->io.config         = &sensor->io;
+    apc1->operatingMode     = APC1_OPERATING_MODE_STANDARD;
+    apc1->measurementMode   = APC1_MEASUREMENT_MODE_PASSIVE;
+
+    return Apc1_Reset(apc1) == RESULT_OK;
+}
+
+static void request(Sensor* sensor)
+{
+    ScioSense_Apc1* apc1 = &sensor->apc1;
+
+    if (sensor->awaiting)
+    {
+        // no complete frame since the last request; drop partial data and start over
+        apc1->stats.ioErrors++;
+        apc1->stats.resyncs++;
+        sensor->rxLength = 0;
+        ScioSense_Posix_Termios_Clear(&sensor->io);
+    }
+
+    sensor->requestTime = ScioSense_Posix_Termios_Millis();
+    sensor->awaiting    = (Apc1_InvokePassiveMeasurement(apc1) == RESULT_OK);
+}
+
+static void receive(Sensor* sensor)
+{
+    ScioSense_Apc1* apc1 = &sensor->apc1;
+
+    for (;;)
+    {
+        ssize_t n = read(sensor->io.fd, sensor->rx + sensor->rxLength, sizeof(sensor->rx) - sensor->rxLength);
+        if (n <= 0)
+        {
+            break;
+        }
+        sensor->rxLength += (size_t)n;
+
+        for (;;)
+        {
+            size_t offset;
+            Result result = Apc1_FindMeasurementData(sensor->rx, sensor->rxLength, &offset);
+            size_t consumed = offset;
+
+            if (result == RESULT_OK)
+            {
+                const uint32_t now = ScioSense_Posix_Termios_Millis();
+
+                Apc1_Ingest(apc1, sensor->rx + offset, sensor->requestTime);
+                if (merger != NULL)
+                {
+                    merger->push(sensor->slot, now, apc1->measurementData);
+                }
+                else
+                {
+                    printMeasurement(sensor, now);
+                }
+
+                if (publisher != NULL)
+                {
+                    struct timespec realtime;
+                    clock_gettime(CLOCK_REALTIME, &realtime);
+                    publisher->publish(sensor->slot, apc1, sensor->path, (uint64_t)realtime.tv_sec * 1000 + (uint64_t)realtime.tv_nsec / 1000000);
+                }
+
+                sensor->awaiting    = false;
+                consumed           += APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH;
+            }
+
+            if (offset > 0)
+            {
+                apc1->stats.resyncs++;
+                apc1->stats.discardedBytes += (uint32_t)offset;
+            }
+
+            memmove(sensor->rx, sensor->rx + consumed, sensor->rxLength - consumed);
+            sensor->rxLength -= consumed;
+
+            if (result != RESULT_OK)
+            {
+                break;
+            }
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32_t interval   = APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    const char* shm     = NULL;
+    uint32_t align      = 0;
+    std::vector<Sensor*> sensors;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc)
+        {
+            interval = (uint32_t)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+
+        if (strcmp(argv[i], "--shm") == 0 && i + 1 < argc)
+        {
+            shm = argv[++i];
+            continue;
+        }
+
+        if (strcmp(argv[i], "--align") == 0 && i + 1 < argc)
+        {
+            align = (uint32_t)strtoul(argv[++i], NULL, 10);
+            continue;
+        }
+
+        Sensor* sensor  = new Sensor();
+        sensor->path    = argv[i];
+        if (!initialize(sensor))
+        {
+            fprintf(stderr, "%s: the APC1 is not connected\n", sensor->path);
+            ScioSense_Posix_Termios_Close(&sensor->io);
+            delete sensor;
+            continue;
+        }
+        sensor->slot = (uint32_t)sensors.size();
+        sensors.push_back(sensor);
+    }
+
+    if (sensors.empty())
+    {
+        fprintf(stderr, "usage: %s [--interval ms] [--shm name] [--align ms] <serial port>...\n", argv[0]);
+        return 1;
+    }
+
+    if (shm != NULL)
+    {
+        publisher = new ScioSense::Apc1Shm::Publisher();
+        if (!publisher->open(shm, (uint32_t)sensors.size()))
+        {
+            fprintf(stderr, "%s: can not create the shared memory table\n", shm);
+            return 1;
+        }
+    }
+
+    if (align > 0)
+    {
+        ScioSense::Apc1Fleet::Config config;
+        config.sensors          = (uint32_t)sensors.size();
+        config.fieldMask        = APC1_FIELD_MASK(APC1_FIELD_PM_1_0) | APC1_FIELD_MASK(APC1_FIELD_PM_2_5) | APC1_FIELD_MASK(APC1_FIELD_PM_10)
+                                | APC1_FIELD_MASK(APC1_FIELD_TVOC)   | APC1_FIELD_MASK(APC1_FIELD_ECO2)
+                                | APC1_FIELD_MASK(APC1_FIELD_T_COMP) | APC1_FIELD_MASK(APC1_FIELD_RH_COMP);
+        config.tickInterval     = align;
+        config.maxLatency       = interval + align;
+        config.maxAge           = 3 * (interval > align ? interval : align);
+        config.ticksPerBatch    = 1;
+        merger = new ScioSense::Apc1Fleet::Merger(config);
+    }
+
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<EventTag> tags(2 * sensors.size() + 1);
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigprocmask(SIG_BLOCK, &signals, NULL);
+    int signal      = signalfd(-1, &signals, SFD_CLOEXEC);
+    tags[0]         = { SOURCE_SIGNAL, NULL };
+    struct epoll_event event = { };
+    event.events    = EPOLLIN;
+    event.data.ptr  = &tags[0];
+    epoll_ctl(epoll, EPOLL_CTL_ADD, signal, &event);
+
+    for (size_t i = 0; i < sensors.size(); i++)
+    {
+        Sensor* sensor = sensors[i];
+
+        // stagger the requests over the interval to spread the load
+        const uint64_t start = 1 + (uint64_t)interval * i / sensors.size();
+        struct itimerspec schedule;
+        schedule.it_interval.tv_sec     = interval / 1000;
+        schedule.it_interval.tv_nsec    = (long)(interval % 1000) * 1000000L;
+        schedule.it_value.tv_sec        = (time_t)(start / 1000);
+        schedule.it_value.tv_nsec       = (long)(start % 1000) * 1000000L;
+        sensor->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        timerfd_settime(sensor->timer, 0, &schedule, NULL);
+
+        tags[1 + 2 * i] = { SOURCE_TIMER,  sensor };
+        tags[2 + 2 * i] = { SOURCE_SERIAL, sensor };
+
+        event.data.ptr = &tags[1 + 2 * i];
+        epoll_ctl(epoll, EPOLL_CTL_ADD, sensor->timer, &event);
+        event.data.ptr = &tags[2 + 2 * i];
+        epoll_ctl(epoll, EPOLL_CTL_ADD, sensor->io.fd, &event);
+    }
+
+    (merger != NULL) ? printAlignedHeader(sensors) : printHeader();
+
+    bool running = true;
+    struct epoll_event events[64];
+    while (running)
+    {
+        int n = epoll_wait(epoll, events, 64, -1);
+        if (n < 0 && errno != EINTR)
+        {
+            break;
+        }
+
+        for (int e = 0; e < n; e++)
+        {
+            EventTag* tag = (EventTag*)events[e].data.ptr;
+            switch (tag->source)
+            {
+                case SOURCE_SIGNAL:
+                    running = false;
+                    break;
+
+                case SOURCE_TIMER:
+                {
+                    uint64_t expirations;
+                    if (read(tag->sensor->timer, &expirations, sizeof(expirations)) > 0)
+                    {
+                        request(tag->sensor);
+                    }
+                    break;
+                }
+
+                case SOURCE_SERIAL:
+                    receive(tag->sensor);
+                    break;
+            }
+        }
+
+        if (merger != NULL)
+        {
+            merger->advance(ScioSense_Posix_Termios_Millis(), printAligned);
+        }
+        fflush(stdout);
+    }
+
+    for (Sensor* sensor : sensors)
+    {
+        printStats(sensor);
+        close(sensor->timer);
+        ScioSense_Posix_Termios_Close(&sensor->io);
+        delete sensor;
+    }
+    close(signal);
+    close(epoll);
+    delete publisher;
+    delete merger;
+
+    return 0;
+}
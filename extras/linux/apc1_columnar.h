@@ -0,0 +1,698 @@
+#ifndef SCIOSENSE_APC1_COLUMNAR_H
+#define SCIOSENSE_APC1_COLUMNAR_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+namespace ScioSense::Apc1Columnar
+{
+    // Columnar archive of the measurement time series of one APC1.
+    //
+    // Rows are grouped into row groups. A row group stores one chunk per column: the timestamp
+    // (ms since the row group's baseTime) and every field of fieldMask (see Apc1_Field).
+    // Chunks start on page boundaries, so scanning one column maps only that column's pages.
+    //
+    // A chunk is a sequence of mini blocks of up to miniBlockRows values. A mini block has a
+    // header with min, max and sum and stores the deltas between consecutive values as
+    // (delta - minDelta), bit-packed with the smallest bit width. Timestamps and slowly changing
+    // fields take a few bits per value. Min, max and sum are repeated per chunk in the footer,
+    // so aggregations over whole row groups read no column data at all, and filters skip mini
+    // blocks whose range cannot match.
+    //
+    // File layout (little endian, host structs):
+    //      chunks          page aligned
+    //      Footer          followed by rowGroupCount * (RowGroup, Chunk[columnCount])
+    //      Trailer         last 16 bytes of the file
+    //
+    // The Writer appends to an existing file by overwriting the footer with the next row group;
+    // the file is consistent after every flush() and close().
+
+    static constexpr uint32_t magic             = 0x46433141;   // "A1CF"
+    static constexpr uint32_t version           = 1;
+    static constexpr uint32_t miniBlockRows     = 1024;
+    static constexpr uint32_t alignment         = 4096;
+    static constexpr uint32_t maxRowGroupSpan   = 0x7FFFFFFF;   // ms; timestamp offsets are 32 bit
+
+    // PM, particle counts, TVOC, eCO2, compensated T/RH and the gas sensor resistances
+    static constexpr uint32_t defaultFieldMask  =
+        APC1_FIELD_MASK(APC1_FIELD_PM_1_0)          | APC1_FIELD_MASK(APC1_FIELD_PM_2_5)            | APC1_FIELD_MASK(APC1_FIELD_PM_10)
+      | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_0_3) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_0_5)   | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_1_0)
+      | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_2_5) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_5_0)   | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_10)
+      | APC1_FIELD_MASK(APC1_FIELD_TVOC)            | APC1_FIELD_MASK(APC1_FIELD_ECO2)
+      | APC1_FIELD_MASK(APC1_FIELD_T_COMP)          | APC1_FIELD_MASK(APC1_FIELD_RH_COMP)
+      | APC1_FIELD_MASK(APC1_FIELD_RS0)             | APC1_FIELD_MASK(APC1_FIELD_RS1)               | APC1_FIELD_MASK(APC1_FIELD_RS2)
+      | APC1_FIELD_MASK(APC1_FIELD_RS3);
+
+    struct MiniBlock
+    {
+        uint32_t    first;
+        int32_t     minDelta;
+        uint32_t    min;
+        uint32_t    max;
+        uint64_t    sum;
+        uint8_t     bitWidth;
+        uint8_t     reserved[7];
+        // followed by words(rows, bitWidth) packed uint64_t words
+    };
+
+    struct Chunk
+    {
+        uint64_t    offset;
+        uint32_t    size;
+        uint32_t    min;
+        uint32_t    max;
+        uint32_t    reserved;
+        uint64_t    sum;
+    };
+
+    struct RowGroup
+    {
+        uint64_t    baseTime;
+        uint64_t    lastTime;
+        uint32_t    rows;
+        uint32_t    reserved;
+        // followed by Chunk[columnCount]; chunk 0 is the timestamp
+    };
+
+    struct Footer
+    {
+        uint32_t    fieldMask;
+        uint32_t    rowGroupCount;
+        uint64_t    rows;
+    };
+
+    struct Trailer
+    {
+        uint64_t    footerOffset;
+        uint32_t    magic;
+        uint32_t    version;
+    };
+
+    struct Aggregate
+    {
+        uint64_t    count   = 0;
+        uint64_t    sum     = 0;
+        uint32_t    min     = UINT32_MAX;
+        uint32_t    max     = 0;
+
+        inline double mean() const { return count ? (double)sum / (double)count : 0.0; }
+
+        inline void add(const uint32_t value)
+        {
+            count++;
+            sum += value;
+            min = (value < min) ? value : min;
+            max = (value > max) ? value : max;
+        }
+
+        inline void add(const uint64_t n, const uint64_t s, const uint32_t lo, const uint32_t hi)
+        {
+            count   += n;
+            sum     += s;
+            min     = (lo < min) ? lo : min;
+            max     = (hi > max) ? hi : max;
+        }
+    };
+
+    static_assert(sizeof(MiniBlock) == 32 && sizeof(Chunk) == 32 && sizeof(RowGroup) == 24, "unexpected padding");
+
+    static inline uint32_t columnCount(const uint32_t fieldMask)
+    {
+        return 1 + (uint32_t)__builtin_popcount(fieldMask);
+    }
+
+    // returns the column of field, or 0 (the timestamp) if the field is not stored
+    static inline uint32_t columnOf(const uint32_t fieldMask, const Apc1_Field field)
+    {
+        if (!(fieldMask & APC1_FIELD_MASK(field)))
+        {
+            return 0;
+        }
+        return 1 + (uint32_t)__builtin_popcount(fieldMask & (APC1_FIELD_MASK(field) - 1));
+    }
+
+    static inline size_t packedWords(const uint32_t rows, const uint8_t bitWidth)
+    {
+        return ((size_t)(rows - 1) * bitWidth + 63) / 64;
+    }
+
+    static inline size_t miniBlockWords(const uint32_t rows, const uint8_t bitWidth)
+    {
+        return sizeof(MiniBlock) / sizeof(uint64_t) + packedWords(rows, bitWidth);
+    }
+
+    // appends the mini blocks of values to out
+    static inline void encode(const uint32_t* values, const uint32_t rows, std::vector<uint64_t>& out)
+    {
+        for (uint32_t start = 0; start < rows; start += miniBlockRows)
+        {
+            const uint32_t n = (rows - start < miniBlockRows) ? rows - start : miniBlockRows;
+            const uint32_t* v = values + start;
+
+            MiniBlock block = {};
+            block.first     = v[0];
+            block.min       = v[0];
+            block.max       = v[0];
+            block.sum       = v[0];
+            block.minDelta  = (n > 1) ? (int32_t)(v[1] - v[0]) : 0;
+
+            uint32_t range = 0;
+            for (uint32_t i = 1; i < n; i++)
+            {
+                const int32_t delta = (int32_t)(v[i] - v[i - 1]);
+                block.minDelta  = (delta < block.minDelta) ? delta : block.minDelta;
+                block.min       = (v[i] < block.min) ? v[i] : block.min;
+                block.max       = (v[i] > block.max) ? v[i] : block.max;
+                block.sum      += v[i];
+            }
+            for (uint32_t i = 1; i < n; i++)
+            {
+                const uint32_t packed = (uint32_t)(v[i] - v[i - 1]) - (uint32_t)block.minDelta;
+                range = (packed > range) ? packed : range;
+            }
+            block.bitWidth = (uint8_t)(range ? 32 - __builtin_clz(range) : 0);
+
+            const size_t at = out.size();
+            out.resize(at + miniBlockWords(n, block.bitWidth), 0);
+            memcpy(&out[at], &block, sizeof(block));
+
+            uint64_t* words = &out[at + sizeof(MiniBlock) / sizeof(uint64_t)];
+            for (uint32_t i = 1; i < n && block.bitWidth; i++)
+            {
+                const uint64_t packed   = (uint32_t)(v[i] - v[i - 1]) - (uint32_t)block.minDelta;
+                const size_t bit        = (size_t)(i - 1) * block.bitWidth;
+                const uint32_t shift    = bit % 64;
+                words[bit / 64] |= packed << shift;
+                if (shift + block.bitWidth > 64)
+                {
+                    words[bit / 64 + 1] |= packed >> (64 - shift);
+                }
+            }
+        }
+    }
+
+    // decodes one mini block of n values; returns the number of words it occupies
+    static inline size_t decode(const uint64_t* data, const uint32_t n, uint32_t* out)
+    {
+        const MiniBlock* block  = (const MiniBlock*)data;
+        const uint64_t* words   = data + sizeof(MiniBlock) / sizeof(uint64_t);
+        const uint8_t bitWidth  = block->bitWidth;
+        const uint64_t mask     = (1ull << bitWidth) - 1;
+        uint32_t value          = block->first;
+
+        out[0] = value;
+        if (bitWidth == 0)
+        {
+            for (uint32_t i = 1; i < n; i++)
+            {
+                value += (uint32_t)block->minDelta;
+                out[i] = value;
+            }
+        }
+        else
+        {
+            // unaligned 8 byte loads; bitWidth <= 32 always fits, and the footer follows the last chunk
+            const uint8_t* bytes = (const uint8_t*)words;
+            for (uint32_t i = 1; i < n; i++)
+            {
+                const size_t bit = (size_t)(i - 1) * bitWidth;
+                uint64_t packed;
+                memcpy(&packed, bytes + bit / 8, sizeof(packed));
+                value += (uint32_t)block->minDelta + (uint32_t)((packed >> (bit % 8)) & mask);
+                out[i] = value;
+            }
+        }
+
+        return miniBlockWords(n, bitWidth);
+    }
+
+    class Writer
+    {
+    public:
+        Writer() = default;
+        ~Writer() { close(); }
+
+        Writer(const Writer&) = delete;
+        Writer& operator=(const Writer&) = delete;
+
+        // creates path or appends to it; an existing file must have been written with the same fieldMask
+        inline bool open(const char* path, const uint32_t mask = defaultFieldMask, const uint32_t rowGroupRows = 1u << 18)
+        {
+            close();
+
+            fd = ::open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            fieldMask       = mask & APC1_FIELD_MASK_ALL;
+            maxRows         = (rowGroupRows < miniBlockRows) ? miniBlockRows : rowGroupRows;
+            end             = 0;
+            totalRows       = 0;
+            rowGroupCount   = 0;
+            directory.clear();
+
+            struct stat info;
+            Trailer trailer;
+            if (fstat(fd, &info) == 0 && info.st_size >= (off_t)(sizeof(Footer) + sizeof(Trailer)))
+            {
+                Footer footer;
+                if
+                (
+                    pread(fd, &trailer, sizeof(trailer), info.st_size - sizeof(trailer)) != sizeof(trailer)
+                 || trailer.magic != magic || trailer.version != version
+                 || pread(fd, &footer, sizeof(footer), trailer.footerOffset) != sizeof(footer)
+                 || footer.fieldMask != fieldMask
+                )
+                {
+                    close();
+                    return false;
+                }
+
+                directory.resize(info.st_size - sizeof(trailer) - trailer.footerOffset - sizeof(footer));
+                if (pread(fd, directory.data(), directory.size(), trailer.footerOffset + sizeof(footer)) != (ssize_t)directory.size())
+                {
+                    close();
+                    return false;
+                }
+
+                end             = trailer.footerOffset;
+                totalRows       = footer.rows;
+                rowGroupCount   = footer.rowGroupCount;
+                if (rowGroupCount > 0)
+                {
+                    lastTime    = ((const RowGroup*)(directory.data() + directory.size() - rowGroupSize()))->lastTime;
+                }
+            }
+
+            columns.assign(columnCount(fieldMask), std::vector<uint32_t>());
+            for (std::vector<uint32_t>& column : columns)
+            {
+                column.reserve(maxRows);
+            }
+            return true;
+        }
+
+        // appends the fields of a validated measurement frame; timestamps in ms must not decrease
+        inline bool append(const uint64_t timestamp, const uint8_t* measurementData)
+        {
+            if (fd < 0 || (totalRows + rows() > 0 && timestamp < lastTime))
+            {
+                return false;
+            }
+
+            if (rows() > 0 && (rows() >= maxRows || timestamp - baseTime > maxRowGroupSpan))
+            {
+                if (!flush())
+                {
+                    return false;
+                }
+            }
+
+            if (rows() == 0)
+            {
+                baseTime = timestamp;
+            }
+
+            columns[0].push_back((uint32_t)(timestamp - baseTime));
+            uint32_t column = 1;
+            for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+            {
+                if (fieldMask & APC1_FIELD_MASK(field))
+                {
+                    columns[column++].push_back(Apc1_GetFieldValue(measurementData, field));
+                }
+            }
+            lastTime = timestamp;
+
+            return true;
+        }
+
+        inline bool append(const uint64_t timestamp, const ScioSense_Apc1* apc1)
+        {
+            return append(timestamp, apc1->measurementData);
+        }
+
+        // writes the buffered rows as a row group and rewrites the footer
+        inline bool flush()
+        {
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            if (rows() > 0)
+            {
+                RowGroup rowGroup   = {};
+                rowGroup.baseTime   = baseTime;
+                rowGroup.lastTime   = lastTime;
+                rowGroup.rows       = rows();
+
+                const size_t at = directory.size();
+                directory.resize(at + rowGroupSize());
+                Chunk* chunks = (Chunk*)(directory.data() + at + sizeof(RowGroup));
+
+                for (size_t c = 0; c < columns.size(); c++)
+                {
+                    words.clear();
+                    encode(columns[c].data(), rowGroup.rows, words);
+
+                    Chunk chunk     = {};
+                    chunk.offset    = (end + alignment - 1) / alignment * alignment;
+                    chunk.size      = (uint32_t)(words.size() * sizeof(uint64_t));
+                    chunk.min       = UINT32_MAX;
+                    size_t w = 0;
+                    for (uint32_t start = 0; start < rowGroup.rows; start += miniBlockRows)
+                    {
+                        const MiniBlock* block  = (const MiniBlock*)&words[w];
+                        const uint32_t n        = (rowGroup.rows - start < miniBlockRows) ? rowGroup.rows - start : miniBlockRows;
+                        chunk.min   = (block->min < chunk.min) ? block->min : chunk.min;
+                        chunk.max   = (block->max > chunk.max) ? block->max : chunk.max;
+                        chunk.sum  += block->sum;
+                        w          += miniBlockWords(n, block->bitWidth);
+                    }
+
+                    if (pwrite(fd, words.data(), chunk.size, chunk.offset) != (ssize_t)chunk.size)
+                    {
+                        directory.resize(at);
+                        return false;
+                    }
+                    end = chunk.offset + chunk.size;
+                    memcpy(&chunks[c], &chunk, sizeof(chunk));
+                }
+
+                memcpy(directory.data() + at, &rowGroup, sizeof(rowGroup));
+                rowGroupCount++;
+                totalRows += rowGroup.rows;
+                for (std::vector<uint32_t>& column : columns)
+                {
+                    column.clear();
+                }
+            }
+
+            Footer footer       = { fieldMask, rowGroupCount, totalRows };
+            Trailer trailer     = { end, magic, version };
+            const off_t size    = end + sizeof(footer) + directory.size() + sizeof(trailer);
+
+            return pwrite(fd, &footer, sizeof(footer), end) == sizeof(footer)
+                && pwrite(fd, directory.data(), directory.size(), end + sizeof(footer)) == (ssize_t)directory.size()
+                && pwrite(fd, &trailer, sizeof(trailer), size - sizeof(trailer)) == sizeof(trailer)
+                && ftruncate(fd, size) == 0;
+        }
+
+        inline bool close()
+        {
+            bool result = true;
+            if (fd >= 0)
+            {
+                result = flush();
+                ::close(fd);
+                fd = -1;
+            }
+            return result;
+        }
+
+        inline uint32_t rows()          const { return columns.empty() ? 0 : (uint32_t)columns[0].size(); }
+        inline uint64_t lastTimestamp() const { return lastTime; }       // of the last appended row, also of an existing file
+
+    private:
+        inline size_t rowGroupSize() const { return sizeof(RowGroup) + columnCount(fieldMask) * sizeof(Chunk); }
+
+        int                                 fd              = -1;
+        uint32_t                            fieldMask       = 0;
+        uint32_t                            maxRows         = 0;
+        uint32_t                            rowGroupCount   = 0;
+        uint64_t                            totalRows       = 0;
+        uint64_t                            end             = 0;
+        uint64_t                            baseTime        = 0;
+        uint64_t                            lastTime        = 0;
+        std::vector<std::vector<uint32_t>>  columns;
+        std::vector<uint64_t>               words;
+        std::vector<uint8_t>                directory;
+    };
+
+    class Reader
+    {
+    public:
+        Reader() = default;
+        ~Reader() { close(); }
+
+        Reader(const Reader&) = delete;
+        Reader& operator=(const Reader&) = delete;
+
+        // maps the archive read-only; column data is paged in on first access
+        inline bool open(const char* path)
+        {
+            close();
+
+            const int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || info.st_size < (off_t)(sizeof(Footer) + sizeof(Trailer)))
+            {
+                ::close(fd);
+                return false;
+            }
+
+            size = (size_t)info.st_size;
+            file = (const uint8_t*)mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (file == MAP_FAILED)
+            {
+                file = NULL;
+                return false;
+            }
+
+            const Trailer* trailer = (const Trailer*)(file + size - sizeof(Trailer));
+            if (trailer->magic != magic || trailer->version != version || trailer->footerOffset > size - sizeof(Trailer) - sizeof(Footer))
+            {
+                close();
+                return false;
+            }
+
+            footer      = (const Footer*)(file + trailer->footerOffset);
+            directory   = file + trailer->footerOffset + sizeof(Footer);
+            groupSize   = sizeof(RowGroup) + columnCount(footer->fieldMask) * sizeof(Chunk);
+            if (trailer->footerOffset + sizeof(Footer) + (uint64_t)footer->rowGroupCount * groupSize + sizeof(Trailer) != size)
+            {
+                close();
+                return false;
+            }
+
+            for (uint32_t g = 0; g < footer->rowGroupCount; g++)
+            {
+                for (uint32_t c = 0; c < columnCount(footer->fieldMask); c++)
+                {
+                    if (chunk(g, c).offset + chunk(g, c).size > trailer->footerOffset)
+                    {
+                        close();
+                        return false;
+                    }
+                }
+            }
+
+            return true;
+        }
+
+        inline void close()
+        {
+            if (file)
+            {
+                munmap((void*)file, size);
+                file = NULL;
+            }
+        }
+
+        inline uint32_t         fieldMask()                                         const { return footer->fieldMask; }
+        inline uint64_t         rows()                                              const { return footer->rows; }
+        inline uint32_t         rowGroups()                                         const { return footer->rowGroupCount; }
+        inline const RowGroup&  rowGroup(const uint32_t g)                          const { return *(const RowGroup*)(directory + g * groupSize); }
+        inline const Chunk&     chunk(const uint32_t g, const uint32_t column)      const { return ((const Chunk*)(directory + g * groupSize + sizeof(RowGroup)))[column]; }
+
+        // count, sum, min and max of field over timestamps [from, to] in ms; covered row groups and
+        // mini blocks are answered from their statistics without decoding
+        inline Aggregate aggregate(const Apc1_Field field, const uint64_t from, const uint64_t to) const
+        {
+            Aggregate result;
+            const uint32_t column = columnOf(footer->fieldMask, field);
+            uint32_t times[miniBlockRows];
+            uint32_t values[miniBlockRows];
+
+            for (uint32_t g = 0; column && g < rowGroups(); g++)
+            {
+                const RowGroup& group = rowGroup(g);
+                if (group.lastTime < from || group.baseTime > to)
+                {
+                    continue;
+                }
+
+                if (from <= group.baseTime && group.lastTime <= to)
+                {
+                    const Chunk& c = chunk(g, column);
+                    result.add(group.rows, c.sum, c.min, c.max);
+                    continue;
+                }
+
+                blocks(g, column, [&](const uint32_t n, const uint64_t* time, const uint64_t* value)
+                {
+                    const MiniBlock* t  = (const MiniBlock*)time;
+                    const MiniBlock* v  = (const MiniBlock*)value;
+                    const uint64_t lo   = group.baseTime + t->min;
+                    const uint64_t hi   = group.baseTime + t->max;
+
+                    if (hi < from || lo > to)
+                    {
+                        return;
+                    }
+
+                    if (from <= lo && hi <= to)
+                    {
+                        result.add(n, v->sum, v->min, v->max);
+                        return;
+                    }
+
+                    decode(time, n, times);
+                    decode(value, n, values);
+                    for (uint32_t i = 0; i < n; i++)
+                    {
+                        const uint64_t timestamp = group.baseTime + times[i];
+                        if (from <= timestamp && timestamp <= to)
+                        {
+                            result.add(values[i]);
+                        }
+                    }
+                });
+            }
+
+            return result;
+        }
+
+        // number of rows over timestamps [from, to] with field > threshold; skips mini blocks by their min/max
+        inline uint64_t countAbove(const Apc1_Field field, const uint32_t threshold, const uint64_t from, const uint64_t to) const
+        {
+            uint64_t count = 0;
+            const uint32_t column = columnOf(footer->fieldMask, field);
+            uint32_t times[miniBlockRows];
+            uint32_t values[miniBlockRows];
+
+            for (uint32_t g = 0; column && g < rowGroups(); g++)
+            {
+                const RowGroup& group = rowGroup(g);
+                if (group.lastTime < from || group.baseTime > to || chunk(g, column).max <= threshold)
+                {
+                    continue;
+                }
+
+                blocks(g, column, [&](const uint32_t n, const uint64_t* time, const uint64_t* value)
+                {
+                    const MiniBlock* t  = (const MiniBlock*)time;
+                    const MiniBlock* v  = (const MiniBlock*)value;
+                    const uint64_t lo   = group.baseTime + t->min;
+                    const uint64_t hi   = group.baseTime + t->max;
+
+                    if (hi < from || lo > to || v->max <= threshold)
+                    {
+                        return;
+                    }
+
+                    const bool covered = (from <= lo && hi <= to);
+                    if (covered && v->min > threshold)
+                    {
+                        count += n;
+                        return;
+                    }
+
+                    if (!covered)
+                    {
+                        decode(time, n, times);
+                    }
+                    decode(value, n, values);
+                    for (uint32_t i = 0; i < n; i++)
+                    {
+                        const uint64_t timestamp = group.baseTime + times[i];
+                        count += (values[i] > threshold && (covered || (from <= timestamp && timestamp <= to))) ? 1 : 0;
+                    }
+                });
+            }
+
+            return count;
+        }
+
+        // calls visit(timestamp, value) for every row of field over timestamps [from, to] in time order
+        template<class Visitor>
+        inline void scan(const Apc1_Field field, const uint64_t from, const uint64_t to, Visitor&& visit) const
+        {
+            const uint32_t column = columnOf(footer->fieldMask, field);
+            uint32_t times[miniBlockRows];
+            uint32_t values[miniBlockRows];
+
+            for (uint32_t g = 0; column && g < rowGroups(); g++)
+            {
+                const RowGroup& group = rowGroup(g);
+                if (group.lastTime < from || group.baseTime > to)
+                {
+                    continue;
+                }
+
+                blocks(g, column, [&](const uint32_t n, const uint64_t* time, const uint64_t* value)
+                {
+                    const MiniBlock* t = (const MiniBlock*)time;
+                    if (group.baseTime + t->max < from || group.baseTime + t->min > to)
+                    {
+                        return;
+                    }
+
+                    decode(time, n, times);
+                    decode(value, n, values);
+                    for (uint32_t i = 0; i < n; i++)
+                    {
+                        const uint64_t timestamp = group.baseTime + times[i];
+                        if (from <= timestamp && timestamp <= to)
+                        {
+                            visit(timestamp, values[i]);
+                        }
+                    }
+                });
+            }
+        }
+
+    private:
+        // calls visit(n, timeBlock, valueBlock) for each mini block of row group g
+        template<class Visitor>
+        inline void blocks(const uint32_t g, const uint32_t column, Visitor&& visit) const
+        {
+            const uint32_t rows     = rowGroup(g).rows;
+            const uint64_t* time    = (const uint64_t*)(file + chunk(g, 0).offset);
+            const uint64_t* value   = (const uint64_t*)(file + chunk(g, column).offset);
+
+            for (uint32_t start = 0; start < rows; start += miniBlockRows)
+            {
+                const uint32_t n = (rows - start < miniBlockRows) ? rows - start : miniBlockRows;
+                visit(n, time, value);
+                time    += miniBlockWords(n, ((const MiniBlock*)time)->bitWidth);
+                value   += miniBlockWords(n, ((const MiniBlock*)value)->bitWidth);
+            }
+        }
+
+        const uint8_t*  file        = NULL;
+        size_t          size        = 0;
+        const Footer*   footer      = NULL;
+        const uint8_t*  directory   = NULL;
+        size_t          groupSize   = 0;
+    };
+}
+
+#endif // SCIOSENSE_APC1_COLUMNAR_H
@@ -0,0 +1,218 @@
+// Runs simulated 1 Hz measurements with outages through an Apc1_Downsampler with 1 s, 1 min,
+// 15 min and 1 h tiers and checks every bucket a query reports against the raw samples: count,
+// min and max exactly, mean within float precision. It prints the memory and retention per tier,
+// the bytes per retained day, and the cost of an update and of a query.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_downsample apc1_downsample.cpp
+//   ./apc1_downsample [days]
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <vector>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Downsampler.h"
+
+#define FIELD_MASK  ( APC1_FIELD_MASK(APC1_FIELD_PM_1_0)  | APC1_FIELD_MASK(APC1_FIELD_PM_2_5)  | APC1_FIELD_MASK(APC1_FIELD_PM_10)   \
+                    | APC1_FIELD_MASK(APC1_FIELD_TVOC)    | APC1_FIELD_MASK(APC1_FIELD_ECO2)    | APC1_FIELD_MASK(APC1_FIELD_T_COMP) \
+                    | APC1_FIELD_MASK(APC1_FIELD_RH_COMP) | APC1_FIELD_MASK(APC1_FIELD_RS0) )
+#define FIELDS      (8)
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+struct Sample
+{
+    uint32_t timestamp;
+    uint32_t values[APC1_FIELD_COUNT];
+};
+
+struct Check
+{
+    const Apc1_Downsampler*     ds;
+    const std::vector<Sample>*  samples;
+    uint32_t                    end         = 0;    // end of the previous result
+    size_t                      results     = 0;
+    size_t                      perTier[APC1_DOWNSAMPLE_MAX_TIERS] = { 0 };
+    size_t                      errors      = 0;
+    bool                        verify      = true;
+};
+
+static void onResult(void* context, const Apc1_DownsampleResult* result)
+{
+    Check* check = (Check*)context;
+
+    check->results++;
+    check->perTier[result->tier]++;
+
+    // in time order and without overlaps
+    if (check->results > 1 && result->start < check->end)
+    {
+        check->errors++;
+    }
+    check->end = result->start + result->duration;
+
+    if (!check->verify)
+    {
+        return;
+    }
+
+    // an open bucket of a coarser tier holds only the closed buckets of the finer one
+    const std::vector<Sample>& samples = *check->samples;
+    const auto byTime   = [](const Sample& sample, const uint32_t timestamp) { return sample.timestamp < timestamp; };
+    const auto begin    = std::lower_bound(samples.begin(), samples.end(), result->start, byTime);
+    const auto end      = std::lower_bound(begin, samples.end(), result->start + result->duration, byTime);
+    const uint32_t count = (uint32_t)(end - begin);
+    if (result->open && result->tier > 0)
+    {
+        check->errors += (result->count > count) ? 1 : 0;
+        return;
+    }
+    if (count != result->count)
+    {
+        check->errors++;
+        return;
+    }
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        const Apc1_DownsampleStats* stats = Apc1_Downsampler_GetStats(check->ds, result, field);
+        if (stats == NULL)
+        {
+            continue;
+        }
+
+        uint32_t min    = UINT32_MAX;
+        uint32_t max    = 0;
+        double sum      = 0;
+        for (auto sample = begin; sample != end; sample++)
+        {
+            min  = (sample->values[field] < min) ? sample->values[field] : min;
+            max  = (sample->values[field] > max) ? sample->values[field] : max;
+            sum += sample->values[field];
+        }
+
+        const double mean = sum / count;
+        if (stats->min != min || stats->max != max || fabs(stats->mean - mean) > 1e-4 * (fabs(mean) + 1))
+        {
+            check->errors++;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const uint32_t days = (argc > 1) ? strtoul(argv[1], NULL, 10) : 14;
+
+    static const uint32_t durations[4]  = { 1, 60, 900, 3600 };
+    static const uint16_t capacities[4] = { 600, 1440, 672, 720 };
+    std::vector<Apc1_DownsampleBucket>  buckets[4];
+    std::vector<Apc1_DownsampleStats>   stats[4];
+    Apc1_DownsampleTier tiers[4];
+
+    for (int i = 0; i < 4; i++)
+    {
+        buckets[i].resize(capacities[i]);
+        stats[i].resize((size_t)capacities[i] * FIELDS);
+        tiers[i] = APC1_DOWNSAMPLE_TIER(durations[i], capacities[i], buckets[i].data(), stats[i].data());
+    }
+
+    Apc1_Downsampler ds;
+    if (Apc1_Downsampler_Init(&ds, tiers, 4, FIELD_MASK) != RESULT_OK)
+    {
+        fprintf(stderr, "invalid tiers\n");
+        return 1;
+    }
+
+    // 1 Hz frames with about one outage of up to 2 h per day, starting at an odd time
+    ScioSense::Apc1Simulator::Environment environment(7);
+    ScioSense::Apc1Simulator::Random random(7);
+    std::vector<Sample> samples;
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    const uint32_t first = 1700000000u + 1234;
+    uint32_t timestamp = first;
+
+    samples.reserve((size_t)days * 86400);
+    while (timestamp < first + days * 86400)
+    {
+        environment.step((uint64_t)timestamp * 1000);
+        environment.frame(frame, 0x25);
+
+        Sample sample;
+        sample.timestamp = timestamp;
+        for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+        {
+            sample.values[field] = Apc1_GetFieldValue(frame, field);
+        }
+        samples.push_back(sample);
+        Apc1_Downsampler_Add(&ds, timestamp, frame);
+
+        timestamp += (random.uniform() < 1.0f / 86400) ? 1 + random.next() % 7200 : 1;
+    }
+
+    printf("%zu samples over %u days, %d fields, %zu bytes per bucket\n\n", samples.size(), days, FIELDS, APC1_DOWNSAMPLE_BUCKET_SIZE(FIELDS));
+    printf("%-6s %8s %10s %12s %14s %12s\n", "tier", "bucket", "capacity", "retention", "bytes/day", "bytes");
+    size_t total = 0;
+    for (int i = 0; i < 4; i++)
+    {
+        const size_t bytes = capacities[i] * APC1_DOWNSAMPLE_BUCKET_SIZE(FIELDS);
+        printf("%-6d %7us %10u %11.1fh %14lu %12zu\n", i, durations[i], capacities[i], Apc1_Downsampler_GetRetention(&ds, i) / 3600.0,
+            (unsigned long)APC1_DOWNSAMPLE_BYTES_PER_DAY(durations[i], FIELDS), bytes);
+        total += bytes;
+    }
+    printf("%-6s %8s %10s %12s %14s %12zu\n\n", "total", "", "", "", "", total);
+
+    // the whole history, verified against the raw samples
+    Check check;
+    check.ds        = &ds;
+    check.samples   = &samples;
+    Apc1_Downsampler_Query(&ds, first, timestamp + 1, onResult, &check);
+    printf("query of all %u days: %zu results (%zu h, %zu 15 min, %zu min, %zu s), %zu errors\n", days, check.results,
+        check.perTier[3], check.perTier[2], check.perTier[1], check.perTier[0], check.errors);
+
+    // cost of a query of the last day, without verification
+    Check quick;
+    quick.ds        = &ds;
+    quick.samples   = &samples;
+    quick.verify    = false;
+    const int queries = 1000;
+    double t = seconds();
+    for (int i = 0; i < queries; i++)
+    {
+        quick.results = 0;
+        Apc1_Downsampler_Query(&ds, timestamp - 86400, timestamp + 1, onResult, &quick);
+    }
+    const double query = (seconds() - t) / queries;
+
+    // cost of an update, replaying the frames of the last day into the cleared tiers
+    std::vector<uint8_t> frames;
+    const size_t replay = (samples.size() < 86400) ? samples.size() : 86400;
+    for (size_t i = samples.size() - replay; i < samples.size(); i++)
+    {
+        uint8_t data[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH] = { 0 };
+        for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+        {
+            Apc1_SetFieldValue(data, field, samples[i].values[field]);
+        }
+        frames.insert(frames.end(), data, data + APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+    }
+    Apc1_Downsampler_Init(&ds, tiers, 4, FIELD_MASK);
+    t = seconds();
+    for (size_t i = 0; i < replay; i++)
+    {
+        Apc1_Downsampler_Add(&ds, samples[samples.size() - replay + i].timestamp, &frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH]);
+    }
+    const double update = (seconds() - t) / replay;
+
+    printf("update %.1f ns; query of the last day %.1f us for %zu results\n", update * 1e9, query * 1e6, quick.results);
+
+    return check.errors ? 2 : 0;
+}
@@ -0,0 +1,288 @@
+#ifndef SCIOSENSE_APC1_FLEET_H
+#define SCIOSENSE_APC1_FLEET_H
+
+#include <math.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+namespace ScioSense::Apc1Fleet
+{
+    // Aligns the measurements of many APC1s with independent timing to a common tick.
+    //
+    // Every sensor keeps a small ring of its latest samples. A tick is emitted when each sensor
+    // has a sample at or after it, or at the latest maxLatency ms after it. The value of a sensor
+    // at a tick is interpolated between its samples around the tick (Alignment::Linear) or carried
+    // from the last sample before it (Alignment::LastValue); samples older than maxAge are not
+    // used, so a silent sensor is reported as missing (NaN) instead of frozen.
+    //
+    // Ticks are collected in a Batch of structure-of-arrays columns: per field, ticks x sensors
+    // contiguous floats, ready for vectorized processing or a single bulk upload. All memory is
+    // allocated by the constructor.
+
+    enum class Alignment : uint8_t { LastValue, Linear };
+
+    // Batch::states
+    static constexpr uint8_t stateMissing       = 0;
+    static constexpr uint8_t stateCarried       = 1;    // value of the last sample before the tick
+    static constexpr uint8_t stateInterpolated  = 2;    // between the samples around the tick, or exactly at it
+
+    struct Config
+    {
+        uint32_t    sensors         = 1;
+        uint32_t    fieldMask       = APC1_FIELD_MASK(APC1_FIELD_PM_2_5);
+        uint32_t    tickInterval    = 1000;     // ms
+        uint32_t    maxLatency      = 2000;     // ms a tick waits for late sensors
+        uint32_t    maxAge          = 5000;     // ms a sample may be carried or interpolated over
+        uint32_t    ticksPerBatch   = 60;
+        uint8_t     history         = 8;        // samples kept per sensor; bounds the buffering
+        Alignment   alignment       = Alignment::Linear;
+    };
+
+    class Batch
+    {
+    public:
+        inline uint32_t         ticks()                             const { return tickCount; }
+        inline uint32_t         sensors()                           const { return sensorCount; }
+        inline uint32_t         fields()                            const { return fieldCount; }
+        inline uint32_t         fieldMask()                         const { return mask; }
+        inline const uint64_t*  timestamps()                        const { return times.data(); }
+        inline const float*     column(const uint32_t field)        const { return values.data() + (size_t)field * stride; }   // ticks() x sensors(); field is the index within fieldMask
+        inline const uint8_t*   states()                            const { return state.data(); }                             // ticks() x sensors()
+        inline float            value(const uint32_t tick, const uint32_t sensor, const uint32_t field) const { return column(field)[(size_t)tick * sensorCount + sensor]; }
+
+    private:
+        friend class Merger;
+
+        uint32_t                tickCount   = 0;
+        uint32_t                sensorCount = 0;
+        uint32_t                fieldCount  = 0;
+        uint32_t                mask        = 0;
+        size_t                  stride      = 0;
+        std::vector<uint64_t>   times;
+        std::vector<float>      values;
+        std::vector<uint8_t>    state;
+    };
+
+    class Merger
+    {
+    public:
+        explicit Merger(const Config& config) : config(config)
+        {
+            fieldCount  = (uint32_t)__builtin_popcount(config.fieldMask & APC1_FIELD_MASK_ALL);
+            history     = (config.history < 2) ? 2 : config.history;
+
+            sampleTimes.assign((size_t)config.sensors * history, 0);
+            sampleValues.assign((size_t)config.sensors * history * fieldCount, 0.0f);
+            heads.assign(config.sensors, 0);
+            counts.assign(config.sensors, 0);
+
+            for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+            {
+                if (config.fieldMask & APC1_FIELD_MASK(field))
+                {
+                    fields.push_back(field);
+                }
+            }
+
+            waiting             = config.sensors;
+            batch.sensorCount   = config.sensors;
+            batch.fieldCount    = fieldCount;
+            batch.mask          = config.fieldMask & APC1_FIELD_MASK_ALL;
+            batch.stride        = (size_t)config.ticksPerBatch * config.sensors;
+            batch.times.assign(config.ticksPerBatch, 0);
+            batch.values.assign(batch.stride * fieldCount, NAN);
+            batch.state.assign(batch.stride, stateMissing);
+        }
+
+        // adds a validated measurement frame of sensor, received at timestamp (ms); samples must be in time order per sensor
+        inline void push(const uint32_t sensor, const uint64_t timestamp, const uint8_t* measurementData)
+        {
+            if (sensor >= config.sensors)
+            {
+                return;
+            }
+
+            if (!started)
+            {
+                // the first tick is the first multiple of tickInterval at or after the first sample
+                nextTick    = (timestamp + config.tickInterval - 1) / config.tickInterval * config.tickInterval;
+                started     = true;
+            }
+
+            const uint32_t count = counts[sensor];
+            if (count > 0 && timestamp < timeAt(sensor, count - 1))
+            {
+                dropped++;
+                return;
+            }
+
+            if ((count == 0 || timeAt(sensor, count - 1) < nextTick) && timestamp >= nextTick)
+            {
+                waiting--;
+            }
+
+            if (count == history)
+            {
+                // ring full: the oldest sample goes
+                heads[sensor] = (heads[sensor] + 1) % history;
+                counts[sensor]--;
+                overwritten++;
+            }
+
+            const uint32_t slot = (heads[sensor] + counts[sensor]) % history;
+            sampleTimes[(size_t)sensor * history + slot] = timestamp;
+
+            float* values = &sampleValues[((size_t)sensor * history + slot) * fieldCount];
+            for (uint32_t f = 0; f < fieldCount; f++)
+            {
+                values[f] = (float)Apc1_GetFieldValue(measurementData, fields[f]);
+            }
+            counts[sensor]++;
+        }
+
+        // emits all ticks which are complete at now (ms) and calls sink(const Batch&) for every full batch
+        template<class Sink>
+        inline void advance(const uint64_t now, Sink&& sink)
+        {
+            while (started && ready(now))
+            {
+                emit(nextTick);
+                nextTick += config.tickInterval;
+                countWaiting();
+
+                if (batch.tickCount == config.ticksPerBatch)
+                {
+                    sink((const Batch&)batch);
+                    batch.tickCount = 0;
+                }
+            }
+        }
+
+        // hands out a partial batch, e.g. on shutdown
+        template<class Sink>
+        inline void flush(Sink&& sink)
+        {
+            if (batch.tickCount > 0)
+            {
+                sink((const Batch&)batch);
+                batch.tickCount = 0;
+            }
+        }
+
+        inline uint64_t dropCount()         const { return dropped; }       // samples rejected for being out of order
+        inline uint64_t overwriteCount()    const { return overwritten; }   // samples lost before their tick because history was too small
+
+    private:
+        inline uint64_t timeAt(const uint32_t sensor, const uint32_t index) const
+        {
+            return sampleTimes[(size_t)sensor * history + (heads[sensor] + index) % history];
+        }
+
+        inline const float* valuesAt(const uint32_t sensor, const uint32_t index) const
+        {
+            return &sampleValues[((size_t)sensor * history + (heads[sensor] + index) % history) * fieldCount];
+        }
+
+        inline bool ready(const uint64_t now)
+        {
+            if (now >= nextTick + config.maxLatency)
+            {
+                return true;
+            }
+            return now >= nextTick && waiting == 0;
+        }
+
+        // sensors without a sample at or after nextTick; kept up to date by push
+        inline void countWaiting()
+        {
+            waiting = 0;
+            for (uint32_t sensor = 0; sensor < config.sensors; sensor++)
+            {
+                waiting += (counts[sensor] == 0 || timeAt(sensor, counts[sensor] - 1) < nextTick) ? 1 : 0;
+            }
+        }
+
+        inline void emit(const uint64_t tick)
+        {
+            const uint32_t row = batch.tickCount++;
+            batch.times[row] = tick;
+
+            for (uint32_t sensor = 0; sensor < config.sensors; sensor++)
+            {
+                // drop samples which are no longer needed: keep the last one at or before the tick
+                while (counts[sensor] >= 2 && timeAt(sensor, 1) <= tick)
+                {
+                    heads[sensor] = (heads[sensor] + 1) % history;
+                    counts[sensor]--;
+                }
+
+                const size_t cell = (size_t)row * config.sensors + sensor;
+                uint8_t state = stateMissing;
+                const float* before = NULL;
+                const float* after  = NULL;
+                uint64_t tBefore = 0, tAfter = 0;
+
+                if (counts[sensor] > 0 && timeAt(sensor, 0) <= tick)
+                {
+                    before  = valuesAt(sensor, 0);
+                    tBefore = timeAt(sensor, 0);
+                    if (counts[sensor] > 1)
+                    {
+                        after   = valuesAt(sensor, 1);
+                        tAfter  = timeAt(sensor, 1);
+                    }
+                }
+
+                if (before != NULL && tBefore == tick)
+                {
+                    state = stateInterpolated;
+                    after = NULL;
+                }
+                else if (before != NULL && after != NULL && config.alignment == Alignment::Linear && tAfter - tBefore <= config.maxAge)
+                {
+                    const float weight = (float)(tick - tBefore) / (float)(tAfter - tBefore);
+                    for (uint32_t f = 0; f < fieldCount; f++)
+                    {
+                        batch.values[(size_t)f * batch.stride + cell] = before[f] + (after[f] - before[f]) * weight;
+                    }
+                    batch.state[cell] = stateInterpolated;
+                    continue;
+                }
+                else if (before != NULL && tick - tBefore <= config.maxAge)
+                {
+                    state = stateCarried;
+                }
+                else
+                {
+                    before = NULL;
+                }
+
+                for (uint32_t f = 0; f < fieldCount; f++)
+                {
+                    batch.values[(size_t)f * batch.stride + cell] = before ? before[f] : NAN;
+                }
+                batch.state[cell] = state;
+            }
+        }
+
+        Config                  config;
+        uint32_t                fieldCount  = 0;
+        uint32_t                history     = 0;
+        bool                    started     = false;
+        uint64_t                nextTick    = 0;
+        uint32_t                waiting     = 0;
+        uint64_t                dropped     = 0;
+        uint64_t                overwritten = 0;
+        std::vector<uint8_t>    fields;
+        std::vector<uint64_t>   sampleTimes;
+        std::vector<float>      sampleValues;
+        std::vector<uint32_t>   heads;
+        std::vector<uint32_t>   counts;
+        Batch                   batch;
+    };
+}
+
+#endif // SCIOSENSE_APC1_FLEET_H
@@ -0,0 +1,204 @@
+// Fuzz target for the frame parsers. Every input is passed to Apc1_FindMeasurementData,
+// Apc1_CheckMeasurementData (on each complete 64 byte window), Apc1_CheckCommandResponse and
+// Apc1_CheckSensorVersionResponse (with buffers of exactly the input size) and Apc1_Update, which reads it as a UART stream in passive
+// and active mode. The buffers are allocated with the exact size, so the sanitizer reports any
+// read beyond the data the parsers were given.
+//
+// With libFuzzer (clang):
+//   clang++ -std=c++17 -g -O1 -fsanitize=fuzzer,address,undefined -I../../src -o apc1_fuzz apc1_fuzz.cpp
+//   ./apc1_fuzz -max_len=512 corpus/
+//
+// Without libFuzzer, a built-in driver runs random and mutated inputs or the given files:
+//   g++ -std=c++17 -g -O1 -fsanitize=address,undefined -DAPC1_FUZZ_STANDALONE -I../../src -o apc1_fuzz apc1_fuzz.cpp
+//   ./apc1_fuzz [iterations | files...]
+//
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <vector>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+struct FuzzIO
+{
+    const uint8_t*  data;
+    size_t          size;
+    size_t          position;
+};
+
+static Result fuzzRead(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    FuzzIO* io = (FuzzIO*)config;
+    if (io->size - io->position < size)
+    {
+        io->position = io->size;
+        return RESULT_IO_ERROR;
+    }
+
+    memcpy(data, io->data + io->position, size);
+    io->position += size;
+    return RESULT_OK;
+}
+
+static Result fuzzWrite(void* config, const uint16_t address, uint8_t* data, const size_t size)     { return RESULT_OK; }
+static Result fuzzClear(void* config)                                                               { return RESULT_OK; }
+static void   fuzzWait(const uint32_t ms)                                                           { }
+
+static void fuzzUpdate(const uint8_t* data, const size_t size, const Apc1_MeasurementMode mode)
+{
+    FuzzIO io = { data, size, 0 };
+    ScioSense_Apc1 apc1;
+
+    memset(&apc1, 0, sizeof(ScioSense_Apc1));
+    apc1.io.read            = fuzzRead;
+    apc1.io.write           = fuzzWrite;
+    apc1.io.clear           = fuzzClear;
+    apc1.io.wait            = fuzzWait;
+    apc1.io.protocol        = APC1_PROTOCOL_UART;
+    apc1.io.config          = &io;
+    apc1.operatingMode      = APC1_OPERATING_MODE_STANDARD;
+    apc1.measurementMode    = mode;
+    apc1.updateOptions      = APC1_UPDATE_OPTION_SUPPRESS_DUPLICATES;
+
+    // every update consumes at least one byte or fails
+    while (io.position < io.size)
+    {
+        const size_t position = io.position;
+        const Result result = Apc1_Update(&apc1);
+        if (result == RESULT_OK && Apc1_CheckMeasurementData(apc1.measurementData) != RESULT_OK)
+        {
+            abort();
+        }
+        if (io.position == position)
+        {
+            break;
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size)
+{
+    // an exact size copy; data may be larger than size with some drivers
+    std::vector<uint8_t> buffer(data, data + size);
+    const uint8_t* input = buffer.data();
+    size_t offset;
+
+    for (size_t start = 0; start < size; start++)
+    {
+        const Result result = Apc1_FindMeasurementData(input + start, size - start, &offset);
+        if (offset > size - start || (result == RESULT_OK && Apc1_CheckMeasurementData(input + start + offset) != RESULT_OK))
+        {
+            abort();
+        }
+        start += offset;
+    }
+
+    for (size_t start = 0; start + APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH <= size; start++)
+    {
+        Apc1_CheckMeasurementData(input + start);
+    }
+
+    // responses shorter than expected, e.g. after a timeout
+    if (size > 0 && size <= 0xFF)
+    {
+        const Apc1_Command command = APC1_COMMAND_READ_SENSOR_VERSION;
+        uint8_t* response = new uint8_t[size];
+        memcpy(response, input, size);
+        Apc1_CheckCommandResponse(command, response, (Apc1_CommandResponse)size);
+        Apc1_CheckSensorVersionResponse(command, response, (Apc1_CommandResponse)size);
+        delete[] response;
+    }
+
+    fuzzUpdate(input, size, APC1_MEASUREMENT_MODE_ACTIVE);
+    fuzzUpdate(input, size, APC1_MEASUREMENT_MODE_PASSIVE);
+
+    return 0;
+}
+
+#ifdef APC1_FUZZ_STANDALONE
+
+#include "apc1_simulator.h"
+
+// mutates a valid frame stream, so most inputs get past the header checks
+static std::vector<uint8_t> mutate(ScioSense::Apc1Simulator::Random& random, ScioSense::Apc1Simulator::Environment& environment)
+{
+    std::vector<uint8_t> input;
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    const size_t frames = random.next() % 4;
+
+    for (size_t i = 0; i < frames; i++)
+    {
+        environment.step(i * 1000);
+        environment.frame(frame, 0x25);
+        input.insert(input.end(), frame, frame + APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+    }
+
+    const size_t mutations = random.next() % 8;
+    for (size_t i = 0; i < mutations; i++)
+    {
+        const size_t position = input.empty() ? 0 : random.next() % (input.size() + 1);
+        switch (random.next() % 4)
+        {
+            case 0:     if (position < input.size()) { input[position] ^= (uint8_t)(1 << (random.next() % 8)); }                      break;
+            case 1:     input.insert(input.begin() + position, (uint8_t)random.next());                                                break;
+            case 2:     input.resize(position);                                                                                        break;
+            default:    input.insert(input.begin() + position, { APC1_COMMAND_ADDRESS_START_BYTE_1, APC1_COMMAND_ADDRESS_START_BYTE_2 });   break;
+        }
+    }
+
+    return input;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 1 && strtoul(argv[1], NULL, 10) == 0)
+    {
+        for (int i = 1; i < argc; i++)
+        {
+            std::vector<uint8_t> input;
+            FILE* file = fopen(argv[i], "rb");
+            if (file == NULL)
+            {
+                perror(argv[i]);
+                return 1;
+            }
+            for (int c; (c = fgetc(file)) != EOF; )
+            {
+                input.push_back((uint8_t)c);
+            }
+            fclose(file);
+            LLVMFuzzerTestOneInput(input.data(), input.size());
+        }
+        printf("%d inputs\n", argc - 1);
+        return 0;
+    }
+
+    const size_t iterations = (argc > 1) ? strtoul(argv[1], NULL, 10) : 100000;
+    ScioSense::Apc1Simulator::Random random(1);
+    ScioSense::Apc1Simulator::Environment environment(1);
+
+    for (size_t i = 0; i < iterations; i++)
+    {
+        std::vector<uint8_t> input;
+        if (i % 2)
+        {
+            input.resize(random.next() % 256);
+            for (uint8_t& byte : input)
+            {
+                byte = (uint8_t)random.next();
+            }
+        }
+        else
+        {
+            input = mutate(random, environment);
+        }
+        LLVMFuzzerTestOneInput(input.data(), input.size());
+    }
+    printf("%zu inputs\n", iterations);
+
+    return 0;
+}
+
+#endif // APC1_FUZZ_STANDALONE
@@ -0,0 +1,205 @@
+// Runs Apc1_Pipeline with one producer thread and four sink threads, as on a dual core node with
+// an RTOS. The producer pushes simulated frames at a fixed rate; a transform drops frames with fan
+// errors, and the sinks are:
+//
+//      log         fast, DROP_OLDEST with a queue of 2
+//      store       lossless, BLOCK with a queue of 2; a write takes `store` µs, so it keeps up
+//      radio       a send takes `radio` ms, far longer than the frame interval; COALESCE with 1
+//      shm         fast, DROP_OLDEST with a queue of 1
+//
+// A push refused by the full store is repeated at the next poll, as a node leaves the frame in the
+// driver. It checks that every sink gets its frames in order, that the store gets every frame the
+// transform passed, and that all slots are free at the end; it prints the counters of all stages
+// and the longest Push, which is what the sensor polling waits for.
+//
+//   g++ -std=c++17 -O2 -Wall -pthread -I../../src -o apc1_pipeline apc1_pipeline.cpp
+//   ./apc1_pipeline [frames] [frame interval µs] [store µs] [radio ms]
+//
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define APC1_PIPELINE_POOL_SIZE (16)
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Pipeline.h"
+
+using Clock = std::chrono::steady_clock;
+
+static const Clock::time_point origin = Clock::now();
+
+static uint32_t millis()
+{
+    return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - origin).count();
+}
+
+static void lockMutex(void* context)
+{
+    ((std::mutex*)context)->lock();
+}
+
+static void unlockMutex(void* context)
+{
+    ((std::mutex*)context)->unlock();
+}
+
+static Result dropFanErrors(void*, Apc1_PipelineFrame* frame)
+{
+    return (Apc1_GetFieldValue(frame->measurementData, APC1_FIELD_ERROR_CODE) & APC1_ERROR_CODE_FAN_SPEED_TOO_LOW) ? RESULT_INVALID : RESULT_OK;
+}
+
+struct Sink
+{
+    const char*             name;
+    Apc1_PipelinePolicy     policy;
+    uint8_t                 length;
+    std::chrono::microseconds cost;
+    uint8_t                 stage           = APC1_PIPELINE_NONE;
+    int64_t                 lastSequence    = -1;
+    size_t                  outOfOrder      = 0;
+    std::vector<uint32_t>   sequences;
+
+    static Result deliver(void* context, const Apc1_PipelineFrame* frame)
+    {
+        Sink* sink = (Sink*)context;
+        if ((int64_t)frame->sequence <= sink->lastSequence)
+        {
+            sink->outOfOrder++;
+        }
+        sink->lastSequence = frame->sequence;
+        sink->sequences.push_back(frame->sequence);
+        std::this_thread::sleep_for(sink->cost);
+        return RESULT_OK;
+    }
+};
+
+int main(int argc, char** argv)
+{
+    const uint32_t frames   = (argc > 1) ? strtoul(argv[1], NULL, 10) : 20000;
+    const uint32_t interval = (argc > 2) ? strtoul(argv[2], NULL, 10) : 200;
+    const uint32_t storeUs  = (argc > 3) ? strtoul(argv[3], NULL, 10) : 100;
+    const uint32_t radioMs  = (argc > 4) ? strtoul(argv[4], NULL, 10) : 50;
+
+    std::mutex mutex;
+    const Apc1_PipelineLock lock = { lockMutex, unlockMutex, &mutex };
+    static Apc1_Pipeline pipeline;
+    Apc1_Pipeline_Init(&pipeline, millis, &lock);
+    const uint8_t transform = Apc1_Pipeline_AddTransform(&pipeline, dropFanErrors, NULL);
+
+    std::vector<Sink> sinks =
+    {
+        { "log",    APC1_PIPELINE_POLICY_DROP_OLDEST,   2, std::chrono::microseconds(0) },
+        { "store",  APC1_PIPELINE_POLICY_BLOCK,         2, std::chrono::microseconds(storeUs) },
+        { "radio",  APC1_PIPELINE_POLICY_COALESCE,      1, std::chrono::microseconds(radioMs * 1000) },
+        { "shm",    APC1_PIPELINE_POLICY_DROP_OLDEST,   1, std::chrono::microseconds(0) },
+    };
+    for (Sink& sink : sinks)
+    {
+        sink.stage = Apc1_Pipeline_AddSink(&pipeline, Sink::deliver, &sink, sink.policy, sink.length);
+        if (sink.stage == APC1_PIPELINE_NONE)
+        {
+            fprintf(stderr, "pool too small for %s\n", sink.name);
+            return 1;
+        }
+    }
+
+    std::atomic<bool> producing(true);
+    std::vector<std::thread> threads;
+    for (Sink& sink : sinks)
+    {
+        threads.emplace_back([&, stage = sink.stage]()
+        {
+            while (producing || Apc1_Pipeline_GetPending(&pipeline, stage) > 0)
+            {
+                if (Apc1_Pipeline_Service(&pipeline, stage, 8) == 0)
+                {
+                    std::this_thread::sleep_for(std::chrono::microseconds(50));
+                }
+            }
+        });
+    }
+
+    // the producer: one poll per interval; a refused frame is pushed again at the next poll
+    ScioSense::Apc1Simulator::Environment environment(9);
+    ScioSense::Apc1Simulator::Random random(9);
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    bool pending = false;
+    uint32_t refused = 0, filtered = 0, produced = 0;
+    double pushMax = 0, pushSum = 0;
+    Clock::time_point next = Clock::now();
+
+    while (produced < frames || pending)
+    {
+        if (!pending)
+        {
+            environment.step((uint64_t)produced * 1000);
+            environment.frame(frame, 0x25);
+            if (random.next() % 100 == 0)
+            {
+                frame[APC1_RESULT_ADDRESS_ERROR_CODE] = APC1_ERROR_CODE_FAN_SPEED_TOO_LOW;
+            }
+            produced++;
+        }
+
+        const Clock::time_point start   = Clock::now();
+        const Result result             = Apc1_Pipeline_Push(&pipeline, frame, produced);
+        const double duration           = std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+        pushMax  = std::max(pushMax, duration);
+        pushSum += duration;
+
+        pending = (result == RESULT_NOT_ALLOWED);
+        refused += pending ? 1 : 0;
+        filtered += (result == RESULT_NO_NEW_DATA) ? 1 : 0;
+
+        next += std::chrono::microseconds(interval);
+        std::this_thread::sleep_until(next);
+    }
+
+    producing = false;
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    size_t held = 0;
+    for (const Apc1_PipelineFrame& slot : pipeline.pool)
+    {
+        held += slot.references;
+    }
+
+    printf("%u frames every %u us, store %u us, radio %u ms\n\n", frames, interval, storeUs, radioMs);
+    printf("%-12s %9s %9s %10s %9s %9s %9s\n", "stage", "frames", "dropped", "coalesced", "blocked", "retries", "max ms");
+
+    std::vector<std::pair<const char*, uint8_t>> stages = { { "acquisition", 0 }, { "transform", transform } };
+    for (const Sink& sink : sinks)
+    {
+        stages.push_back({ sink.name, sink.stage });
+    }
+    for (const auto& stage : stages)
+    {
+        Apc1_PipelineStats stats;
+        Apc1_Pipeline_GetStats(&pipeline, stage.second, &stats);
+        printf("%-12s %9u %9u %10u %9u %9u %9u\n", stage.first, stats.frames, stats.dropped, stats.coalesced, stats.blocked, stats.retries, stats.latencyMax);
+    }
+
+    Apc1_PipelineStats passed;
+    Apc1_Pipeline_GetStats(&pipeline, transform, &passed);
+    bool ok = (held == 0) && (sinks[1].sequences.size() == passed.frames);
+    printf("\n");
+    for (const Sink& sink : sinks)
+    {
+        ok = ok && (sink.outOfOrder == 0);
+        printf("%-6s %zu frames out of order\n", sink.name, sink.outOfOrder);
+    }
+    printf("store got %zu of %u frames passed by the transform (%u filtered); %zu slot references left\n", sinks[1].sequences.size(), passed.frames, filtered, held);
+    printf("push: %u refused, mean %.2f us, max %.1f us; one copy per frame into %zu bytes of pool\n", refused, pushSum / (frames + refused), pushMax, sizeof(pipeline.pool));
+    printf("%s\n", ok ? "OK" : "FAILED");
+
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+// Runs Apc1_PowerManager against a simulated APC1 over the in-memory UART for a number of hours
+// of simulated time and prints the first cycles, the duty cycle and the energy against a device
+// which is always in standard mode. Mode commands can be made to fail: --fail drops the command
+// before the device sees it, --lost lets the device switch but drops its response. The fan-on
+// time the power manager reports is checked against the mode the device was really in; it may
+// only be higher, as a failed return to idle is accounted as fan-on time.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_power apc1_power.cpp
+//   ./apc1_power [--hours 6] [--fail p] [--lost p] [--seed n]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Power.h"
+
+using ScioSense::Apc1Simulator::Link;
+using ScioSense::Apc1Simulator::Random;
+
+struct Options
+{
+    uint32_t    hours   = 6;
+    float       fail    = 0.0f;     // probability per mode command of a failed write
+    float       lost    = 0.0f;     // probability per mode command of a lost response
+    uint32_t    seed    = 7;
+};
+
+// simulated clock and the device time in standard mode; the driver waits through io.wait
+struct Clock
+{
+    Link*       link;
+    uint64_t    now;
+    uint64_t    fanOn;
+};
+
+struct Faults
+{
+    Random      random;
+    float       fail;
+    float       lost;
+    uint32_t    failed;
+    uint32_t    dropped;
+};
+
+static Clock    clock_;
+static Faults*  faults;
+
+static void advance(const uint64_t to)
+{
+    if (clock_.link->device.mode() == APC1_OPERATING_MODE_STANDARD)
+    {
+        clock_.fanOn += to - clock_.now;
+    }
+    clock_.now = to;
+    clock_.link->advance(to);
+}
+
+static uint32_t millis()
+{
+    return (uint32_t)clock_.now;
+}
+
+static void wait(const uint32_t ms)
+{
+    advance(clock_.now + ms);
+}
+
+static Result write(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    const bool mode = size == APC1_COMMAND_LENGTH && data[2] == APC1_COMMAND_ADDRESS_OPERATION_MODE;
+
+    if (mode && faults->random.uniform() < faults->fail)
+    {
+        faults->failed++;
+        return RESULT_IO_ERROR;
+    }
+
+    const Result result = Link::write(config, address, data, size);
+    if (mode && faults->random.uniform() < faults->lost)
+    {
+        faults->dropped++;
+        Link::clear(config);
+    }
+
+    return result;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if      (!strcmp(argv[i], "--hours")    && i + 1 < argc)    { options.hours = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--fail")     && i + 1 < argc)    { options.fail  = strtof(argv[++i], NULL); }
+        else if (!strcmp(argv[i], "--lost")     && i + 1 < argc)    { options.lost  = strtof(argv[++i], NULL); }
+        else if (!strcmp(argv[i], "--seed")     && i + 1 < argc)    { options.seed  = strtoul(argv[++i], NULL, 10); }
+        else
+        {
+            fprintf(stderr, "usage: %s [--hours 6] [--fail p] [--lost p] [--seed n]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    Link link(1, options.seed, 123);
+    Faults injected = { Random(options.seed ^ 0xC0FFEEu), 0.0f, 0.0f, 0, 0 };
+    ScioSense_Apc1 apc1;
+
+    memset(&apc1, 0, sizeof(apc1));
+    link.attach(&apc1.io);
+    apc1.io.write           = write;
+    apc1.io.wait            = wait;
+    apc1.io.millis          = millis;
+    apc1.operatingMode      = APC1_OPERATING_MODE_STANDARD;
+    apc1.measurementMode    = APC1_MEASUREMENT_MODE_PASSIVE;
+
+    faults          = &injected;
+    clock_.link     = &link;
+    clock_.now      = 1735689600000ull;
+    clock_.fanOn    = 0;
+    link.advance(clock_.now);
+
+    if (Apc1_Reset(&apc1) != RESULT_OK)
+    {
+        fprintf(stderr, "reset failed\n");
+        return 1;
+    }
+
+    // faults start after the reset, which has its own retries
+    injected.fail   = options.fail;
+    injected.lost   = options.lost;
+
+    Apc1_PowerConfig config;
+    Apc1_PowerManager power;
+    Apc1_PowerManager_DefaultConfig(&config);
+    Apc1_PowerManager_Init(&power, &config, millis());
+
+    const uint64_t start    = clock_.now;
+    const uint64_t end      = start + (uint64_t)options.hours * 3600 * 1000;
+    clock_.fanOn            = 0;
+
+    printf("%-6s %9s %8s %8s %8s %9s %10s %10s\n", "cycle", "discarded", "settled", "samples", "mean", "fan on s", "interval s", "energy mJ");
+    while (clock_.now < end)
+    {
+        const Apc1_PowerEvent event = Apc1_PowerManager_Run(&power, &apc1, millis());
+        if (event == APC1_POWER_EVENT_CYCLE && power.cycles <= 12)
+        {
+            printf("%-6u %9u %8s %8u %8.1f %9.1f %10.1f %10u\n", power.cycles, power.cycle.discarded, power.cycle.settled ? "yes" : "no",
+                power.cycle.samples, power.cycle.mean, power.cycle.fanOnTime / 1000.0, power.cycle.interval / 1000.0, power.cycle.energy);
+        }
+
+        advance(clock_.now + Apc1_PowerManager_GetDelay(&power, millis()));
+    }
+
+    const double hours      = (double)(clock_.now - start) / 3600e3;
+    const double alwaysOn   = hours * 3600 * config.activePower / 1000.0;
+
+    printf("\n%.1f h: %u cycles, duty cycle %.1f %% (device %.1f %%), energy %.1f J, always on %.1f J (%.1f %%)\n", hours, power.cycles,
+        Apc1_PowerManager_GetDutyCycle(&power) / 10.0, 100.0 * clock_.fanOn / (clock_.now - start), power.energyTotal / 1000.0, alwaysOn,
+        100.0 * power.energyTotal / 1000.0 / alwaysOn);
+    printf("mode commands: %u failed, %u responses lost; %u power manager errors, %u frames\n", injected.failed, injected.dropped,
+        power.errors, apc1.stats.framesOk);
+
+    // the power manager counts up to its last run, the device up to the end of the last delay
+    if (power.fanOnTotal + (clock_.now - start - power.elapsedTotal) < clock_.fanOn)
+    {
+        printf("error: the power manager reports less fan-on time than the device ran\n");
+        return 1;
+    }
+
+    return 0;
+}
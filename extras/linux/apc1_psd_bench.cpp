@@ -0,0 +1,133 @@
+// Compares Apc1_Distribution_FromFrame per frame with Apc1_Distribution_Batch on columns of
+// simulated frames: throughput, and the largest deviation of both from a double precision
+// reference of the same formulas.
+//
+//   g++ -std=c++17 -O3 -ffast-math -march=native -Wall -I../../src -o apc1_psd_bench apc1_psd_bench.cpp
+//   ./apc1_psd_bench [frames]
+//
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <vector>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Distribution.h"
+
+static double seconds()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+struct Reference
+{
+    double massTotal;
+    double gmd;
+};
+
+// the formulas of the module in double precision, with the bin diameters computed from the edges
+static Reference reference(const uint16_t* cumulative, const double density)
+{
+    static const double edges[APC1_DISTRIBUTION_BINS + 1] = { 0.3, 0.5, 1.0, 2.5, 5.0, 10.0, 20.0 };
+    double number = 0, mass = 0, logSum = 0;
+
+    for (int b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        const double d = sqrt(edges[b] * edges[b + 1]);
+        const double difference = cumulative[b] - ((b + 1 < APC1_DISTRIBUTION_BINS) ? (double)cumulative[b + 1] : 0.0);
+        const double n = fmax(difference, 0.0) * 1e4;
+        number += n;
+        mass   += n * density * M_PI / 6 * d * d * d * 1e-6;
+        logSum += n * log(d);
+    }
+
+    return { mass, number > 0 ? exp(logSum / number) : 0.0 };
+}
+
+static double deviation(const double value, const double expected)
+{
+    return fabs(value - expected) / ((fabs(expected) > 1e-9) ? fabs(expected) : 1.0);
+}
+
+int main(int argc, char** argv)
+{
+    const size_t count = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1000000;
+
+    std::vector<uint8_t> frames(count * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+    std::vector<uint16_t> cumulative[APC1_DISTRIBUTION_BINS];
+    ScioSense::Apc1Simulator::Environment environment(5);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        uint8_t* frame = &frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+        environment.step(i * 1000);
+        environment.frame(frame, 0x25);
+        for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+        {
+            cumulative[b].push_back((uint16_t)Apc1_GetFieldValue(frame, APC1_FIELD_NOPARTICLES_0_3 + b));
+        }
+    }
+
+    // per frame, as on the device
+    std::vector<Apc1_Distribution> distributions(count);
+    double t = seconds();
+    for (size_t i = 0; i < count; i++)
+    {
+        Apc1_Distribution_FromFrame(&frames[i * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH], APC1_DISTRIBUTION_DEFAULT_DENSITY, &distributions[i]);
+    }
+    const double frameTime = seconds() - t;
+
+    // columns, totals only and with all bins
+    std::vector<float> numberTotal(count), massTotal(count), gmd(count), gsd(count);
+    std::vector<float> number[APC1_DISTRIBUTION_BINS], mass[APC1_DISTRIBUTION_BINS];
+    Apc1_DistributionColumns columns = { };
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        columns.cumulative[b] = cumulative[b].data();
+        number[b].resize(count);
+        mass[b].resize(count);
+    }
+    columns.numberTotal = numberTotal.data();
+    columns.massTotal   = massTotal.data();
+    columns.gmd         = gmd.data();
+    columns.gsd         = gsd.data();
+
+    t = seconds();
+    Apc1_Distribution_Batch(&columns, count, APC1_DISTRIBUTION_DEFAULT_DENSITY);
+    const double totalsTime = seconds() - t;
+
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        columns.number[b]   = number[b].data();
+        columns.mass[b]     = mass[b].data();
+    }
+    t = seconds();
+    Apc1_Distribution_Batch(&columns, count, APC1_DISTRIBUTION_DEFAULT_DENSITY);
+    const double binsTime = seconds() - t;
+
+    double frameError = 0, batchError = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        uint16_t row[APC1_DISTRIBUTION_BINS];
+        for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+        {
+            row[b] = cumulative[b][i];
+        }
+        const Reference expected = reference(row, APC1_DISTRIBUTION_DEFAULT_DENSITY);
+        const double e1 = fmax(deviation(distributions[i].massTotal, expected.massTotal), deviation(distributions[i].gmd, expected.gmd));
+        const double e2 = fmax(deviation(massTotal[i], expected.massTotal), deviation(gmd[i], expected.gmd));
+        frameError = fmax(frameError, e1);
+        batchError = fmax(batchError, e2);
+    }
+
+    printf("%zu frames\n\n", count);
+    printf("%-34s %12s %14s %14s\n", "", "ns/frame", "Mframes/s", "max rel. error");
+    printf("%-34s %12.2f %14.1f %14.2e\n", "Apc1_Distribution_FromFrame", frameTime * 1e9 / count, count / frameTime / 1e6, frameError);
+    printf("%-34s %12.2f %14.1f %14.2e\n", "Apc1_Distribution_Batch, totals", totalsTime * 1e9 / count, count / totalsTime / 1e6, batchError);
+    printf("%-34s %12.2f %14.1f %14s\n", "Apc1_Distribution_Batch, all bins", binsTime * 1e9 / count, count / binsTime / 1e6, "");
+
+    return (frameError < 1e-3 && batchError < 1e-3) ? 0 : 2;
+}
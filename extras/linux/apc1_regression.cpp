@@ -0,0 +1,166 @@
+// Regression checks for driver behaviour that the simulator based tools do not reach: each check
+// drives the driver through a scripted transport and compares the results with the expected ones.
+// It prints one line per check and exits with 1 if any of them failed.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_regression apc1_regression.cpp
+//   ./apc1_regression
+//
+#include <stdio.h>
+#include <string.h>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+#include "lib/apc1/ScioSense_Apc1_Binary.h"
+
+// an I2C device with a fixed register map; the next `corrupt` reads have a flipped bit
+struct Device
+{
+    uint8_t     frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    uint32_t    corrupt;
+    uint32_t    reads;
+    uint32_t    now;
+};
+
+static Device device;
+
+static Result read(void*, const uint16_t address, uint8_t* data, const size_t size)
+{
+    device.reads++;
+    for (size_t i = 0; i < size; i++)
+    {
+        data[i] = address + i < sizeof(device.frame) ? device.frame[address + i] : 0;
+    }
+    if (device.corrupt > 0)
+    {
+        device.corrupt--;
+        data[size - 1] ^= 0x80;
+    }
+    return RESULT_OK;
+}
+
+static Result write(void*, const uint16_t, uint8_t*, const size_t)
+{
+    return RESULT_OK;
+}
+
+static void wait(const uint32_t ms)
+{
+    device.now += ms;
+}
+
+static uint32_t millis()
+{
+    return device.now;
+}
+
+static void seal(uint8_t* frame)
+{
+    uint16_t checksum = 0;
+    for (int i = 0; i < APC1_RESULT_ADDRESS_CHECKSUM_H; i++)
+    {
+        checksum += frame[i];
+    }
+    frame[APC1_RESULT_ADDRESS_CHECKSUM_H] = checksum >> 8;
+    frame[APC1_RESULT_ADDRESS_CHECKSUM_L] = checksum & 0xFF;
+}
+
+static void setup(ScioSense_Apc1* apc1)
+{
+    memset(&device, 0, sizeof(device));
+    device.frame[APC1_RESULT_ADDRESS_FRAME_HEADER]      = 0x42;
+    device.frame[APC1_RESULT_ADDRESS_FRAME_HEADER + 1]  = 0x4D;
+    device.frame[APC1_RESULT_ADDRESS_FRAME_LENGTH + 1]  = APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH - 4;
+    device.frame[APC1_RESULT_ADDRESS_PM_2_5 + 1]        = 12;
+    device.frame[APC1_RESULT_ADDRESS_AQI]               = 1;
+    device.frame[APC1_RESULT_ADDRESS_FIRMWARE_VERSION]  = 34;
+    seal(device.frame);
+
+    memset(apc1, 0, sizeof(*apc1));
+    apc1->io.read           = read;
+    apc1->io.write          = write;
+    apc1->io.wait           = wait;
+    apc1->io.millis         = millis;
+    apc1->io.protocol       = APC1_PROTOCOL_I2C;
+    apc1->operatingMode     = APC1_OPERATING_MODE_STANDARD;
+    apc1->measurementMode   = APC1_MEASUREMENT_MODE_ACTIVE;
+}
+
+// A corrupted read must not leave the checksum of the previous frame behind: the next peek would
+// match it and report the corrupted measurement data as unchanged.
+static bool peekAfterFailedRead()
+{
+    ScioSense_Apc1 apc1;
+    setup(&apc1);
+    apc1.updateOptions = APC1_UPDATE_OPTION_PEEK_CHECKSUM;
+
+    const Result first  = Apc1_Update(&apc1);
+
+    // the device has not refreshed; both the peek and the frame read are corrupted
+    device.corrupt      = 2;
+    const Result second = Apc1_Update(&apc1);
+    const Result third  = Apc1_Update(&apc1);
+
+    return first  == RESULT_OK
+        && second == RESULT_CHECKSUM_ERROR
+        && third  == RESULT_OK
+        && memcmp(apc1.measurementData, device.frame, sizeof(device.frame)) == 0;
+}
+
+// All fields make more than 23 map entries, so the map header takes 2 bytes. A buffer of exactly
+// the encoded length must be enough, one byte less must be refused without a write past its end.
+static bool cborBufferSize()
+{
+    ScioSense_Apc1 apc1;
+    setup(&apc1);
+    memcpy(apc1.measurementData, device.frame, sizeof(device.frame));
+    apc1.serialNumber   = 0x0123456789ABCDEFull;
+    apc1.fwVersion      = 34;
+
+    uint8_t reference[128];
+    const size_t length = Apc1_EncodeCbor(&apc1, APC1_FIELD_MASK_ALL, 1735689600, reference, sizeof(reference));
+    if (length == 0 || length == sizeof(reference))
+    {
+        return false;
+    }
+
+    // a guard byte behind the buffer
+    uint8_t exact[sizeof(reference) + 1];
+    memset(exact, 0xEE, sizeof(exact));
+    const size_t written = Apc1_EncodeCbor(&apc1, APC1_FIELD_MASK_ALL, 1735689600, exact, length);
+
+    uint8_t shorter[sizeof(reference) + 1];
+    memset(shorter, 0xEE, sizeof(shorter));
+    const size_t refused = Apc1_EncodeCbor(&apc1, APC1_FIELD_MASK_ALL, 1735689600, shorter, length - 1);
+
+    return reference[0] == (0xA0 | 24)
+        && written == length
+        && memcmp(exact, reference, length) == 0
+        && exact[length] == 0xEE
+        && refused == 0
+        && shorter[length - 1] == 0xEE;
+}
+
+struct Check
+{
+    const char* name;
+    bool        (*run)();
+};
+
+static const Check checks[] =
+{
+    { "peek after a failed read",   peekAfterFailedRead },
+    { "CBOR buffer size",           cborBufferSize },
+};
+
+int main()
+{
+    int failed = 0;
+
+    for (const Check& check : checks)
+    {
+        const bool passed = check.run();
+        printf("%-32s %s\n", check.name, passed ? "ok" : "FAILED");
+        failed += passed ? 0 : 1;
+    }
+
+    return failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,254 @@
+#ifndef SCIOSENSE_APC1_SHM_H
+#define SCIOSENSE_APC1_SHM_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+namespace ScioSense::Apc1Shm
+{
+    // Latest-value table of APC1 measurements in POSIX shared memory.
+    //
+    // One publisher writes each sensor's latest frame to its own slot; any number of readers
+    // map the table read-only. Every slot is protected by a seqlock: the publisher increments
+    // the sequence to an odd value, writes the record and increments it to an even value again.
+    // Readers retry if the sequence was odd or changed during their copy, so they never block
+    // the publisher and never return a torn record. The record is stored as relaxed atomic
+    // words, which keeps the concurrent access well-defined.
+
+    static constexpr uint32_t magic     = 0x41504331;   // "APC1"
+    static constexpr uint32_t version   = 1;
+
+    struct Record
+    {
+        uint64_t    timestamp;                                          // ms since epoch of the frame arrival
+        uint64_t    serialNumber;
+        uint32_t    count;                                              // number of frames published to this slot
+        uint16_t    fwVersion;
+        uint8_t     reserved[2];
+        char        sensor[32];                                         // sensor name or port, zero terminated
+        uint8_t     measurementData[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    };
+
+    static constexpr size_t recordWords = (sizeof(Record) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    struct alignas(64) Slot
+    {
+        std::atomic<uint32_t>   sequence;
+        std::atomic<uint64_t>   words[recordWords];
+    };
+
+    struct Header
+    {
+        uint32_t    magic;
+        uint32_t    version;
+        uint32_t    slotCount;
+        uint32_t    slotSize;
+    };
+
+    static_assert(std::atomic<uint32_t>::is_always_lock_free && std::atomic<uint64_t>::is_always_lock_free, "seqlock needs lock-free atomics in shared memory");
+
+    static inline size_t tableSize(const uint32_t slotCount)
+    {
+        return sizeof(Slot) + (size_t)slotCount * sizeof(Slot);    // the header occupies the first slot sized block
+    }
+
+    static inline Slot* slotAt(void* table, const uint32_t index)
+    {
+        return reinterpret_cast<Slot*>(static_cast<uint8_t*>(table) + sizeof(Slot)) + index;
+    }
+
+    class Publisher
+    {
+    public:
+        Publisher() : table(nullptr), size(0), slotCount(0) { }
+        ~Publisher() { close(); }
+
+        // creates (or replaces) the shared memory object, e.g. "/apc1"
+        inline bool open(const char* name, const uint32_t slots)
+        {
+            int fd = shm_open(name, O_CREAT | O_RDWR, 0644);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            size = tableSize(slots);
+            if (ftruncate(fd, (off_t)size) != 0)
+            {
+                ::close(fd);
+                return false;
+            }
+
+            table = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (table == MAP_FAILED)
+            {
+                table = nullptr;
+                return false;
+            }
+
+            memset(table, 0, size);
+            slotCount           = slots;
+            Header* header      = static_cast<Header*>(table);
+            header->slotCount   = slots;
+            header->slotSize    = sizeof(Slot);
+            header->version     = version;
+            std::atomic_thread_fence(std::memory_order_release);
+            header->magic       = magic;
+
+            return true;
+        }
+
+        inline void close()
+        {
+            if (table != nullptr)
+            {
+                munmap(table, size);
+                table = nullptr;
+            }
+        }
+
+        // publishes the current measurement data of apc1; wait-free
+        inline void publish(const uint32_t index, const ScioSense_Apc1* apc1, const char* sensor, const uint64_t timestamp)
+        {
+            if (index >= slotCount)
+            {
+                return;
+            }
+
+            Slot* slot              = slotAt(table, index);
+            const uint32_t sequence = slot->sequence.load(std::memory_order_relaxed);
+            uint64_t words[recordWords] = { 0 };
+            Record* record          = reinterpret_cast<Record*>(words);
+
+            record->timestamp       = timestamp;
+            record->serialNumber    = apc1->serialNumber;
+            record->fwVersion       = apc1->fwVersion;
+            record->count           = sequence / 2 + 1;
+            strncpy(record->sensor, sensor, sizeof(record->sensor) - 1);
+            memcpy(record->measurementData, apc1->measurementData, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+
+            slot->sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (size_t i = 0; i < recordWords; i++)
+            {
+                slot->words[i].store(words[i], std::memory_order_relaxed);
+            }
+
+            slot->sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+    private:
+        void*       table;
+        size_t      size;
+        uint32_t    slotCount;
+    };
+
+    class Reader
+    {
+    public:
+        Reader() : table(nullptr), size(0), slotCount(0) { }
+        ~Reader() { close(); }
+
+        inline bool open(const char* name)
+        {
+            int fd = shm_open(name, O_RDONLY, 0);
+            if (fd < 0)
+            {
+                return false;
+            }
+
+            struct stat info;
+            if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(Slot))
+            {
+                ::close(fd);
+                return false;
+            }
+
+            size  = (size_t)info.st_size;
+            table = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            ::close(fd);
+            if (table == MAP_FAILED)
+            {
+                table = nullptr;
+                return false;
+            }
+
+            const Header* header = static_cast<const Header*>(table);
+            if (header->magic != magic || header->version != version || header->slotSize != sizeof(Slot) || tableSize(header->slotCount) > size)
+            {
+                close();
+                return false;
+            }
+
+            slotCount = header->slotCount;
+            return true;
+        }
+
+        inline void close()
+        {
+            if (table != nullptr)
+            {
+                munmap(table, size);
+                table = nullptr;
+            }
+        }
+
+        inline uint32_t slots() const { return slotCount; }
+
+        // copies the latest record of slot index; returns false, if nothing was published to it yet
+        inline bool read(const uint32_t index, Record& record) const
+        {
+            if (index >= slotCount)
+            {
+                return false;
+            }
+
+            Slot* slot = slotAt(table, index);
+            uint64_t words[recordWords];
+            uint32_t before, after;
+
+            do
+            {
+                before = slot->sequence.load(std::memory_order_acquire);
+                if (before & 1)
+                {
+                    continue;   // write in progress
+                }
+
+                for (size_t i = 0; i < recordWords; i++)
+                {
+                    words[i] = slot->words[i].load(std::memory_order_relaxed);
+                }
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = slot->sequence.load(std::memory_order_relaxed);
+            }
+            while ((before & 1) || before != after);
+
+            if (before == 0)
+            {
+                return false;
+            }
+
+            memcpy(&record, words, sizeof(Record));
+            return true;
+        }
+
+    private:
+        void*       table;
+        size_t      size;
+        uint32_t    slotCount;
+    };
+}
+
+#endif //SCIOSENSE_APC1_SHM_H
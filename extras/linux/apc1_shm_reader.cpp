@@ -0,0 +1,67 @@
+// Prints the latest APC1 measurements published to shared memory by apc1_collector --shm.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_shm_reader apc1_shm_reader.cpp
+//   ./apc1_shm_reader /apc1 [--watch ms]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "apc1_shm.h"
+
+using ScioSense::Apc1Shm::Reader;
+using ScioSense::Apc1Shm::Record;
+
+static void print(const Reader& reader)
+{
+    ScioSense_Apc1 apc1;
+    Record record;
+
+    for (uint32_t i = 0; i < reader.slots(); i++)
+    {
+        if (!reader.read(i, record))
+        {
+            continue;
+        }
+
+        // the getters of the driver decode the frame
+        memcpy(apc1.measurementData, record.measurementData, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+        printf("%-24s #%-8u %llu  PM1.0 %4u  PM2.5 %4u  PM10 %4u  TVOC %5u  eCO2 %5u  T %5.1f  RH %5.1f  error 0x%02x\n",
+            record.sensor, record.count, (unsigned long long)record.timestamp,
+            Apc1_GetPM_1_0(&apc1), Apc1_GetPM_2_5(&apc1), Apc1_GetPM_10(&apc1),
+            Apc1_GetTVOC(&apc1), Apc1_GetECO2(&apc1), Apc1_GetCompT(&apc1), Apc1_GetCompRH(&apc1),
+            Apc1_GetError(&apc1));
+    }
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "usage: %s <shm name> [--watch ms]\n", argv[0]);
+        return 1;
+    }
+
+    Reader reader;
+    if (!reader.open(argv[1]))
+    {
+        fprintf(stderr, "%s: no APC1 table\n", argv[1]);
+        return 1;
+    }
+
+    const useconds_t watch = (argc > 3 && strcmp(argv[2], "--watch") == 0) ? (useconds_t)strtoul(argv[3], NULL, 10) * 1000 : 0;
+    do
+    {
+        print(reader);
+        fflush(stdout);
+        if (watch)
+        {
+            usleep(watch);
+            printf("\n");
+        }
+    }
+    while (watch);
+
+    return 0;
+}
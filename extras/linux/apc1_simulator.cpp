@@ -0,0 +1,151 @@
+// Simulates APC1 sensors on pseudo terminals, one per sensor.
+// The slave device paths are printed to stdout; use them with apc1_collector for end-to-end tests.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_simulator apc1_simulator.cpp
+//   ./apc1_simulator 16 [--errors 0.01]
+//
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <termios.h>
+#include <unistd.h>
+
+#include <vector>
+
+#include "lib/io/ScioSense_IOInterface_Posix_Termios.h"
+#include "apc1_simulator.h"
+
+using ScioSense::Apc1Simulator::Device;
+
+struct Terminal
+{
+    int     master;
+    int     slave;      // kept open, so the master does not see a hangup between clients
+    Device  device;
+};
+
+static volatile sig_atomic_t running = 1;
+
+static void stop(int) { running = 0; }
+
+static void send(int fd, const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        ssize_t n = write(fd, data, size);
+        if (n <= 0)
+        {
+            return; // drop the rest, like a UART without a listener
+        }
+        data += n;
+        size -= (size_t)n;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    size_t count        = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1;
+    float errorRate     = 0.0f;
+
+    for (int i = 2; i + 1 < argc; i++)
+    {
+        if (strcmp(argv[i], "--errors") == 0)
+        {
+            errorRate = strtof(argv[++i], NULL);
+        }
+    }
+
+    signal(SIGINT, stop);
+    signal(SIGTERM, stop);
+
+    int epoll = epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Terminal*> terminals;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        int master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+        if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0)
+        {
+            perror("posix_openpt");
+            return 1;
+        }
+
+        const char* path = ptsname(master);
+        int slave        = open(path, O_RDWR | O_NOCTTY);
+        struct termios tty;
+        tcgetattr(slave, &tty);
+        cfmakeraw(&tty);
+        tcsetattr(slave, TCSANOW, &tty);
+
+        Terminal* terminal          = new Terminal { master, slave, Device(0x5C10000000000000ull + i, (uint32_t)(i * 2654435761u + 1), (i * 137) % 1000) };
+        terminal->device.environment.errorRate = errorRate;
+        terminals.push_back(terminal);
+
+        struct epoll_event event = { };
+        event.events    = EPOLLIN;
+        event.data.ptr  = terminal;
+        epoll_ctl(epoll, EPOLL_CTL_ADD, master, &event);
+
+        printf("%s\n", path);
+    }
+    fflush(stdout);
+
+    // drives the measurement refresh and the active mode frames
+    int timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    struct itimerspec tick = { { 0, 10 * 1000000L }, { 0, 10 * 1000000L } };
+    timerfd_settime(timer, 0, &tick, NULL);
+    struct epoll_event timerEvent = { };
+    timerEvent.events   = EPOLLIN;
+    timerEvent.data.ptr = NULL;
+    epoll_ctl(epoll, EPOLL_CTL_ADD, timer, &timerEvent);
+
+    uint8_t in[256];
+    uint8_t out[1024];
+    struct epoll_event events[64];
+
+    while (running)
+    {
+        int n = epoll_wait(epoll, events, 64, 1000);
+        for (int e = 0; e < n; e++)
+        {
+            const uint64_t now = ScioSense_Posix_Termios_Millis();
+
+            if (events[e].data.ptr == NULL)
+            {
+                uint64_t expirations;
+                if (read(timer, &expirations, sizeof(expirations)) < 0) { }
+
+                for (Terminal* terminal : terminals)
+                {
+                    terminal->device.advance(now);
+                    size_t size = terminal->device.pending(out, sizeof(out));
+                    send(terminal->master, out, size);
+                }
+                continue;
+            }
+
+            Terminal* terminal = (Terminal*)events[e].data.ptr;
+            ssize_t size = read(terminal->master, in, sizeof(in));
+            if (size > 0)
+            {
+                terminal->device.advance(now);
+                send(terminal->master, out, terminal->device.receive(in, (size_t)size, out, sizeof(out)));
+            }
+        }
+    }
+
+    for (Terminal* terminal : terminals)
+    {
+        close(terminal->slave);
+        close(terminal->master);
+        delete terminal;
+    }
+    close(timer);
+    close(epoll);
+
+    return 0;
+}
@@ -0,0 +1,449 @@
+#ifndef SCIOSENSE_APC1_SIMULATOR_H
+#define SCIOSENSE_APC1_SIMULATOR_H
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+namespace ScioSense::Apc1Simulator
+{
+    // Small, fast PRNG (xorshift32); good enough for simulated sensor noise
+    class Random
+    {
+    public:
+        explicit Random(uint32_t seed) : state(seed ? seed : 0x9E3779B9u) { }
+
+        inline uint32_t next()
+        {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            return state;
+        }
+
+        inline float uniform()  { return (float)(next() >> 8) * (1.0f / 16777216.0f); }   // [0, 1)
+        inline float noise()    { return uniform() + uniform() + uniform() - 1.5f; }        // approx. normal, sigma 0.5
+
+    private:
+        uint32_t state;
+    };
+
+    // Environment driving the simulated readings. PM, particle counts, gas and T/RH
+    // follow mean reverting random walks with a diurnal cycle and are correlated
+    // like in real indoor air (PM1 < PM2.5 < PM10, eCO2 and RS follow TVOC).
+    class Environment
+    {
+    public:
+        explicit Environment(uint32_t seed) : random(seed)
+        {
+            pm25        = 5.0f  + 10.0f * random.uniform();
+            tvoc        = 50.0f + 100.0f * random.uniform();
+            temperature = 20.0f + 4.0f * random.uniform();
+            humidity    = 35.0f + 20.0f * random.uniform();
+            coarse      = 1.2f  + 0.3f * random.uniform();
+            errorRate   = 0.0f;
+            fault       = APC1_ERROR_CODE_DEFAULT;
+            errorCode   = APC1_ERROR_CODE_DEFAULT;
+        }
+
+        // advances the environment by one second at the given time of day
+        inline void step(const uint64_t timeMs)
+        {
+            const float day     = (float)(timeMs % 86400000ull) / 86400000.0f;
+            const float diurnal = sinf(6.2831853f * (day - 0.3f));
+
+            // occasional events (cooking, cleaning) raise PM and TVOC
+            if (random.uniform() < 0.0005f)
+            {
+                pm25 += 20.0f + 80.0f * random.uniform();
+                tvoc += 100.0f + 400.0f * random.uniform();
+            }
+
+            pm25        += 0.02f * (8.0f + 4.0f * diurnal - pm25)       + 0.6f * random.noise();
+            tvoc        += 0.01f * (90.0f + 30.0f * diurnal - tvoc)     + 3.0f * random.noise();
+            temperature += 0.01f * (21.0f + 2.0f * diurnal - temperature) + 0.02f * random.noise();
+            humidity    += 0.01f * (45.0f - 8.0f * diurnal - humidity)  + 0.1f * random.noise();
+
+            pm25        = (pm25 < 0.0f)         ? 0.0f  : pm25;
+            tvoc        = (tvoc < 0.0f)         ? 0.0f  : tvoc;
+            humidity    = (humidity < 5.0f)     ? 5.0f  : ((humidity > 95.0f) ? 95.0f : humidity);
+
+            errorCode = fault;
+            if (errorRate > 0.0f && random.uniform() < errorRate)
+            {
+                errorCode |= (Apc1_ErrorCode)(1 << (random.next() % APC1_STATS_ERROR_CODE_BITS));
+            }
+        }
+
+        // writes the 64 byte measurement frame including the checksum
+        inline void frame(uint8_t* data, const uint8_t fwVersion)
+        {
+            const float pm1     = pm25 * 0.7f;
+            const float pm10    = pm25 * coarse;
+            // number concentration per 0.1L; roughly 1 µg/m³ PM2.5 ~ 50 particles > 0.3µm
+            const float n03     = pm25 * 55.0f + 30.0f * random.uniform();
+            const float tvocPpb = tvoc;
+            const float eco2    = 400.0f + tvocPpb * 2.0f;
+            const float rs      = 200000.0f / (1.0f + tvocPpb / 100.0f);
+
+            memset(data, 0, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+            data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]        = APC1_COMMAND_ADDRESS_START_BYTE_1;
+            data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]        = APC1_COMMAND_ADDRESS_START_BYTE_2;
+            data[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]      = APC1_COMMAND_RESPONSE_MEASUREMENT_PAYLOAD_LENGTH;
+
+            put16(data, APC1_RESULT_ADDRESS_PM_1_0,             pm1);
+            put16(data, APC1_RESULT_ADDRESS_PM_2_5,             pm25);
+            put16(data, APC1_RESULT_ADDRESS_PM_10,              pm10);
+            put16(data, APC1_RESULT_ADDRESS_PMINAIR_1_0,        pm1  * 0.9f);
+            put16(data, APC1_RESULT_ADDRESS_PMINAIR_2_5,        pm25 * 0.9f);
+            put16(data, APC1_RESULT_ADDRESS_PMINAIR_10,         pm10 * 0.9f);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_0_3,    n03);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_0_5,    n03 * 0.30f);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_1_0,    n03 * 0.06f);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_2_5,    n03 * 0.006f * coarse);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_5_0,    n03 * 0.002f * coarse);
+            put16(data, APC1_RESULT_ADDRESS_NOPARTICLES_10,     n03 * 0.0005f * coarse);
+            put16(data, APC1_RESULT_ADDRESS_TVOC,               tvocPpb);
+            put16(data, APC1_RESULT_ADDRESS_ECO2,               eco2);
+            put16(data, APC1_RESULT_ADDRESS_T_COMP,             temperature * 10.0f);
+            put16(data, APC1_RESULT_ADDRESS_RH_COMP,            humidity * 10.0f);
+            put16(data, APC1_RESULT_ADDRESS_T_RAW,              (temperature + 3.0f) * 10.0f);
+            put16(data, APC1_RESULT_ADDRESS_RH_RAW,             (humidity - 8.0f) * 10.0f);
+            put32(data, APC1_RESULT_ADDRESS_RS0,                rs);
+            put32(data, APC1_RESULT_ADDRESS_RS1,                rs * 1.7f);
+            put32(data, APC1_RESULT_ADDRESS_RS2,                rs * 0.6f);
+            put32(data, APC1_RESULT_ADDRESS_RS3,                rs * 2.3f);
+
+            data[APC1_RESULT_ADDRESS_AQI]               = (tvocPpb < 65) ? AQI_UBA_EXCELLENT : (tvocPpb < 220) ? AQI_UBA_GOOD : (tvocPpb < 660) ? AQI_UBA_MODERATE : (tvocPpb < 2200) ? AQI_UBA_POOR : AQI_UBA_UNHEALTHY;
+            data[APC1_RESULT_ADDRESS_FIRMWARE_VERSION]  = fwVersion;
+            data[APC1_RESULT_ADDRESS_ERROR_CODE]        = errorCode;
+
+            putChecksum(data, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+        }
+
+        static inline void putChecksum(uint8_t* data, const size_t size)
+        {
+            uint16_t checksum = 0;
+            for (size_t i = 0; i < size - 2; i++)
+            {
+                checksum += data[i];
+            }
+            data[size - 2] = (uint8_t)(checksum >> 8);
+            data[size - 1] = (uint8_t)checksum;
+        }
+
+    public:
+        float           errorRate;      // probability per second of an injected Apc1_ErrorCode bit
+        Apc1_ErrorCode  fault;          // bits set in every frame, e.g. of a stalled fan
+        Apc1_ErrorCode  errorCode;
+
+    private:
+        static inline void put16(uint8_t* data, const uint8_t address, const float value)
+        {
+            const uint32_t v = (value <= 0.0f) ? 0 : ((value >= 65535.0f) ? 65535 : (uint32_t)(value + 0.5f));
+            data[address + 0] = (uint8_t)(v >> 8);
+            data[address + 1] = (uint8_t)v;
+        }
+
+        static inline void put32(uint8_t* data, const uint8_t address, const float value)
+        {
+            const uint32_t v = (value <= 0.0f) ? 0 : (uint32_t)value;
+            data[address + 0] = (uint8_t)(v >> 24);
+            data[address + 1] = (uint8_t)(v >> 16);
+            data[address + 2] = (uint8_t)(v >> 8);
+            data[address + 3] = (uint8_t)v;
+        }
+
+    private:
+        Random  random;
+        float   pm25;
+        float   tvoc;
+        float   temperature;
+        float   humidity;
+        float   coarse;
+    };
+
+    // Simulated APC1 speaking the UART protocol: commands in, responses and measurement frames out.
+    // The measurement is refreshed every APC1_SYSTEM_TIMING_STANDARD_MEASURE ms; in active mode,
+    // a frame is sent on each refresh.
+    class Device
+    {
+    public:
+        Device(const uint64_t serialNumber, const uint32_t seed, const uint64_t phaseMs = 0, const uint8_t fwVersion = 34)
+            : environment(seed), serialNumber(serialNumber), fwVersion(fwVersion), phase(phaseMs % APC1_SYSTEM_TIMING_STANDARD_MEASURE)
+        {
+            operatingMode   = APC1_OPERATING_MODE_STANDARD;
+            measurementMode = APC1_MEASUREMENT_MODE_PASSIVE;
+            lastRefresh     = 0;
+            commandLength   = 0;
+            refreshed       = false;
+            environment.frame(frame, fwVersion);
+        }
+
+        // advances the device to nowMs; returns true, if the measurement was refreshed
+        inline bool advance(const uint64_t nowMs)
+        {
+            bool changed = false;
+            while (nowMs >= lastRefresh + APC1_SYSTEM_TIMING_STANDARD_MEASURE)
+            {
+                lastRefresh = (lastRefresh == 0) ? nowMs - ((nowMs - phase) % APC1_SYSTEM_TIMING_STANDARD_MEASURE) : lastRefresh + APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+                if (operatingMode == APC1_OPERATING_MODE_STANDARD)
+                {
+                    environment.step(lastRefresh);
+                    environment.frame(frame, fwVersion);
+                    changed = true;
+                }
+            }
+            refreshed = refreshed || changed;
+            return changed;
+        }
+
+        // feeds bytes sent by the host; writes the response bytes to out and returns their count
+        inline size_t receive(const uint8_t* data, const size_t size, uint8_t* out, const size_t capacity)
+        {
+            size_t written = 0;
+
+            for (size_t i = 0; i < size; i++)
+            {
+                // resynchronize on the start bytes
+                if ((commandLength == 0 && data[i] != APC1_COMMAND_ADDRESS_START_BYTE_1) || (commandLength == 1 && data[i] != APC1_COMMAND_ADDRESS_START_BYTE_2))
+                {
+                    commandLength = (data[i] == APC1_COMMAND_ADDRESS_START_BYTE_1) ? 1 : 0;
+                    command[0]    = data[i];
+                    continue;
+                }
+
+                command[commandLength++] = data[i];
+                if (commandLength == APC1_COMMAND_LENGTH)
+                {
+                    commandLength = 0;
+                    written += execute(out + written, capacity - written);
+                }
+            }
+
+            return written;
+        }
+
+        // writes the pending active mode frame to out; returns its size or 0
+        inline size_t pending(uint8_t* out, const size_t capacity)
+        {
+            if (!refreshed || measurementMode != APC1_MEASUREMENT_MODE_ACTIVE || operatingMode != APC1_OPERATING_MODE_STANDARD || capacity < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH)
+            {
+                return 0;
+            }
+
+            refreshed = false;
+            memcpy(out, frame, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+            return APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH;
+        }
+
+        inline const uint8_t* measurementData() const { return frame; }
+        inline Apc1_OperatingMode mode() const { return operatingMode; }
+
+    public:
+        Environment environment;
+
+    private:
+        inline size_t execute(uint8_t* out, const size_t capacity)
+        {
+            uint16_t checksum = 0;
+            for (uint8_t i = 0; i < APC1_COMMAND_LENGTH - 2; i++)
+            {
+                checksum += command[i];
+            }
+            if (((uint16_t)command[5] << 8 | command[6]) != checksum)
+            {
+                return 0;
+            }
+
+            const uint8_t data = command[4];
+            switch (command[2])
+            {
+                case APC1_COMMAND_ADDRESS_REQUEST_MEASUREMENT:
+                    if (operatingMode != APC1_OPERATING_MODE_STANDARD || capacity < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH)
+                    {
+                        return 0;
+                    }
+                    memcpy(out, frame, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+                    return APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH;
+
+                case APC1_COMMAND_ADDRESS_MEASUREMENT_MODE:
+                    measurementMode = data ? APC1_MEASUREMENT_MODE_ACTIVE : APC1_MEASUREMENT_MODE_PASSIVE;
+                    return respond(out, capacity);
+
+                case APC1_COMMAND_ADDRESS_OPERATION_MODE:
+                    if (data == 0x00)
+                    {
+                        operatingMode = APC1_OPERATING_MODE_IDLE;
+                        return respond(out, capacity);
+                    }
+                    if (data == 0x0F)
+                    {
+                        measurementMode = APC1_MEASUREMENT_MODE_PASSIVE;
+                    }
+                    operatingMode = APC1_OPERATING_MODE_STANDARD;
+                    return 0;
+
+                case APC1_COMMAND_ADDRESS_READSENSOR_VERSION:
+                    return version(out, capacity);
+
+                default:
+                    return 0;
+            }
+        }
+
+        // default response, as accepted by Apc1_CheckCommandResponse
+        inline size_t respond(uint8_t* out, const size_t capacity)
+        {
+            if (capacity < APC1_COMMAND_RESPONSE_DEFAULT_LENGTH)
+            {
+                return 0;
+            }
+
+            memset(out, 0, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH);
+            out[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]     = APC1_COMMAND_ADDRESS_START_BYTE_1;
+            out[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]     = APC1_COMMAND_ADDRESS_START_BYTE_2;
+            out[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]   = APC1_COMMAND_RESPONSE_DEFAULT_LENGTH;
+            out[APC1_COMMAND_RESPONSE_COMMAND_ADDRESS]          = command[APC1_COMMAND_RESPONSE_COMMAND_ADDRESS];
+            out[APC1_COMMAND_RESPONSE_DATA_ADDRESS]             = command[APC1_COMMAND_RESPONSE_DATA_ADDRESS];
+            Environment::putChecksum(out, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH);
+
+            return APC1_COMMAND_RESPONSE_DEFAULT_LENGTH;
+        }
+
+        inline size_t version(uint8_t* out, const size_t capacity)
+        {
+            static const char moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH] = { 'A', 'P', 'C', '1', '-', 'S' };
+
+            if (capacity < APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH)
+            {
+                return 0;
+            }
+
+            memset(out, 0, APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH);
+            out[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]     = APC1_COMMAND_ADDRESS_START_BYTE_1;
+            out[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]     = APC1_COMMAND_ADDRESS_START_BYTE_2;
+            out[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]   = APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH - 4;
+            memcpy(out + APC1_RESULT_ADDRESS_SENSOR_TYPE, moduleName, APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH);
+            for (uint8_t i = 0; i < 8; i++)
+            {
+                out[APC1_RESULT_ADDRESS_SENSOR_UID + i] = (uint8_t)(serialNumber >> ((7 - i) * 8));
+            }
+            out[APC1_RESULT_ADDRESS_SENSOR_FIRMWARE_VERSION + 0] = 0;
+            out[APC1_RESULT_ADDRESS_SENSOR_FIRMWARE_VERSION + 1] = fwVersion;
+            Environment::putChecksum(out, APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH);
+
+            return APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH;
+        }
+
+    private:
+        uint64_t                serialNumber;
+        uint8_t                 fwVersion;
+        uint64_t                phase;
+        uint64_t                lastRefresh;
+        bool                    refreshed;
+        Apc1_OperatingMode      operatingMode;
+        Apc1_MeasurementMode    measurementMode;
+        uint8_t                 command[APC1_COMMAND_LENGTH];
+        uint8_t                 commandLength;
+        uint8_t                 frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    };
+
+    // In-memory UART between the driver and a Device, for running the real Apc1_* code paths
+    // without a serial port. Responses are available as soon as the command is written; a read of
+    // more bytes than are pending fails like a timeout. Optional line noise flips single bits.
+    class Link
+    {
+    public:
+        Link(const uint64_t serialNumber, const uint32_t seed, const uint64_t phaseMs = 0)
+            : device(serialNumber, seed, phaseMs), bitErrorRate(0.0f), random(seed ^ 0x5A5A5A5Au), head(0), tail(0) { }
+
+        // sets read, write, clear and config of io; wait and millis are left to the caller
+        inline void attach(ScioSense_Apc1_IO* io)
+        {
+            io->read        = Link::read;
+            io->write       = Link::write;
+            io->clear       = Link::clear;
+            io->protocol    = APC1_PROTOCOL_UART;
+            io->config      = this;
+        }
+
+        // advances the device to nowMs and queues its active mode frame, if any
+        inline void advance(const uint64_t nowMs)
+        {
+            device.advance(nowMs);
+            compact();
+            deliver(device.pending(rx + tail, sizeof(rx) - tail));
+        }
+
+        inline size_t available() const { return tail - head; }
+
+        static Result read(void* config, const uint16_t address, uint8_t* data, const size_t size)
+        {
+            Link* link = (Link*)config;
+            if (link->available() < size)
+            {
+                link->head = link->tail;
+                return RESULT_IO_ERROR;
+            }
+
+            memcpy(data, link->rx + link->head, size);
+            link->head += size;
+            return RESULT_OK;
+        }
+
+        static Result write(void* config, const uint16_t address, uint8_t* data, const size_t size)
+        {
+            Link* link = (Link*)config;
+            link->compact();
+            link->deliver(link->device.receive(data, size, link->rx + link->tail, sizeof(link->rx) - link->tail));
+            return RESULT_OK;
+        }
+
+        static Result clear(void* config)
+        {
+            Link* link = (Link*)config;
+            link->head = link->tail = 0;
+            return RESULT_OK;
+        }
+
+    public:
+        Device  device;
+        float   bitErrorRate;   // probability per delivered byte of one flipped bit
+
+    private:
+        inline void compact()
+        {
+            if (head == tail)
+            {
+                head = tail = 0;
+            }
+            else if (tail > sizeof(rx) / 2)
+            {
+                memmove(rx, rx + head, tail - head);
+                tail -= head;
+                head  = 0;
+            }
+        }
+
+        inline void deliver(const size_t size)
+        {
+            if (bitErrorRate > 0.0f && random.uniform() < bitErrorRate * (float)size)
+            {
+                rx[tail + random.next() % size] ^= (uint8_t)(1 << (random.next() % 8));
+            }
+            tail += size;
+        }
+
+    private:
+        Random  random;
+        size_t  head;
+        size_t  tail;
+        uint8_t rx[4 * APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    };
+}
+
+#endif //SCIOSENSE_APC1_SIMULATOR_H
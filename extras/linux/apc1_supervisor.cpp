@@ -0,0 +1,258 @@
+// Runs Apc1_Supervisor against a simulated APC1 over the in-memory UART, polled once per second
+// of simulated time, through a schedule of disturbances:
+//
+//      storm       every frame has a flipped bit, so every update fails with a checksum error
+//      unplugged   the device neither receives commands nor sends bytes
+//      fan fault   every frame has APC1_ERROR_CODE_FAN_SPEED_TOO_LOW set
+//      busy        unplugged for the first half; then the bus is held by another master and the
+//                  transport refuses every read with RESULT_NOT_ALLOWED, so trials give no verdict
+//
+// For each disturbance it reports how long the supervisor took to leave HEALTHY, the recovery
+// actions it ran, the reads and writes it cost and how long after the end of the disturbance the
+// first valid frame was accepted again. Updates refused by the open circuit breaker must not do
+// any IO, and each trial must be followed by another cooldown; the tool fails otherwise.
+//
+//   g++ -std=c++17 -O2 -Wall -I../../src -o apc1_supervisor apc1_supervisor.cpp
+//   ./apc1_supervisor [--storm s] [--unplugged s] [--fault s] [--busy s] [--seed n] [--trace]
+//
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "apc1_simulator.h"
+#include "lib/apc1/ScioSense_Apc1_Supervisor.h"
+
+using ScioSense::Apc1Simulator::Link;
+
+enum Kind { STORM, UNPLUGGED, FAULT, BUSY, KINDS };
+
+static const char* const names[KINDS] = { "storm", "unplugged", "fan fault", "busy" };
+
+struct Options
+{
+    uint32_t    duration[KINDS] = { 60, 2600, 300, 1200 };  // s
+    uint32_t    seed            = 7;
+    bool        trace           = false;
+};
+
+struct Disturbance
+{
+    Kind        kind;
+    uint32_t    start;                                  // s
+    uint32_t    end;
+    int64_t     detected        = -1;                   // s after start at which the supervisor left HEALTHY
+    int64_t     recovered       = -1;                   // s after end of the first valid frame
+    uint32_t    io              = 0;                    // reads and writes from start to recovered
+    uint32_t    opens           = 0;
+    uint32_t    trials          = 0;                    // resets by the open breaker
+    uint32_t    skipped         = 0;
+    uint32_t    actions[APC1_RECOVERY_ACTIONS] = { };
+};
+
+static Link*    link_;
+static uint64_t now;
+static bool     unplugged;
+static bool     busy;
+static uint32_t io;
+
+static uint32_t millis()
+{
+    return (uint32_t)now;
+}
+
+static void wait(const uint32_t ms)
+{
+    now += ms;
+    link_->advance(now);
+}
+
+static Result read(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    io++;
+    if (unplugged)
+    {
+        Link::clear(config);
+        return RESULT_IO_ERROR;
+    }
+    if (busy)
+    {
+        return RESULT_NOT_ALLOWED;
+    }
+    return Link::read(config, address, data, size);
+}
+
+static Result write(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    io++;
+    return unplugged ? RESULT_OK : Link::write(config, address, data, size);
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if      (!strcmp(argv[i], "--storm")        && i + 1 < argc)    { options.duration[STORM]       = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--unplugged")    && i + 1 < argc)    { options.duration[UNPLUGGED]   = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--fault")        && i + 1 < argc)    { options.duration[FAULT]       = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--busy")         && i + 1 < argc)    { options.duration[BUSY]        = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--seed")         && i + 1 < argc)    { options.seed                  = strtoul(argv[++i], NULL, 10); }
+        else if (!strcmp(argv[i], "--trace"))                           { options.trace                 = true; }
+        else
+        {
+            fprintf(stderr, "usage: %s [--storm s] [--unplugged s] [--fault s] [--busy s] [--seed n] [--trace]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    // each disturbance is followed by enough time for the longest cooldown
+    Disturbance disturbances[KINDS];
+    uint32_t t = 100;
+    for (int k = 0; k < KINDS; k++)
+    {
+        disturbances[k].kind    = (Kind)k;
+        disturbances[k].start   = t;
+        disturbances[k].end     = t + options.duration[k];
+        t                       = disturbances[k].end + 3600 + 300;
+    }
+    const uint32_t seconds = t;
+
+    Link link(1, options.seed, 123);
+    ScioSense_Apc1 apc1;
+
+    memset(&apc1, 0, sizeof(apc1));
+    link.attach(&apc1.io);
+    apc1.io.read            = read;
+    apc1.io.write           = write;
+    apc1.io.wait            = wait;
+    apc1.io.millis          = millis;
+    apc1.operatingMode      = APC1_OPERATING_MODE_STANDARD;
+    apc1.measurementMode    = APC1_MEASUREMENT_MODE_PASSIVE;
+
+    link_   = &link;
+    now     = 1735689600000ull;
+    link.advance(now);
+
+    if (Apc1_Reset(&apc1) != RESULT_OK)
+    {
+        fprintf(stderr, "reset failed\n");
+        return 1;
+    }
+
+    Apc1_SupervisorConfig config;
+    Apc1_Supervisor supervisor;
+    Apc1_Supervisor_DefaultConfig(&config);
+    Apc1_Supervisor_Init(&supervisor, &config);
+
+    const uint64_t start    = now;
+    Disturbance* current    = NULL;
+    uint32_t refusedIo      = 0;
+    uint32_t trialsWithoutCooldown = 0;
+    uint32_t updates        = 0;
+    uint32_t valid          = 0;
+    Apc1_SupervisorState state = supervisor.state;
+
+    for (uint32_t second = 0; second < seconds; second++)
+    {
+        // the recovery actions wait, so the clock runs ahead of the poll schedule now and then
+        if (now < start + second * 1000ull)
+        {
+            now = start + second * 1000ull;
+            link.advance(now);
+        }
+
+        for (Disturbance& disturbance : disturbances)
+        {
+            if (second == disturbance.start)
+            {
+                current = &disturbance;
+            }
+        }
+
+        const bool active               = current != NULL && second >= current->start && second < current->end;
+        const bool firstHalf            = active && second < current->start + (current->end - current->start) / 2;
+        unplugged                       = active && (current->kind == UNPLUGGED || (current->kind == BUSY && firstHalf));
+        busy                            = active && current->kind == BUSY && !firstHalf;
+        link.bitErrorRate               = (active && current->kind == STORM) ? 1.0f : 0.0f;
+        link.device.environment.fault   = (active && current->kind == FAULT) ? APC1_ERROR_CODE_FAN_SPEED_TOO_LOW : APC1_ERROR_CODE_DEFAULT;
+
+        const Apc1_SupervisorState before   = supervisor.state;
+        const uint32_t opens                = supervisor.breakerOpens;
+        const uint32_t skipped              = supervisor.skippedUpdates;
+        const uint32_t resets               = supervisor.recoveries[APC1_RECOVERY_RESET];
+        const uint32_t io0                  = io;
+        uint32_t recoveries[APC1_RECOVERY_ACTIONS];
+        memcpy(recoveries, supervisor.recoveries, sizeof(recoveries));
+
+        const Result result = Apc1_Supervisor_Update(&supervisor, &apc1, millis());
+        updates++;
+
+        const bool accepted = result == RESULT_OK && (apc1.measurementData[APC1_RESULT_ADDRESS_ERROR_CODE] & config.faultMask) == 0;
+        valid += accepted ? 1 : 0;
+        if (supervisor.skippedUpdates != skipped)
+        {
+            refusedIo += io - io0;
+        }
+        const uint32_t trials = (before == APC1_SUPERVISOR_STATE_OPEN) ? supervisor.recoveries[APC1_RECOVERY_RESET] - resets : 0;
+        trialsWithoutCooldown += (trials > 0 && supervisor.state == APC1_SUPERVISOR_STATE_OPEN && supervisor.breakerOpens == opens) ? 1 : 0;
+
+        if (current != NULL && current->recovered < 0)
+        {
+            current->io        += io - io0;
+            current->opens     += supervisor.breakerOpens - opens;
+            current->trials    += trials;
+            current->skipped   += supervisor.skippedUpdates - skipped;
+            for (int a = 0; a < APC1_RECOVERY_ACTIONS; a++)
+            {
+                current->actions[a] += supervisor.recoveries[a] - recoveries[a];
+            }
+            if (current->detected < 0 && supervisor.state != APC1_SUPERVISOR_STATE_HEALTHY)
+            {
+                current->detected = second - current->start;
+            }
+            if (second >= current->end && accepted)
+            {
+                current->recovered = second - current->end;
+            }
+        }
+
+        if (options.trace && supervisor.state != state)
+        {
+            printf("%6u s  state %u, next action %u\n", second, supervisor.state, supervisor.nextAction);
+        }
+        state = supervisor.state;
+    }
+
+    printf("%-11s %8s %9s %6s %6s %6s %6s %6s %6s %6s %6s %8s %10s\n", "disturbance", "length s", "detected", "clear", "resync",
+        "modes", "reset", "power", "opens", "trials", "io", "skipped", "recovered");
+    for (const Disturbance& d : disturbances)
+    {
+        printf("%-11s %8u %9lld %6u %6u %6u %6u %6u %6u %6u %6u %8u %10lld\n", names[d.kind], d.end - d.start, (long long)d.detected,
+            d.actions[APC1_RECOVERY_CLEAR], d.actions[APC1_RECOVERY_RESYNC], d.actions[APC1_RECOVERY_MODES], d.actions[APC1_RECOVERY_RESET],
+            d.actions[APC1_RECOVERY_POWER_CYCLE], d.opens, d.trials, d.io, d.skipped, (long long)d.recovered);
+    }
+    printf("\n%u updates, %u valid frames, %u breaker opens, %u updates skipped, %u reads and writes in skipped updates\n",
+        updates, valid, supervisor.breakerOpens, supervisor.skippedUpdates, refusedIo);
+
+    if (refusedIo > 0)
+    {
+        printf("error: updates refused by the open breaker did IO\n");
+        return 1;
+    }
+    if (trialsWithoutCooldown > 0)
+    {
+        printf("error: %u trials left the breaker open without another cooldown\n", trialsWithoutCooldown);
+        return 1;
+    }
+    for (const Disturbance& d : disturbances)
+    {
+        if (d.recovered < 0)
+        {
+            printf("error: no valid frame after the %s\n", names[d.kind]);
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,643 @@
+// Cycle counts, stack high-water and footprint of the public API on the microcontrollers the
+// library is deployed on, run in a local emulator. The driver is built bare metal against a mock
+// transport which replays one valid measurement frame; the APC1 wrapper uses the Arduino stubs in
+// ./mock and a mock Stream.
+//
+// Each API is called RUNS times. The cycles between two reads of the counter, minus the cost of
+// an empty call, are reported as min and max; the stack is the deepest byte written below the
+// caller, found by painting the free stack before each call. Every API prints one JSON line:
+//
+//      {"target":"avr","counter":"cycles","api":"Apc1_Update","runs":8,"min":...,"max":...,"stack":...}
+//
+// Build with -DAPC1_BENCH_SELECT=n to keep API n only (0: the harness alone); run.sh does so to
+// add the flash and static RAM each API brings in, and runs the emulator:
+//
+//   ./run.sh avr            ATmega2560 in simavr; Timer1 counts CPU cycles
+//   ./run.sh cortex-m3      lm3s6965evb in QEMU; SysTick counts CPU cycles on hardware, while
+//                           QEMU with -icount shift=0 advances it per instruction
+//   ./run.sh host           a native build for checking the harness; the counter is ns
+//
+// The timer overflow interrupt of the AVR adds about 30 cycles per 65536, and its frame to the
+// stack of APIs running that long.
+//
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(__AVR__)
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <avr/sleep.h>
+#elif defined(__arm__) && !defined(__linux__)
+#define APC1_BENCH_CORTEX_M
+#else
+#include <stdio.h>
+#include <time.h>
+#endif
+
+#define APC1_WITH_CALIBRATION
+#define APC1_WITH_AQI
+#define APC1_WITH_BASELINE
+#include "apc1.h"
+
+#ifndef APC1_BENCH_SELECT
+#define APC1_BENCH_SELECT   (-1)        // all APIs
+#endif
+
+#define RUNS                (8)
+#define STACK_PATTERN       (0xA5)
+
+//// target: counter, stack pointer, output, stop
+
+#if defined(__AVR__)
+
+#define TARGET              "avr"
+#define COUNTER             "cycles"
+#define STACK_PAINT         (2048)
+
+extern uint8_t __heap_start;
+static volatile uint16_t timerOverflows;
+
+ISR(TIMER1_OVF_vect)
+{
+    timerOverflows++;
+}
+
+static void targetInit()
+{
+    UBRR0   = F_CPU / 16 / 115200 - 1;
+    UCSR0B  = _BV(TXEN0);
+    TCCR1A  = 0;
+    TCCR1B  = _BV(CS10);                // no prescaler: one count per cycle
+    TIMSK1  = _BV(TOIE1);
+    sei();
+}
+
+static inline uint32_t counter()
+{
+    const uint8_t sreg  = SREG;
+    cli();
+    const uint16_t low  = TCNT1;
+    uint16_t high       = timerOverflows;
+    if ((TIFR1 & _BV(TOV1)) && low < 0x8000)
+    {
+        high++;                         // overflowed after cli, the interrupt is pending
+    }
+    SREG = sreg;
+
+    return ((uint32_t)high << 16) | low;
+}
+
+static inline uint8_t* stackPointer()
+{
+    return (uint8_t*)SP;
+}
+
+static inline uint8_t* stackLimit()
+{
+    return &__heap_start;
+}
+
+static void putChar(const char c)
+{
+    while (!(UCSR0A & _BV(UDRE0)))
+    {
+    }
+    UDR0 = c;
+}
+
+static void stop()
+{
+    while (!(UCSR0A & _BV(TXC0)))
+    {
+    }
+    // simavr ends the simulation on sleep with interrupts disabled
+    cli();
+    sleep_enable();
+    sleep_cpu();
+}
+
+// avr-libc has neither operator delete, which the virtual destructor of the wrapper refers to, nor
+// __cxa_pure_virtual for the abstract mock streams; nothing is allocated
+void operator delete(void*)         { }
+void operator delete(void*, size_t) { }
+extern "C" void __cxa_pure_virtual() { for (;;) { } }
+
+#elif defined(APC1_BENCH_CORTEX_M)
+
+#define TARGET              "cortex-m3"
+#define COUNTER             "systick"
+#define STACK_PAINT         (4096)
+
+#define SYST_CSR            (*(volatile uint32_t*)0xE000E010)
+#define SYST_RVR            (*(volatile uint32_t*)0xE000E014)
+#define SYST_CVR            (*(volatile uint32_t*)0xE000E018)
+#define UART0_DR            (*(volatile uint32_t*)0x4000C000)
+#define UART0_FR            (*(volatile uint32_t*)0x4000C018)
+
+extern uint32_t _sidata, _sdata, _edata, _sbss, _ebss, _estack;
+extern void (*__init_array_start[])();
+extern void (*__init_array_end[])();
+int main();
+
+extern "C" void Reset_Handler()
+{
+    uint32_t* source = &_sidata;
+    for (uint32_t* destination = &_sdata; destination < &_edata; )
+    {
+        *destination++ = *source++;
+    }
+    for (uint32_t* destination = &_sbss; destination < &_ebss; )
+    {
+        *destination++ = 0;
+    }
+    for (void (**constructor)() = __init_array_start; constructor < __init_array_end; constructor++)
+    {
+        (*constructor)();
+    }
+
+    main();
+}
+
+extern "C" void Default_Handler()
+{
+    for (;;)
+    {
+    }
+}
+
+__attribute__((section(".isr_vector"), used)) static void (* const vectors[16])() =
+{
+    (void (*)())&_estack, Reset_Handler, Default_Handler, Default_Handler,
+    Default_Handler, Default_Handler, Default_Handler, 0, 0, 0, 0,
+    Default_Handler, Default_Handler, 0, Default_Handler, Default_Handler
+};
+
+static void targetInit()
+{
+    SYST_RVR = 0x00FFFFFF;
+    SYST_CVR = 0;
+    SYST_CSR = 0x5;                     // processor clock, no interrupt, enabled
+}
+
+// SysTick counts down and wraps at 24 bits; the APIs take far fewer cycles
+static inline uint32_t counter()
+{
+    return (0x00FFFFFF - SYST_CVR) & 0x00FFFFFF;
+}
+
+static inline uint8_t* stackPointer()
+{
+    uint8_t* sp;
+    __asm volatile ("mov %0, sp" : "=r"(sp));
+    return sp;
+}
+
+static inline uint8_t* stackLimit()
+{
+    return (uint8_t*)&_ebss;
+}
+
+static void putChar(const char c)
+{
+    while (UART0_FR & (1 << 5))         // TX FIFO full
+    {
+    }
+    UART0_DR = (uint32_t)c;
+}
+
+static void stop()
+{
+    // semihosting SYS_EXIT, ADP_Stopped_ApplicationExit
+    register uint32_t operation __asm("r0") = 0x18;
+    register uint32_t argument  __asm("r1") = 0x20026;
+    __asm volatile ("bkpt 0xAB" : : "r"(operation), "r"(argument));
+    for (;;)
+    {
+    }
+}
+
+// the wrapper's virtual destructor refers to the deleting destructor, and the abstract mock
+// streams to __cxa_pure_virtual; nothing is allocated
+void operator delete(void*)         { }
+void operator delete(void*, size_t) { }
+extern "C" void __cxa_pure_virtual() { Default_Handler(); }
+
+#else
+
+#define TARGET              "host"
+#define COUNTER             "ns"
+#define STACK_PAINT         (16384)
+
+static void targetInit()
+{
+}
+
+static inline uint32_t counter()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint32_t)((uint64_t)now.tv_sec * 1000000000u + now.tv_nsec);
+}
+
+__attribute__((noinline)) static uint8_t* stackPointer()
+{
+    // the frame of this function is just below the caller and free after the return; the depth
+    // on the host is approximate, as clock_gettime runs on the painted stack as well
+    return (uint8_t*)__builtin_frame_address(0);
+}
+
+static inline uint8_t* stackLimit()
+{
+    return NULL;
+}
+
+static void putChar(const char c)
+{
+    putchar(c);
+}
+
+static void stop()
+{
+    fflush(stdout);
+}
+
+#endif
+
+static void put(const char* text)
+{
+    while (*text != 0)
+    {
+        putChar(*text++);
+    }
+}
+
+static void putNumber(uint32_t value)
+{
+    char digits[10];
+    uint8_t count = 0;
+
+    do
+    {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    }
+    while (value > 0);
+
+    while (count > 0)
+    {
+        putChar(digits[--count]);
+    }
+}
+
+//// simulated clock, mock transport and frame
+
+static uint32_t now;                    // ms
+
+unsigned long millis()
+{
+    return now;
+}
+
+void delay(unsigned long ms)
+{
+    now += ms;
+}
+
+static uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+static uint8_t position;                // next byte of frame to be read
+
+static void prepareFrame()
+{
+    static const uint16_t values[][2] =
+    {
+        { APC1_RESULT_ADDRESS_PM_1_0,           84 },
+        { APC1_RESULT_ADDRESS_PM_2_5,           120 },
+        { APC1_RESULT_ADDRESS_PM_10,            165 },
+        { APC1_RESULT_ADDRESS_PMINAIR_1_0,      76 },
+        { APC1_RESULT_ADDRESS_PMINAIR_2_5,      108 },
+        { APC1_RESULT_ADDRESS_PMINAIR_10,       149 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_0_3,  6630 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_0_5,  1989 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_1_0,  398 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_2_5,  55 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_5_0,  18 },
+        { APC1_RESULT_ADDRESS_NOPARTICLES_10,   4 },
+        { APC1_RESULT_ADDRESS_TVOC,             150 },
+        { APC1_RESULT_ADDRESS_ECO2,             700 },
+        { APC1_RESULT_ADDRESS_T_COMP,           231 },
+        { APC1_RESULT_ADDRESS_RH_COMP,          456 },
+        { APC1_RESULT_ADDRESS_T_RAW,            263 },
+        { APC1_RESULT_ADDRESS_RH_RAW,           389 },
+    };
+    uint16_t checksum = 0;
+
+    frame[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]   = APC1_COMMAND_ADDRESS_START_BYTE_1;
+    frame[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]   = APC1_COMMAND_ADDRESS_START_BYTE_2;
+    frame[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L] = APC1_COMMAND_RESPONSE_MEASUREMENT_PAYLOAD_LENGTH;
+    for (uint8_t i = 0; i < sizeof(values) / sizeof(values[0]); i++)
+    {
+        frame[values[i][0]]     = (uint8_t)(values[i][1] >> 8);
+        frame[values[i][0] + 1] = (uint8_t)values[i][1];
+    }
+    Apc1_SetFieldValue(frame, APC1_FIELD_RS0, 120000);
+    Apc1_SetFieldValue(frame, APC1_FIELD_RS1, 95000);
+    Apc1_SetFieldValue(frame, APC1_FIELD_RS2, 143000);
+    Apc1_SetFieldValue(frame, APC1_FIELD_RS3, 88000);
+    frame[APC1_RESULT_ADDRESS_AQI]              = 2;
+    frame[APC1_RESULT_ADDRESS_FIRMWARE_VERSION] = 0x25;
+
+    for (uint8_t i = 0; i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH - 2; i++)
+    {
+        checksum += frame[i];
+    }
+    frame[APC1_RESULT_ADDRESS_CHECKSUM_H] = (uint8_t)(checksum >> 8);
+    frame[APC1_RESULT_ADDRESS_CHECKSUM_H + 1] = (uint8_t)checksum;
+}
+
+static uint8_t nextByte()
+{
+    const uint8_t byte = frame[position];
+    position = (position + 1 < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH) ? position + 1 : 0;
+    return byte;
+}
+
+static Result mockRead(void*, const uint16_t, uint8_t* data, const size_t size)
+{
+    for (size_t i = 0; i < size; i++)
+    {
+        data[i] = nextByte();
+    }
+    return RESULT_OK;
+}
+
+static Result mockWrite(void*, const uint16_t, uint8_t*, const size_t)
+{
+    return RESULT_OK;
+}
+
+static Result mockClear(void*)
+{
+    position = 0;
+    return RESULT_OK;
+}
+
+static void mockWait(const uint32_t ms)
+{
+    now += ms;
+}
+
+static uint32_t mockMillis()
+{
+    return now;
+}
+
+// the frame, byte by byte through the virtual Stream interface, as from a HardwareSerial
+class MockStream : public Stream
+{
+public:
+    int     available() override                    { return APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH - position; }
+    int     read() override                         { return nextByte(); }
+    size_t  write(uint8_t) override                 { return 1; }
+    size_t  write(const uint8_t*, size_t size) override { return size; }
+};
+
+//// fixtures: set up before the runs, not measured
+
+static ScioSense_Apc1   core;
+static Apc1_Calibrator  calibrator;
+static Apc1_CorrectedPM corrected;
+static Apc1_AqiEngine   aqi;
+static Apc1_Baseline    baseline;
+static uint32_t         timestamp;      // s, for the streaming stages
+static volatile float   floatSink;
+static volatile uint16_t integerSink;
+static volatile Result  resultSink;
+
+static APC1& wrapper()
+{
+    // constructed on first use, so builds without the wrapper APIs do not contain it
+    static MockStream stream;
+    static APC1 sensor;
+    static bool started = false;
+
+    if (!started)
+    {
+        sensor.begin(&stream);
+        started = true;
+    }
+    return sensor;
+}
+
+static void prepareNothing()
+{
+}
+
+static void prepareCore()
+{
+    core                    = ScioSense_Apc1();
+    core.io.read            = mockRead;
+    core.io.write           = mockWrite;
+    core.io.clear           = mockClear;
+    core.io.wait            = mockWait;
+    core.io.millis          = mockMillis;
+    core.io.protocol        = APC1_PROTOCOL_UART;
+    core.operatingMode      = APC1_OPERATING_MODE_STANDARD;
+    core.measurementMode    = APC1_MEASUREMENT_MODE_PASSIVE;
+    core.updateOptions      = APC1_UPDATE_OPTION_NONE;
+#ifndef APC1_NO_PHASE
+    Apc1_ResetPhase(&core);
+#endif
+    Apc1_ResetStats(&core);
+    position = 0;
+}
+
+// the getters only need the data; without Apc1_Update, which would add to their footprint
+static void prepareCoreData()
+{
+    memcpy(core.measurementData, frame, sizeof(frame));
+}
+
+static void prepareWrapper()
+{
+    wrapper();
+    position = 0;
+}
+
+static void prepareWrapperData()
+{
+    memcpy(wrapper().measurementData, frame, sizeof(frame));
+}
+
+static void prepareCalibration()
+{
+    // two segments for PM2.5, one for the other sizes
+    static Apc1_CalibrationTable table;
+
+    table.segmentCount[0]       = 1;
+    table.segmentCount[1]       = 2;
+    table.segmentCount[2]       = 1;
+    table.kappa                 = 300;
+    table.rhLimit               = 950;
+    table.segments[0][0].gain   = 3700;
+    table.segments[0][0].offset = 5;
+    table.segments[1][0].gain   = 3900;
+    table.segments[1][1].from   = 50;
+    table.segments[1][1].gain   = 3500;
+    table.segments[1][1].offset = 40;
+    table.segments[2][0].gain   = 4300;
+    Apc1_Calibration_Init(&calibrator, &table, APC1_CALIBRATION_METHOD_FIXED);
+}
+
+static void prepareAqi()
+{
+    Apc1_AqiConfig config;
+    Apc1_Aqi_DefaultConfig(&config);
+    Apc1_Aqi_Init(&aqi, &config);
+    timestamp = 1700000000u;
+}
+
+static void prepareBaseline()
+{
+    Apc1_BaselineConfig config;
+    Apc1_Baseline_DefaultConfig(&config);
+    Apc1_Baseline_Init(&baseline, &config, NULL);
+    timestamp = 1700000000u;
+    Apc1_Baseline_Add(&baseline, timestamp, frame);
+}
+
+//// the measured calls; noinline, so each is one call between the counter reads
+
+#define BENCH(name) __attribute__((noinline)) static void name()
+
+BENCH(benchNothing)                     { }
+BENCH(benchApc1Update)                  { now += 1000; resultSink = Apc1_Update(&core); }
+BENCH(benchApc1CheckData)               { resultSink = Apc1_CheckData(frame, (Apc1_CommandResponse)APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH); }
+BENCH(benchApc1CheckMeasurementData)    { resultSink = Apc1_CheckMeasurementData(frame); }
+BENCH(benchApc1GetPM_2_5)               { integerSink = Apc1_GetPM_2_5(&core); }
+BENCH(benchApc1GetCompT)                { floatSink = Apc1_GetCompT(&core); }
+BENCH(benchApc1GetCompRH)               { floatSink = Apc1_GetCompRH(&core); }
+BENCH(benchApc1GetRawT)                 { floatSink = Apc1_GetRawT(&core); }
+BENCH(benchApc1GetRawRH)                { floatSink = Apc1_GetRawRH(&core); }
+BENCH(benchWrapperUpdate)              { now += 1000; resultSink = wrapper().update(); }
+BENCH(benchWrapperGetPM_2_5)           { integerSink = wrapper().getPM_2_5(); }
+BENCH(benchWrapperGetCompT)            { floatSink = wrapper().getCompT(); }
+BENCH(benchWrapperInvoke)               { resultSink = wrapper().invoke<ScioSense::Apc1Command::PassiveMeasurement>(); }
+// the mock Stream replays the measurement frame, so the response check runs to its end and rejects it
+BENCH(benchWrapperInvokeResponse)
+{
+    uint8_t response[ScioSense::Apc1Command::Response<ScioSense::Apc1Command::SetMeasurementModePassive>::length];
+    resultSink = wrapper().invoke<ScioSense::Apc1Command::SetMeasurementModePassive>(response);
+}
+BENCH(benchCalibrationApply)            { Apc1_Calibration_Apply(&calibrator, frame, &corrected); }
+BENCH(benchAqiAdd)                      { resultSink = Apc1_Aqi_Add(&aqi, timestamp, frame); timestamp += 60; }
+BENCH(benchBaselineAdd)                 { resultSink = Apc1_Baseline_Add(&baseline, ++timestamp, frame); }
+
+#undef BENCH
+
+// index (the APC1_BENCH_SELECT value), name, fixture, call
+#define APC1_BENCHES(X) \
+    X(0,    "harness",                      prepareNothing,     benchNothing)                           \
+    X(1,    "Apc1_Update",                  prepareCore,        benchApc1Update)                        \
+    X(2,    "Apc1_CheckData",               prepareNothing,     benchApc1CheckData)                     \
+    X(3,    "Apc1_CheckMeasurementData",    prepareNothing,     benchApc1CheckMeasurementData)          \
+    X(4,    "Apc1_GetPM_2_5",               prepareCoreData,    benchApc1GetPM_2_5)                     \
+    X(5,    "Apc1_GetCompT",                prepareCoreData,    benchApc1GetCompT)                      \
+    X(6,    "Apc1_GetCompRH",               prepareCoreData,    benchApc1GetCompRH)                     \
+    X(7,    "Apc1_GetRawT",                 prepareCoreData,    benchApc1GetRawT)                       \
+    X(8,    "Apc1_GetRawRH",                prepareCoreData,    benchApc1GetRawRH)                      \
+    X(9,    "APC1::update",                 prepareWrapper,     benchWrapperUpdate)                     \
+    X(10,   "APC1::getPM_2_5",              prepareWrapperData, benchWrapperGetPM_2_5)                  \
+    X(11,   "APC1::getCompT",               prepareWrapperData, benchWrapperGetCompT)                   \
+    X(12,   "Apc1_Calibration_Apply",       prepareCalibration, benchCalibrationApply)                  \
+    X(13,   "Apc1_Aqi_Add",                 prepareAqi,         benchAqiAdd)                            \
+    X(14,   "Apc1_Baseline_Add",            prepareBaseline,    benchBaselineAdd)                       \
+    X(15,   "APC1::invoke",                 prepareWrapper,     benchWrapperInvoke)                     \
+    X(16,   "APC1::invoke(response)",       prepareWrapper,     benchWrapperInvokeResponse)
+
+//// measurement
+
+typedef struct Measurement
+{
+    uint32_t    min;
+    uint32_t    max;
+    uint16_t    stack;
+} Measurement;
+
+static uint32_t overhead;               // counts of the empty call
+
+__attribute__((noinline)) static void measure(void (*prepare)(), void (*call)(), Measurement* measurement)
+{
+    measurement->min    = UINT32_MAX;
+    measurement->max    = 0;
+    measurement->stack  = 0;
+
+    prepare();
+
+    for (uint8_t run = 0; run < RUNS; run++)
+    {
+        volatile uint8_t* top       = stackPointer();
+        volatile uint8_t* bottom    = top - STACK_PAINT;
+        if (stackLimit() != NULL && bottom < stackLimit())
+        {
+            bottom = stackLimit();
+        }
+        for (volatile uint8_t* byte = bottom; byte < top; byte++)
+        {
+            *byte = STACK_PATTERN;
+        }
+
+        const uint32_t start    = counter();
+        call();
+        const uint32_t counts   = counter() - start;
+
+        volatile uint8_t* used = bottom;
+        while (used < top && *used == STACK_PATTERN)
+        {
+            used++;
+        }
+
+        const uint32_t net  = (counts > overhead) ? counts - overhead : 0;
+        const uint16_t depth = (uint16_t)(top - used);
+        measurement->min    = (net < measurement->min) ? net : measurement->min;
+        measurement->max    = (net > measurement->max) ? net : measurement->max;
+        measurement->stack  = (depth > measurement->stack) ? depth : measurement->stack;
+    }
+}
+
+static void report(const char* api, const Measurement* measurement)
+{
+    put("{\"target\":\"" TARGET "\",\"counter\":\"" COUNTER "\",\"api\":\"");
+    put(api);
+    put("\",\"runs\":");
+    putNumber(RUNS);
+    put(",\"min\":");
+    putNumber(measurement->min);
+    put(",\"max\":");
+    putNumber(measurement->max);
+    put(",\"stack\":");
+    putNumber(measurement->stack);
+    put("}\n");
+}
+
+#define APC1_BENCH_RUN(index, name, prepare, call)                              \
+    if (index > 0 && (APC1_BENCH_SELECT < 0 || APC1_BENCH_SELECT == index))    \
+    {                                                                           \
+        measure(prepare, call, &measurement);                                   \
+        report(name, &measurement);                                             \
+    }
+
+int main()
+{
+    Measurement measurement;
+
+    targetInit();
+    prepareFrame();
+
+    measure(prepareNothing, benchNothing, &measurement);
+    overhead = measurement.min;
+
+    APC1_BENCHES(APC1_BENCH_RUN)
+
+    stop();
+    return 0;
+}
@@ -0,0 +1,56 @@
+#ifndef APC1_MCU_MOCK_ARDUINO_H
+#define APC1_MCU_MOCK_ARDUINO_H
+
+//// The part of the Arduino API used by src/apc1.h, for bare metal builds of apc1_mcu_bench.cpp
+//
+// millis() and delay() are implemented by the benchmark, which runs a simulated clock. Print and
+// Stream keep the virtual byte interface of the Arduino cores, so the wrapper pays the same calls.
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+unsigned long   millis();
+void            delay(unsigned long ms);
+
+class Print
+{
+public:
+    virtual size_t write(uint8_t) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size)
+    {
+        size_t n = 0;
+        while (size-- > 0 && write(*buffer++) == 1)
+        {
+            n++;
+        }
+        return n;
+    }
+    virtual void flush() { }
+};
+
+class Stream : public Print
+{
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+
+    // like the Arduino cores, but without the timeout: the mock streams never run dry
+    size_t readBytes(uint8_t* buffer, size_t length)
+    {
+        size_t count = 0;
+        while (count < length)
+        {
+            const int c = read();
+            if (c < 0)
+            {
+                break;
+            }
+            buffer[count++] = (uint8_t)c;
+        }
+        return count;
+    }
+    size_t readBytes(char* buffer, size_t length) { return readBytes((uint8_t*)buffer, length); }
+};
+
+#endif // APC1_MCU_MOCK_ARDUINO_H
@@ -0,0 +1,15 @@
+#ifndef APC1_MCU_MOCK_WIRE_H
+#define APC1_MCU_MOCK_WIRE_H
+
+#include "Arduino.h"
+
+// declared only; the benchmark uses the UART interface
+class TwoWire : public Stream
+{
+public:
+    void    beginTransmission(uint8_t address);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, size_t size);
+};
+
+#endif // APC1_MCU_MOCK_WIRE_H
@@ -0,0 +1,67 @@
+#!/bin/sh
+# Builds apc1_mcu_bench.cpp for a target, runs it in the local emulator and prints one JSON line per
+# API, with the flash and static RAM in bytes the API adds to a build of the harness alone:
+#
+#   ./run.sh avr|cortex-m3|host > results.jsonl
+#
+# Needs avr-gcc and simavr, or arm-none-eabi-gcc and qemu-system-arm. The builds go to $BUILD_DIR
+# (default ./build).
+set -e
+
+target=${1:-avr}
+cd "$(dirname "$0")"
+out=${BUILD_DIR:-build}/$target
+mkdir -p "$out"
+
+case $target in
+    avr)
+        CXX=avr-g++
+        SIZE=avr-size
+        FLAGS="-mmcu=atmega2560 -DF_CPU=16000000UL -Os"
+        RUN="simavr -m atmega2560 -f 16000000"
+        ;;
+    cortex-m3)
+        CXX=arm-none-eabi-g++
+        SIZE=arm-none-eabi-size
+        FLAGS="-mcpu=cortex-m3 -mthumb -Os -nostartfiles -specs=nano.specs -specs=nosys.specs -T lm3s6965.ld"
+        RUN="qemu-system-arm -M lm3s6965evb -nographic -icount shift=0 -semihosting-config enable=on,target=native -kernel"
+        ;;
+    host)
+        CXX=g++
+        SIZE=size
+        FLAGS="-O2"
+        RUN=""
+        ;;
+    *)
+        echo "usage: $0 avr|cortex-m3|host" >&2
+        exit 1
+        ;;
+esac
+
+build()
+{
+    $CXX -std=gnu++11 $FLAGS -Wall -fno-exceptions -fno-rtti -fno-threadsafe-statics -ffunction-sections -fdata-sections \
+        -Wl,--gc-sections -I../../src -Imock -DAPC1_BENCH_SELECT=$1 -o "$out/$2" apc1_mcu_bench.cpp
+}
+
+# flash: text + data, static RAM: data + bss
+footprint()
+{
+    $SIZE "$1" | awk 'NR == 2 { print $1 + $2, $2 + $3 }'
+}
+
+build -1 apc1_mcu_bench.elf
+build 0 harness.elf
+set -- $(footprint "$out/harness.elf")
+harnessFlash=$1
+harnessRam=$2
+
+timeout 300 $RUN "$out/apc1_mcu_bench.elf" | grep -o '{.*}' > "$out/results.jsonl"
+
+index=1
+while read -r line; do
+    build $index api.elf
+    set -- $(footprint "$out/api.elf")
+    echo "$line" | sed "s/}\$/,\"flash\":$(($1 - harnessFlash)),\"ram\":$(($2 - harnessRam))}/"
+    index=$((index + 1))
+done < "$out/results.jsonl"
@@ -7,9 +7,64 @@
 #include <Stream.h>
 
 #include "lib/apc1/ScioSense_Apc1.h"
+#include "apc1_commands.h"
 #include "lib/io/ScioSense_IOInterface_Arduino_I2C.h"
 #include "lib/io/ScioSense_IOInterface_Arduino_Serial.h"
 
+// The add-on modules in lib/apc1 are not included by default. A sketch defines the switch of each
+// module it uses before including this header, or includes the module header itself before it; the
+// APC1 methods built on a module exist only with the module:
+//
+//      APC1_WITH_SERIALIZER    ScioSense_Apc1_Serializer.h     serialize()
+//      APC1_WITH_BINARY        ScioSense_Apc1_Binary.h         encodeCbor(), encodePacked()
+//      APC1_WITH_ALERTS        ScioSense_Apc1_Alert.h          setAlerts(), getActiveAlerts(), getChangedAlerts()
+//      APC1_WITH_CALIBRATION   ScioSense_Apc1_Calibration.h    setCalibration(), getCorrectedPM(); the corrected PM in
+//                                                              serialize(), addToAqi() and the alerts
+//      APC1_WITH_DISTRIBUTION  ScioSense_Apc1_Distribution.h   getDistribution()
+//      APC1_WITH_AQI           ScioSense_Apc1_Aqi.h            addToAqi()
+//      APC1_WITH_BASELINE      ScioSense_Apc1_Baseline.h       addToBaseline()
+//      APC1_WITH_PIPELINE      ScioSense_Apc1_Pipeline.h       addToPipeline()
+//      APC1_WITH_POWER         ScioSense_Apc1_Power.h
+//      APC1_WITH_SUPERVISOR    ScioSense_Apc1_Supervisor.h
+//      APC1_WITH_DOWNSAMPLER   ScioSense_Apc1_Downsampler.h
+//
+// The Arduino IDE finds the library only by a header in src/, so sketches use the switches rather
+// than start with a lib/apc1 include. APC1_NO_STATS and APC1_NO_PHASE shrink the APC1 object; see
+// ScioSense_Apc1.h.
+#ifdef APC1_WITH_SERIALIZER
+#include "lib/apc1/ScioSense_Apc1_Serializer.h"
+#endif
+#ifdef APC1_WITH_BINARY
+#include "lib/apc1/ScioSense_Apc1_Binary.h"
+#endif
+#ifdef APC1_WITH_ALERTS
+#include "lib/apc1/ScioSense_Apc1_Alert.h"
+#endif
+#ifdef APC1_WITH_CALIBRATION
+#include "lib/apc1/ScioSense_Apc1_Calibration.h"
+#endif
+#ifdef APC1_WITH_DISTRIBUTION
+#include "lib/apc1/ScioSense_Apc1_Distribution.h"
+#endif
+#ifdef APC1_WITH_AQI
+#include "lib/apc1/ScioSense_Apc1_Aqi.h"
+#endif
+#ifdef APC1_WITH_BASELINE
+#include "lib/apc1/ScioSense_Apc1_Baseline.h"
+#endif
+#ifdef APC1_WITH_PIPELINE
+#include "lib/apc1/ScioSense_Apc1_Pipeline.h"
+#endif
+#ifdef APC1_WITH_POWER
+#include "lib/apc1/ScioSense_Apc1_Power.h"
+#endif
+#ifdef APC1_WITH_SUPERVISOR
+#include "lib/apc1/ScioSense_Apc1_Supervisor.h"
+#endif
+#ifdef APC1_WITH_DOWNSAMPLER
+#include "lib/apc1/ScioSense_Apc1_Downsampler.h"
+#endif
+
 class APC1 : public ScioSense_Apc1
 {
 public:
@@ -20,6 +75,7 @@ public:
     inline void begin(TwoWire* wire, const uint8_t address = 0x12);     // Connnects to APC1 using the given TwoWire object and address
     inline void begin(Stream* serial);                                  // Connnects to APC1 using the given Stream(Serial) object
     inline bool init();                                                 // Resets the device to IDLE and reads PartID and FirmwareVersion
+    inline void setIdentityCache(const Apc1_IdentityCache& cache);      // Uses the given persistence callbacks to skip reading PartID and FirmwareVersion on warm boots
     bool isConnected();                                                 // Checks if the read firmware version is plausible; returns true, if so.
 
 public:
@@ -29,9 +85,16 @@ public:
 public:
     inline void clear();                                                // Clears IO buffers of the Stream device
     inline void reset();                                                // Resets the APC1 to default values
-    inline Result update();                                             // Reads measurement data; Automaticcaly calls "RequestMeasurement" if in passive mode;
+    inline Result update();                                             // Reads measurement data; Automaticcaly calls "RequestMeasurement" if in passive mode; RESULT_NO_NEW_DATA for suppressed duplicates
     inline bool setOperatingMode(const Apc1_OperatingMode& mode);       // Toggle between idle and measurement mode
     inline bool setMeasurementMode(const Apc1_MeasurementMode& mode);   // Toggle between active and passive measurement mode
+    inline void setUpdateOptions(const Apc1_UpdateOption& options);     // Enables duplicate frame suppression; see APC1_UPDATE_OPTION_*
+    inline void setReadinessPolling(const bool enable, const uint16_t resetTimeout = APC1_SYSTEM_TIMING_STANDARD_MEASURE, const uint16_t commandTimeout = APC1_SYSTEM_TIMING_COMMAND_EXEC); // I2C only; polls the device instead of using fixed reset and command delays
+
+public:
+    template<class Command> inline Result invoke();                     // Sends a ScioSense::Apc1Command::Frame which has no response
+    template<class Command, size_t ResponseLength>
+    inline Result invoke(uint8_t (&response)[ResponseLength]);          // Sends a ScioSense::Apc1Command::Frame and reads and validates its response; ResponseLength must be ScioSense::Apc1Command::Response<Command>::length
 
 public:
     inline uint16_t getPM_1_0();                                        // returns PM1.0 mass concentration
@@ -59,11 +122,67 @@ public:
     inline uint32_t getRS3();                                           // returns Gas sensor 3 raw resistance value
     inline AirQualityIndex_UBA getAQI();                                // returns Air Quality Index according to UBA Classification of TVOC value
     inline uint16_t getFirmwareVersion();                               // returns Firmware version
+    inline Apc1_IdentityState getIdentityState();                       // returns whether PartID and FirmwareVersion were read from the device or the identity cache; on APC1_IDENTITY_STATE_MISMATCH, init() reads them again
     inline Apc1_ErrorCode getError();                                   // returns Error codes (see datasheet)
+#ifdef SCIOSENSE_APC1_DISTRIBUTION_C_H
+    inline void getDistribution(Apc1_Distribution& distribution, const float density = APC1_DISTRIBUTION_DEFAULT_DENSITY); // Computes the particle size distribution of the latest measurement: counts per bin, number and mass per m³, geometric mean diameter
+#endif
+#ifdef SCIOSENSE_APC1_AQI_C_H
+    inline Result addToAqi(Apc1_AqiEngine& engine, const uint32_t timestamp); // Adds the latest valid measurement, with the calibrated PM if set, to the PM2.5/PM10 indices (EPA AQI, NowCast, CAQI); timestamp in s; RESULT_OK if an hour closed and the indices changed
+#endif
+#ifdef SCIOSENSE_APC1_BASELINE_C_H
+    inline Result addToBaseline(Apc1_Baseline& baseline, const uint32_t timestamp); // Adds the latest valid measurement to the gas sensor baselines; timestamp in s; the drift compensated ratios are in the baseline
+#endif
+#ifdef SCIOSENSE_APC1_PIPELINE_C_H
+    inline Result addToPipeline(Apc1_Pipeline& pipeline, const uint32_t timestamp); // Pushes the latest valid measurement, with the raw PM, to the transforms and sink queues of the pipeline; RESULT_NOT_ALLOWED if a BLOCK sink is full
+#endif
+
+#ifdef SCIOSENSE_APC1_SERIALIZER_C_H
+public:
+    inline size_t serialize(char* buffer, const size_t size, const Apc1_Format format = APC1_FORMAT_CSV, const uint32_t fieldMask = APC1_FIELD_MASK_ALL); // Formats the latest measurement, with the calibrated PM if set, as one line of CSV, JSON or line protocol; returns its length, 0 if the buffer is too small or line protocol has no fields
+    inline size_t serialize(char* buffer, const size_t size, const Apc1_Format format, const uint32_t fieldMask, const uint64_t timestamp);                          // Same, with the timestamp as first CSV column, "ts" in JSON or the line protocol timestamp; 0 is written as well
+#endif
+
+#ifdef SCIOSENSE_APC1_BINARY_C_H
+public:
+    inline size_t encodeCbor(uint8_t* buffer, const size_t size, const uint32_t fieldMask = APC1_BINARY_DEFAULT_FIELD_MASK, const uint64_t timestamp = 0); // Encodes the latest measurement with the raw PM and the identity as CBOR with integer keys; returns its length, 0 if the buffer is too small
+    inline size_t encodePacked(uint8_t* buffer, const size_t size);     // Encodes the latest measurement with the raw PM and the identity in the 51 byte packed layout; returns its length, 0 if the buffer is too small
+#endif
+
+#ifdef SCIOSENSE_APC1_ALERT_C_H
+public:
+    inline void setAlerts(Apc1_AlertEngine* engine);                    // Evaluates the rules of the engine, set up by Apc1_AlertEngine_Init, on every valid frame read by update(), with the calibrated PM if set; the engine is owned by the caller; NULL disables the alerts
+    inline uint32_t getActiveAlerts();                                  // returns a bit per raised rule; 0 without alerts
+    inline uint32_t getChangedAlerts();                                 // returns a bit per rule which changed its state on the last valid frame; 0 without alerts
+#endif
+
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+public:
+    inline Result setCalibration(const Apc1_Calibrator* calibrator, Apc1_CorrectedPM* corrected); // Corrects the PM fields of every valid frame read by update() with the calibrator, set up by Apc1_Calibration_Init, into corrected, before the alerts; both are owned by the caller; NULL disables the correction; RESULT_INVALID for a calibrator without table or without corrected
+    inline float getCorrectedPM(const Apc1_Field field);                // returns the calibrated and humidity corrected value of a PM field in µg/m³; the raw value without calibration
+#endif
+
+public:
+    inline uint32_t getSampleAge();                                     // returns the estimated age of the measurement data in ms; APC1_SAMPLE_AGE_UNKNOWN while the device phase is unknown
+    inline uint32_t getRequestDelay();                                  // returns the ms to wait before the next update() to get data right after the next device refresh; while the phase is unknown, the ms until a request which narrows it
+
+public:
+    inline Apc1_Stats getStats();                                       // returns a snapshot of the health and performance counters
+    inline void resetStats();                                           // sets all health and performance counters to zero
 
 protected:
     ScioSense_Arduino_I2c_Config        i2cConfig;
     ScioSense_Arduino_Serial_Config     serialConfig;
+#ifdef SCIOSENSE_APC1_ALERT_C_H
+    Apc1_AlertEngine*                   alerts;
+#endif
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+    const Apc1_Calibrator*              calibrator;
+    Apc1_CorrectedPM*                   corrected;
+#endif
+
+protected:
+    inline const uint8_t* getCorrectedData(uint8_t* frame);            // returns the measurement data; with calibration, a copy with the corrected PM in frame
 
 private:
     Stream* debugStream;
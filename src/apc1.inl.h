@@ -9,8 +9,26 @@ APC1::APC1()
     moduleName[0]   = 0;
     fwVersion       = 0;
     serialNumber    = 0;
+    identityCache   = { 0 };
+    identityState   = APC1_IDENTITY_STATE_READ;
     operatingMode   = APC1_OPERATING_MODE_STANDARD;
     measurementMode = APC1_MEASUREMENT_MODE_PASSIVE;
+    updateOptions   = APC1_UPDATE_OPTION_NONE;
+    timing          = { 0 };
+    frameChecksum   = 0;
+    frameCrc        = 0;
+#ifdef SCIOSENSE_APC1_ALERT_C_H
+    alerts          = NULL;
+#endif
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+    calibrator      = NULL;
+    corrected       = NULL;
+#endif
+
+#ifndef APC1_NO_PHASE
+    Apc1_ResetPhase(this);
+#endif
+    Apc1_ResetStats(this);
 }
 
 void APC1::begin(Stream* serial)
@@ -22,6 +40,7 @@ void APC1::begin(Stream* serial)
     io.write            = ScioSense_Arduino_Serial_Write;
     io.wait             = ScioSense_Arduino_Serial_Wait;
     io.clear            = ScioSense_Arduino_Serial_Clear;
+    io.millis           = ScioSense_Arduino_Serial_Millis;
     io.protocol         = APC1_PROTOCOL_UART;
     io.config           = &serialConfig;
 }
@@ -35,6 +54,7 @@ void APC1::begin(TwoWire* wire, const uint8_t address)
     io.read             = ScioSense_Arduino_I2c_Read;
     io.write            = ScioSense_Arduino_I2c_Write;
     io.wait             = ScioSense_Arduino_I2c_Wait;
+    io.millis           = ScioSense_Arduino_I2c_Millis;
     io.protocol         = APC1_PROTOCOL_I2C;
     io.config           = &i2cConfig;
 
@@ -47,6 +67,11 @@ inline bool APC1::init()
     return Apc1_Reset(this) == RESULT_OK;
 }
 
+void APC1::setIdentityCache(const Apc1_IdentityCache& cache)
+{
+    identityCache = cache;
+}
+
 void APC1::clear()
 {
     this->io.clear(this->io.config);
@@ -72,9 +97,53 @@ bool APC1::setMeasurementMode(const Apc1_MeasurementMode& mode)
     return Apc1_SetMeasurementMode(this, mode) == RESULT_OK;
 }
 
+void APC1::setUpdateOptions(const Apc1_UpdateOption& options)
+{
+    updateOptions = options;
+}
+
+void APC1::setReadinessPolling(const bool enable, const uint16_t resetTimeout, const uint16_t commandTimeout)
+{
+    timing.readinessPolling = enable;
+    timing.resetTimeout     = resetTimeout;
+    timing.commandTimeout   = commandTimeout;
+}
+
 Result APC1::update()
 {
-    return Apc1_Update(this);
+    Result result = Apc1_Update(this);
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+    if (result == RESULT_OK && calibrator != NULL)
+    {
+        Apc1_Calibration_Apply(calibrator, measurementData, corrected);
+    }
+#endif
+#ifdef SCIOSENSE_APC1_ALERT_C_H
+    if (result == RESULT_OK && alerts != NULL)
+    {
+        uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+        Apc1_AlertEngine_Evaluate(alerts, getCorrectedData(frame));
+    }
+#endif
+
+    return result;
+}
+
+template<class Command>
+Result APC1::invoke()
+{
+    return Apc1_Invoke(this, Command::frame, NULL, 0, NULL);
+}
+
+template<class Command, size_t ResponseLength>
+Result APC1::invoke(uint8_t (&response)[ResponseLength])
+{
+    typedef ScioSense::Apc1Command::Response<Command> Response;
+
+    static_assert(Response::length != 0, "the command has no response; use invoke<Command>()");
+    static_assert(ResponseLength == Response::length, "response length does not match the command");
+
+    return Apc1_Invoke(this, Command::frame, response, ResponseLength, Response::check);
 }
 
 uint16_t APC1::getPM_1_0()
@@ -202,7 +271,164 @@ uint16_t APC1::getFirmwareVersion()
     return Apc1_GetFirmwareVersion(this);
 }
 
+Apc1_IdentityState APC1::getIdentityState()
+{
+    return Apc1_GetIdentityState(this);
+}
+
 Apc1_ErrorCode APC1::getError()
 {
     return Apc1_GetError(this);
+}
+
+#ifdef SCIOSENSE_APC1_DISTRIBUTION_C_H
+void APC1::getDistribution(Apc1_Distribution& distribution, const float density)
+{
+    Apc1_Distribution_FromFrame(measurementData, density, &distribution);
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_AQI_C_H
+Result APC1::addToAqi(Apc1_AqiEngine& engine, const uint32_t timestamp)
+{
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    return Apc1_Aqi_Add(&engine, timestamp, getCorrectedData(frame));
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_BASELINE_C_H
+Result APC1::addToBaseline(Apc1_Baseline& baseline, const uint32_t timestamp)
+{
+    return Apc1_Baseline_Add(&baseline, timestamp, measurementData);
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_PIPELINE_C_H
+Result APC1::addToPipeline(Apc1_Pipeline& pipeline, const uint32_t timestamp)
+{
+    return Apc1_Pipeline_Push(&pipeline, measurementData, timestamp);
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_SERIALIZER_C_H
+size_t APC1::serialize(char* buffer, const size_t size, const Apc1_Format format, const uint32_t fieldMask)
+{
+    Apc1_Serializer serializer;
+    serializer.format       = format;
+    serializer.fieldMask    = fieldMask;
+    serializer.hasTimestamp = false;
+    serializer.measurement  = NULL;
+
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    return Apc1_Serialize(&serializer, getCorrectedData(frame), 0, buffer, size);
+}
+
+size_t APC1::serialize(char* buffer, const size_t size, const Apc1_Format format, const uint32_t fieldMask, const uint64_t timestamp)
+{
+    Apc1_Serializer serializer;
+    serializer.format       = format;
+    serializer.fieldMask    = fieldMask;
+    serializer.hasTimestamp = true;
+    serializer.measurement  = NULL;
+
+    uint8_t frame[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    return Apc1_Serialize(&serializer, getCorrectedData(frame), timestamp, buffer, size);
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_BINARY_C_H
+size_t APC1::encodeCbor(uint8_t* buffer, const size_t size, const uint32_t fieldMask, const uint64_t timestamp)
+{
+    return Apc1_EncodeCbor(this, fieldMask, timestamp, buffer, size);
+}
+
+size_t APC1::encodePacked(uint8_t* buffer, const size_t size)
+{
+    return Apc1_EncodePacked(this, buffer, size);
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_ALERT_C_H
+void APC1::setAlerts(Apc1_AlertEngine* engine)
+{
+    alerts = engine;
+}
+
+uint32_t APC1::getActiveAlerts()
+{
+    return (alerts != NULL) ? alerts->active : 0;
+}
+
+uint32_t APC1::getChangedAlerts()
+{
+    return (alerts != NULL) ? alerts->changed : 0;
+}
+#endif
+
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+Result APC1::setCalibration(const Apc1_Calibrator* calibrator, Apc1_CorrectedPM* corrected)
+{
+    if (calibrator != NULL && (calibrator->table == NULL || corrected == NULL))
+    {
+        return RESULT_INVALID;
+    }
+
+    this->calibrator    = calibrator;
+    this->corrected     = (calibrator != NULL) ? corrected : NULL;
+    if (calibrator != NULL && Apc1_CheckMeasurementData(measurementData) == RESULT_OK)
+    {
+        Apc1_Calibration_Apply(calibrator, measurementData, corrected);
+    }
+
+    return RESULT_OK;
+}
+
+float APC1::getCorrectedPM(const Apc1_Field field)
+{
+    if (calibrator == NULL)
+    {
+        return (field < APC1_CALIBRATION_PM_FIELDS) ? (float)Apc1_GetFieldValue(measurementData, field) : 0.0f;
+    }
+
+    return Apc1_Calibration_ToFloat(corrected, field);
+}
+#endif
+
+const uint8_t* APC1::getCorrectedData(uint8_t* frame)
+{
+#ifdef SCIOSENSE_APC1_CALIBRATION_C_H
+    if (calibrator != NULL)
+    {
+        for (uint8_t i = 0; i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH; i++)
+        {
+            frame[i] = measurementData[i];
+        }
+        Apc1_Calibration_Correct(corrected, frame);
+        return frame;
+    }
+#endif
+    (void)frame;
+    return measurementData;
+}
+
+uint32_t APC1::getSampleAge()
+{
+    return Apc1_GetSampleAge(this);
+}
+
+uint32_t APC1::getRequestDelay()
+{
+    return Apc1_GetRequestDelay(this);
+}
+
+Apc1_Stats APC1::getStats()
+{
+    Apc1_Stats snapshot;
+    Apc1_GetStats(this, &snapshot);
+    return snapshot;
+}
+
+void APC1::resetStats()
+{
+    Apc1_ResetStats(this);
 }
\ No newline at end of file
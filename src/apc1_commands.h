@@ -0,0 +1,111 @@
+#ifndef SCIOSENSE_APC1_COMMANDS_H
+#define SCIOSENSE_APC1_COMMANDS_H
+
+#include <stdint.h>
+
+#include "lib/apc1/ScioSense_Apc1.h"
+
+namespace ScioSense
+{
+namespace Apc1Command
+{
+    // This class builds a 7 byte APC1 command frame and its checksum at compile time
+    //
+    //  byte    0       1       2               3       4       5           6
+    //          0x42    0x4D    commandAddress  dataH   dataL   checksumH   checksumL
+    //
+    // The checksum is the sum over bytes 0 to 4.
+    //
+    template<uint8_t CommandAddress, uint8_t DataH, uint8_t DataL>
+    class Frame
+    {
+    public:
+        static constexpr uint16_t checksum = APC1_COMMAND_ADDRESS_START_BYTE_1 + APC1_COMMAND_ADDRESS_START_BYTE_2 + CommandAddress + DataH + DataL;
+        static constexpr uint8_t  frame[APC1_COMMAND_LENGTH] =
+        {
+            APC1_COMMAND_ADDRESS_START_BYTE_1,
+            APC1_COMMAND_ADDRESS_START_BYTE_2,
+            CommandAddress,
+            DataH,
+            DataL,
+            (uint8_t)(checksum >> 8),
+            (uint8_t)(checksum & 0xFF)
+        };
+    };
+
+    template<uint8_t CommandAddress, uint8_t DataH, uint8_t DataL>
+    constexpr uint8_t Frame<CommandAddress, DataH, DataL>::frame[APC1_COMMAND_LENGTH];
+
+    typedef Frame<APC1_COMMAND_ADDRESS_MEASUREMENT_MODE     , 0x00, 0x00> SetMeasurementModePassive;
+    typedef Frame<APC1_COMMAND_ADDRESS_MEASUREMENT_MODE     , 0x00, 0x01> SetMeasurementModeActive;
+    typedef Frame<APC1_COMMAND_ADDRESS_REQUEST_MEASUREMENT  , 0x00, 0x00> PassiveMeasurement;
+    typedef Frame<APC1_COMMAND_ADDRESS_OPERATION_MODE       , 0x00, 0x00> SetIdle;
+    typedef Frame<APC1_COMMAND_ADDRESS_OPERATION_MODE       , 0x00, 0x01> SetWake;
+    typedef Frame<APC1_COMMAND_ADDRESS_OPERATION_MODE       , 0x00, 0x0F> Reset;
+    typedef Frame<APC1_COMMAND_ADDRESS_READSENSOR_VERSION   , 0x00, 0x00> ReadSensorVersion;
+
+    // The response of a command: its length and the check which validates it. A length of 0 means
+    // the command has no response in the command register (the passive measurement is read as a frame).
+    template<class Command>
+    struct Response
+    {
+        static constexpr uint8_t            length  = APC1_COMMAND_RESPONSE_DEFAULT_LENGTH;
+        static constexpr Apc1_ResponseCheck check   = Apc1_CheckCommandResponse;
+    };
+
+    template<>
+    struct Response<PassiveMeasurement>
+    {
+        static constexpr uint8_t            length  = 0;
+        static constexpr Apc1_ResponseCheck check   = nullptr;
+    };
+
+    template<>
+    struct Response<SetWake>
+    {
+        static constexpr uint8_t            length  = 0;
+        static constexpr Apc1_ResponseCheck check   = nullptr;
+    };
+
+    template<>
+    struct Response<Reset>
+    {
+        static constexpr uint8_t            length  = 0;
+        static constexpr Apc1_ResponseCheck check   = nullptr;
+    };
+
+    template<>
+    struct Response<ReadSensorVersion>
+    {
+        static constexpr uint8_t            length  = APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH;
+        static constexpr Apc1_ResponseCheck check   = Apc1_CheckSensorVersionResponse;
+    };
+
+    // The C interface uses the APC1_COMMAND_* initializers; make sure they match the generated frames.
+    constexpr bool equals(const uint8_t* a, const uint8_t* b, const uint8_t i = 0)
+    {
+        return (i == APC1_COMMAND_LENGTH) || (a[i] == b[i] && equals(a, b, i + 1));
+    }
+
+    namespace Defines
+    {
+        constexpr uint8_t setMeasurementModePassive[]   = APC1_COMMAND_SET_MEASUREMENT_MODE_PASSIVE;
+        constexpr uint8_t setMeasurementModeActive[]    = APC1_COMMAND_SET_MEASUREMENT_MODE_ACTIVE;
+        constexpr uint8_t passiveMeasurement[]          = APC1_COMMAND_PASSIVE_MEASUREMENT;
+        constexpr uint8_t setIdle[]                     = APC1_COMMAND_SET_IDLE;
+        constexpr uint8_t setWake[]                     = APC1_COMMAND_SET_WAKE;
+        constexpr uint8_t reset[]                       = APC1_COMMAND_RESET;
+        constexpr uint8_t readSensorVersion[]           = APC1_COMMAND_READ_SENSOR_VERSION;
+    }
+
+    static_assert(equals(SetMeasurementModePassive::frame   , Defines::setMeasurementModePassive)   , "APC1_COMMAND_SET_MEASUREMENT_MODE_PASSIVE mismatch");
+    static_assert(equals(SetMeasurementModeActive::frame    , Defines::setMeasurementModeActive)    , "APC1_COMMAND_SET_MEASUREMENT_MODE_ACTIVE mismatch");
+    static_assert(equals(PassiveMeasurement::frame          , Defines::passiveMeasurement)          , "APC1_COMMAND_PASSIVE_MEASUREMENT mismatch");
+    static_assert(equals(SetIdle::frame                     , Defines::setIdle)                     , "APC1_COMMAND_SET_IDLE mismatch");
+    static_assert(equals(SetWake::frame                     , Defines::setWake)                     , "APC1_COMMAND_SET_WAKE mismatch");
+    static_assert(equals(Reset::frame                       , Defines::reset)                       , "APC1_COMMAND_RESET mismatch");
+    static_assert(equals(ReadSensorVersion::frame           , Defines::readSensorVersion)           , "APC1_COMMAND_READ_SENSOR_VERSION mismatch");
+}
+}
+
+#endif //SCIOSENSE_APC1_COMMANDS_H
@@ -4,6 +4,7 @@
 #include "ScioSense_Apc1_defines.h"
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <inttypes.h>
 
 typedef struct ScioSense_Apc1_IO
@@ -12,10 +13,69 @@ typedef struct ScioSense_Apc1_IO
     Result  (*write)    (void* config, const uint16_t address, uint8_t* data, const size_t size);
     Result  (*clear)    (void* config);
     void    (*wait)     (const uint32_t ms);
+    uint32_t(*millis)   (void);                                     // optional; enables latency statistics if set
     Apc1_Protocol protocol;
     void* config;
 } ScioSense_Apc1_IO;
 
+typedef Result (*Apc1_ResponseCheck)(const Apc1_Command command, const uint8_t* data, const Apc1_CommandResponse size);   // validates the response to a command; see Apc1_Check*Response
+
+typedef struct Apc1_Identity
+{
+    uint8_t     moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH+1];
+    uint16_t    fwVersion;
+    uint64_t    serialNumber;
+    uint16_t    checksum;                                           // set and verified by the library; persist it with the identity
+} Apc1_Identity;
+
+typedef struct Apc1_IdentityCache
+{
+    bool    (*load)     (void* context, Apc1_Identity* identity);           // returns true, if an identity was loaded from persistent memory
+    void    (*store)    (void* context, const Apc1_Identity* identity);     // writes the identity to persistent memory (NVS, EEPROM, file)
+    void*   context;
+} Apc1_IdentityCache;
+
+typedef struct Apc1_Stats
+{
+    uint32_t    framesOk;                                           // valid measurement frames read by Apc1_Update
+    uint32_t    checksumErrors;                                     // Apc1_Update results RESULT_CHECKSUM_ERROR
+    uint32_t    invalidFrames;                                      // Apc1_Update results RESULT_INVALID (includes emptyFrames)
+    uint32_t    emptyFrames;                                        // frames rejected because AQI == 0 (device switching opmodes)
+    uint32_t    ioErrors;                                           // Apc1_Update results RESULT_IO_ERROR
+    uint32_t    duplicateFrames;                                    // Apc1_Update results RESULT_NO_NEW_DATA
+    uint32_t    commandErrors;                                      // commands which failed or had an invalid response
+    uint32_t    resyncs;                                            // IO buffer clears issued to recover the stream, and UART realignments
+    uint32_t    discardedBytes;                                     // bytes skipped by Apc1_Update to realign a misaligned UART stream
+    uint32_t    resetRetries;                                       // retries needed within Apc1_Reset
+    uint32_t    errorCodes[APC1_STATS_ERROR_CODE_BITS];             // valid frames with the respective Apc1_ErrorCode bit set
+    uint16_t    commandLatency[APC1_STATS_LATENCY_BUCKETS];         // command round trip times; see APC1_STATS_LATENCY_BUCKETS
+    uint16_t    updateLatency[APC1_STATS_LATENCY_BUCKETS];          // Apc1_Update durations, from the request for Apc1_Ingest; see APC1_STATS_LATENCY_BUCKETS
+} Apc1_Stats;
+
+typedef struct Apc1_Timing
+{
+    bool        readinessPolling;                                   // I2C only; poll for valid data instead of the fixed APC1_SYSTEM_TIMING_* delays
+    uint16_t    pollInterval;                                       // ms between polls; 0 selects APC1_SYSTEM_TIMING_POLL_INTERVAL
+    uint16_t    resetTimeout;                                       // max ms to wait for a new frame after a reset; 0 selects APC1_SYSTEM_TIMING_STANDARD_MEASURE
+    uint16_t    commandTimeout;                                     // max ms to wait for a command response; 0 selects APC1_SYSTEM_TIMING_COMMAND_EXEC
+    uint16_t    resetReadyTime;                                     // observed ms until the device delivered a new frame after the last reset
+    uint16_t    commandReadyTime;                                   // observed ms until the last polled command response was valid
+} Apc1_Timing;
+
+typedef struct Apc1_Phase
+{
+    uint32_t    lastRequest;                                        // host time of the previous valid frame request
+    uint32_t    windowStart;                                        // earliest host time of a device refresh
+    uint32_t    windowLength;                                       // uncertainty of windowStart; >= APC1_PHASE_LOCK_WINDOW if unknown
+    uint32_t    sampleAge;                                          // estimated age of measurementData at arrival; APC1_SAMPLE_AGE_UNKNOWN if unknown
+    bool        hasPrevious;                                        // lastRequest and frameCrc are valid
+} Apc1_Phase;
+
+// Compile-time switches for small targets; define them before the library is included:
+//
+//      APC1_NO_STATS   drops the Apc1_Stats counters from ScioSense_Apc1; Apc1_GetStats returns zeros
+//      APC1_NO_PHASE   drops the refresh phase tracker; Apc1_GetSampleAge returns APC1_SAMPLE_AGE_UNKNOWN
+//                      and Apc1_GetRequestDelay 0
 typedef struct ScioSense_Apc1
 {
     ScioSense_Apc1_IO       io;
@@ -23,13 +83,27 @@ typedef struct ScioSense_Apc1
     uint8_t                 moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH+1];
     uint16_t                fwVersion;
     uint64_t                serialNumber;
+    Apc1_IdentityCache      identityCache;                      // optional; skips ReadSensorVersion in Apc1_Reset on warm boots
+    Apc1_IdentityState      identityState;
     Apc1_OperatingMode      operatingMode;
     Apc1_MeasurementMode    measurementMode;
+    Apc1_UpdateOption       updateOptions;
+    Apc1_Timing             timing;
+    uint16_t                frameChecksum;                      // checksum of the latest valid measurement frame; 0 if there is none
+    uint16_t                frameCrc;                           // CRC-16 of the latest valid measurement frame; detects changes the additive checksum misses
+#ifndef APC1_NO_PHASE
+    Apc1_Phase              phase;
+#endif
+#ifndef APC1_NO_STATS
+    Apc1_Stats              stats;
+#endif
 
 } ScioSense_Apc1;
 
 static inline Result              Apc1_Reset                  (ScioSense_Apc1* apc1);                             // Resets the APC1 to default values
 static inline Result              Apc1_Update                 (ScioSense_Apc1* apc1);                             // Reads measurement data; Automaticcaly calls "RequestMeasurement" if in passive mode;
+static inline Result              Apc1_Ingest                 (ScioSense_Apc1* apc1, const uint8_t* frame, const uint32_t requestTime); // Takes a measurement frame the caller read itself (e.g. in an event loop) through the checks, duplicate suppression, phase tracking, identity validation and stats of Apc1_Update
+static inline void                Apc1_ForgetFrame            (ScioSense_Apc1* apc1);                             // Forgets the latest valid frame, so the next one is neither suppressed as a duplicate nor taken as a device refresh; for callers which reset or reconfigure the device themselves
 static inline Result              Apc1_ReadSensorVersion      (ScioSense_Apc1* apc1);
 static inline Result              Apc1_SetOperatingMode       (ScioSense_Apc1* apc1, const Apc1_OperatingMode mode);   // Toggle between idle and measurement mode
 static inline Result              Apc1_SetMeasurementMode     (ScioSense_Apc1* apc1, const Apc1_MeasurementMode mode); // Toggle between active and passive measurement mode
@@ -54,6 +128,8 @@ static inline float               Apc1_GetCompT               (ScioSense_Apc1* a
 static inline float               Apc1_GetCompRH              (ScioSense_Apc1* apc1);                             // returns Compensated humidity (see datasheet)
 static inline float               Apc1_GetRawT                (ScioSense_Apc1* apc1);                             // returns Uncompensated temperature
 static inline float               Apc1_GetRawRH               (ScioSense_Apc1* apc1);                             // returns Uncompensated humidity
+static inline uint32_t            Apc1_GetFieldValue          (const uint8_t* data, const Apc1_Field field);      // returns the unscaled value of a field of the measurement data struct
+static inline void                Apc1_SetFieldValue          (uint8_t* data, const Apc1_Field field, const uint32_t value); // writes the unscaled value of a field to the measurement data struct
 static inline uint32_t            Apc1_GetRS0                 (ScioSense_Apc1* apc1);                             // returns Gas sensor 0 raw resistance value
 static inline uint32_t            Apc1_GetRS1                 (ScioSense_Apc1* apc1);                             // returns Gas sensor 1 raw resistance value
 static inline uint32_t            Apc1_GetRS2                 (ScioSense_Apc1* apc1);                             // returns Gas sensor 2 raw resistance value
@@ -62,9 +138,18 @@ static inline AirQualityIndex_UBA Apc1_GetAQI                 (ScioSense_Apc1* a
 static inline uint16_t            Apc1_GetFirmwareVersion     (ScioSense_Apc1* apc1);                             // returns Firmware version
 static inline Apc1_ErrorCode      Apc1_GetError               (ScioSense_Apc1* apc1);                             // returns Error codes (see datasheet)
 
+static inline Apc1_IdentityState  Apc1_GetIdentityState       (ScioSense_Apc1* apc1);                             // returns whether the identity was read from the device or taken from the identity cache; see APC1_IDENTITY_STATE_*
+static inline uint32_t            Apc1_GetSampleAge           (ScioSense_Apc1* apc1);                             // returns the estimated age of the measurement data in ms at arrival; APC1_SAMPLE_AGE_UNKNOWN while the device phase is unknown
+static inline uint32_t            Apc1_GetRequestDelay        (ScioSense_Apc1* apc1);                             // returns the ms to wait before calling Apc1_Update to get data right after the next device refresh; while the phase is unknown, the ms until a request which narrows it
+
+static inline void                Apc1_GetStats               (ScioSense_Apc1* apc1, Apc1_Stats* snapshot);       // copies the health and performance counters to snapshot
+static inline void                Apc1_ResetStats             (ScioSense_Apc1* apc1);                             // sets all health and performance counters to zero
+
 static inline Result              Apc1_CheckData              (const uint8_t* data, const Apc1_CommandResponse size);                               // calculates the checksum of the data and compares it with the last 2 byte; returns RESULT_CHECKSUM_ERROR on failure
 static inline Result              Apc1_CheckCommandResponse   (const Apc1_Command command, const uint8_t* data, const Apc1_CommandResponse size);   // checks if the data corresponds to the command result protocol and calculates the checksum thereafter; returns RESULT_INVALID if the protocol does not match
+static inline Result              Apc1_CheckSensorVersionResponse(const Apc1_Command command, const uint8_t* data, const Apc1_CommandResponse size); // checks the "ReadSensorVersion" response, which has no command echo, and its checksum; returns RESULT_INVALID if the protocol does not match
 static inline Result              Apc1_CheckMeasurementData   (const uint8_t* data);                                                                // checks measurement date checksum and data plausability
+static inline Result              Apc1_FindMeasurementData    (const uint8_t* data, const size_t size, size_t* offset);                             // searches a byte stream for a valid measurement frame; see below
 
 
 #include "ScioSense_Apc1.inl.h"
@@ -14,6 +14,12 @@
 #define memset(a, b, s)     for(size_t i = 0; i < s; i++) {a[i] = b;}
 #define memcpy(a, b, s)     for(size_t i = 0; i < s; i++) {a[i] = b[i];}
 
+#ifndef APC1_NO_STATS
+#define addStat(counter, n) apc1->stats.counter += (n)
+#else
+#define addStat(counter, n)
+#endif
+
 static inline uint16_t Apc1_GetValueOf16(const uint8_t* data, const uint16_t resultAddress)
 {
     return ((uint16_t)data[resultAddress] << 8) + (uint16_t)data[resultAddress + 1];
@@ -39,6 +45,209 @@ static inline uint64_t Apc1_GetValueOf64(uint8_t* data, const uint16_t resultAdd
           +  (uint64_t)data[resultAddress + 7];
 }
 
+static inline uint16_t Apc1_GetFrameCrc(const uint8_t* data)
+{
+    // CRC-16/CCITT over the frame without its checksum; unlike the additive checksum, it
+    // also changes if two bytes change by compensating amounts
+    uint16_t crc = 0xFFFF;
+
+    for (uint8_t i = 0; i < APC1_RESULT_ADDRESS_CHECKSUM_H; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static inline uint32_t Apc1_Millis(ScioSense_Apc1* apc1)
+{
+    return (apc1->io.millis != NULL) ? apc1->io.millis() : 0;
+}
+
+#ifndef APC1_NO_STATS
+static inline void Apc1_RecordLatency(ScioSense_Apc1* apc1, uint16_t* histogram, const uint32_t start)
+{
+    if (apc1->io.millis == NULL)
+    {
+        return;
+    }
+
+    const uint32_t duration = apc1->io.millis() - start;
+    uint8_t bucket          = 0;
+    for (uint32_t bound = 1; bucket < APC1_STATS_LATENCY_BUCKETS - 1 && duration >= bound; bound <<= 1)
+    {
+        bucket++;
+    }
+
+    if (histogram[bucket] != UINT16_MAX)
+    {
+        histogram[bucket]++;
+    }
+}
+
+static inline void Apc1_CountUpdateResult(ScioSense_Apc1* apc1, const Result result)
+{
+    switch (result)
+    {
+        case RESULT_OK:
+        {
+            addStat(framesOk, 1);
+
+            const Apc1_ErrorCode errorCode = apc1->measurementData[APC1_RESULT_ADDRESS_ERROR_CODE];
+            for (uint8_t bit = 0; bit < APC1_STATS_ERROR_CODE_BITS; bit++)
+            {
+                if (hasFlag(errorCode, 1 << bit))
+                {
+                    addStat(errorCodes[bit], 1);
+                }
+            }
+            break;
+        }
+        case RESULT_CHECKSUM_ERROR  : addStat(checksumErrors, 1);      break;
+        case RESULT_IO_ERROR        : addStat(ioErrors, 1);            break;
+        case RESULT_NO_NEW_DATA     : addStat(duplicateFrames, 1);     break;
+        case RESULT_INVALID         :
+        {
+            addStat(invalidFrames, 1);
+            if
+            (
+                APC1_COMMAND_ADDRESS_START_BYTE_1 == apc1->measurementData[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]
+             && APC1_COMMAND_ADDRESS_START_BYTE_2 == apc1->measurementData[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]
+             && 0                                 == apc1->measurementData[APC1_RESULT_ADDRESS_AQI]
+            )
+            {
+                addStat(emptyFrames, 1);
+            }
+            break;
+        }
+        default                     : break;
+    }
+}
+#else
+// the histogram and counter arguments name members which do not exist; they are not evaluated
+#define Apc1_RecordLatency(apc1, histogram, start)  ((void)(start))
+#define Apc1_CountUpdateResult(apc1, result)        ((void)(result))
+#endif
+
+#ifndef APC1_NO_PHASE
+static inline uint32_t Apc1_PhaseOffset(const uint32_t time, const uint32_t reference)
+{
+    // (time - reference) modulo the device refresh period, in [0, period)
+    int32_t offset = ((int32_t)(time - reference)) % (int32_t)APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    return (uint32_t)((offset < 0) ? offset + APC1_SYSTEM_TIMING_STANDARD_MEASURE : offset);
+}
+
+static inline void Apc1_ResetPhase(ScioSense_Apc1* apc1)
+{
+    apc1->phase.lastRequest     = 0;
+    apc1->phase.windowStart     = 0;
+    apc1->phase.windowLength    = APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    apc1->phase.sampleAge       = APC1_SAMPLE_AGE_UNKNOWN;
+    apc1->phase.hasPrevious     = false;
+}
+
+static inline uint32_t Apc1_PhaseDrift(const uint32_t time, const uint32_t reference)
+{
+    // max clock drift between host and device from reference to time; rounded up, as the window
+    // is moved with each request and most requests are less than a period apart
+    const int32_t  diff     = (int32_t)(time - reference);
+    const uint32_t distance = (uint32_t)(diff < 0 ? -diff : diff);
+
+    return (distance / APC1_SYSTEM_TIMING_STANDARD_MEASURE) * APC1_PHASE_DRIFT_ALLOWANCE
+         + ((distance % APC1_SYSTEM_TIMING_STANDARD_MEASURE) * APC1_PHASE_DRIFT_ALLOWANCE + APC1_SYSTEM_TIMING_STANDARD_MEASURE - 1) / APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+}
+
+static inline void Apc1_CarryPhase(Apc1_Phase* phase, const uint32_t time)
+{
+    // moves a known window to the refresh preceding time and widens it for the clock drift meanwhile
+    const int32_t period    = APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    const uint32_t target   = time - Apc1_PhaseOffset(time, phase->windowStart);
+    const uint32_t drift    = Apc1_PhaseDrift(target, phase->windowStart);
+
+    if (phase->windowLength >= (uint32_t)period)
+    {
+        return;
+    }
+
+    phase->windowStart      = target - drift;
+    phase->windowLength     = (phase->windowLength + 2 * drift < (uint32_t)period) ? phase->windowLength + 2 * drift : (uint32_t)period;
+}
+
+static inline void Apc1_TrackPhase(ScioSense_Apc1* apc1, const uint32_t request, const uint32_t arrival, const bool changed)
+{
+    const int32_t period    = APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    Apc1_Phase* phase       = &apc1->phase;
+    const uint32_t elapsed  = request - phase->lastRequest;
+
+    if (apc1->io.millis == NULL)
+    {
+        return;
+    }
+
+    if (phase->hasPrevious && elapsed >= (uint32_t)period)
+    {
+        // There was a refresh in (lastRequest, request] anyway, so the frame tells nothing about the phase.
+        Apc1_CarryPhase(phase, request);
+    }
+    else if (phase->hasPrevious)
+    {
+        // A changed frame means a device refresh happened in (lastRequest, request].
+        // An unchanged frame means the next refresh happens in (request, lastRequest + period].
+        const uint32_t start    = changed ? phase->lastRequest  : request;
+        const int32_t  length   = changed ? (int32_t)elapsed    : period - (int32_t)elapsed;
+        int32_t lo              = 0;
+        int32_t hi              = length;
+
+        if (phase->windowLength < (uint32_t)period)
+        {
+            // move the known window to the refresh preceding start and widen it for clock drift
+            const int32_t  drift    = (int32_t)Apc1_PhaseDrift(start, phase->windowStart);
+            const int32_t  aligned  = -(int32_t)Apc1_PhaseOffset(start, phase->windowStart) - drift;
+            const int32_t  width    = (int32_t)phase->windowLength + 2 * drift;
+
+            if (width < period)
+            {
+                // intersect [lo, hi] with the window occurrences at aligned and aligned + period (relative to start)
+                const int32_t lo0   = 0;
+                const int32_t hi0   = (aligned + width < length) ? aligned + width : length;
+                const int32_t lo1   = (aligned + period > 0) ? aligned + period : 0;
+                const int32_t hi1   = (aligned + period + width < length) ? aligned + period + width : length;
+                const bool hit0     = lo0 < hi0;
+                const bool hit1     = lo1 < hi1;
+
+                // both only overlap, if the window is wide or was widened for drift; the larger overlap wins
+                if      (hit0 && hit1)  { lo = (hi0 - lo0 >= hi1 - lo1) ? lo0 : lo1; hi = (hi0 - lo0 >= hi1 - lo1) ? hi0 : hi1; }
+                else if (hit0)          { lo = lo0; hi = hi0; }
+                else if (hit1)          { lo = lo1; hi = hi1; }
+            }
+        }
+
+        phase->windowStart  = start + (uint32_t)lo;
+        phase->windowLength = (uint32_t)(hi - lo);
+    }
+
+    if (phase->windowLength < APC1_PHASE_LOCK_WINDOW)
+    {
+        const uint32_t refresh  = phase->windowStart + phase->windowLength / 2;
+        phase->sampleAge        = Apc1_PhaseOffset(request, refresh) + (arrival - request);
+    }
+    else
+    {
+        phase->sampleAge        = APC1_SAMPLE_AGE_UNKNOWN;
+    }
+
+    phase->lastRequest  = request;
+    phase->hasPrevious  = true;
+}
+#else
+#define Apc1_ResetPhase(apc1)
+#define Apc1_TrackPhase(apc1, request, arrival, changed)    ((void)(request), (void)(arrival), (void)(changed))
+#endif
+
 static inline Result Apc1_Read(ScioSense_Apc1* apc1, const uint16_t address, uint8_t* data, const size_t size)
 {
     if (apc1->io.protocol == APC1_PROTOCOL_UART)
@@ -67,29 +276,128 @@ static inline Result Apc1_Write(ScioSense_Apc1* apc1, const uint16_t address, ui
     return RESULT_IO_ERROR;
 }
 
-static inline Result Apc1_Invoke(ScioSense_Apc1* apc1, Apc1_Command command, uint8_t* resultBuf, const size_t size)
+static inline uint16_t Apc1_PollElapsed(ScioSense_Apc1* apc1, const uint32_t start, const uint16_t elapsed, const uint16_t interval)
+{
+    // without a millis callback the poll intervals are summed up
+    return (apc1->io.millis != NULL) ? (uint16_t)(apc1->io.millis() - start) : elapsed + interval;
+}
+
+static inline Result Apc1_PollCommandResponse(ScioSense_Apc1* apc1, Apc1_Command command, uint8_t* resultBuf, const size_t size, Apc1_ResponseCheck check)
+{
+    // The response register keeps the previous response until the new one is written.
+    // A stale response only passes the check, if the same command was sent before; Apc1_Invoke
+    // does not poll in that case.
+    const uint16_t interval = apc1->timing.pollInterval     ? apc1->timing.pollInterval     : APC1_SYSTEM_TIMING_POLL_INTERVAL;
+    const uint16_t timeout  = apc1->timing.commandTimeout   ? apc1->timing.commandTimeout   : APC1_SYSTEM_TIMING_COMMAND_EXEC;
+    const uint32_t start    = Apc1_Millis(apc1);
+    uint16_t elapsed        = 0;
+    Result result;
+
+    do
+    {
+        wait(interval);
+        elapsed = Apc1_PollElapsed(apc1, start, elapsed, interval);
+
+        result = Apc1_Read(apc1, APC1_REGISTER_ADDRESS_COMMAND_RESULT, resultBuf, size);
+        if (result == RESULT_OK)
+        {
+            result = check(command, resultBuf, (Apc1_CommandResponse)size);
+        }
+    }
+    while (result != RESULT_OK && elapsed < timeout);
+
+    apc1->timing.commandReadyTime = elapsed;
+
+    return result;
+}
+
+static inline void Apc1_PollReset(ScioSense_Apc1* apc1, const uint16_t previousChecksum)
+{
+    // The device is ready, once it delivers a valid frame which was measured after the reset.
+    // That is either a frame with another checksum, or any valid frame after an invalid one.
+    const uint16_t interval = apc1->timing.pollInterval     ? apc1->timing.pollInterval     : APC1_SYSTEM_TIMING_POLL_INTERVAL;
+    const uint16_t timeout  = apc1->timing.resetTimeout     ? apc1->timing.resetTimeout     : APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+    const uint32_t start    = Apc1_Millis(apc1);
+    uint16_t elapsed        = 0;
+    bool sawInvalid         = (previousChecksum == 0);
+
+    do
+    {
+        wait(interval);
+        elapsed = Apc1_PollElapsed(apc1, start, elapsed, interval);
+
+        if
+        (
+            Apc1_Read(apc1, APC1_RESULT_ADDRESS_FRAME_HEADER, apc1->measurementData, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH) == RESULT_OK
+         && Apc1_CheckMeasurementData(apc1->measurementData) == RESULT_OK
+        )
+        {
+            if (sawInvalid || Apc1_GetValueOf16(apc1->measurementData, APC1_RESULT_ADDRESS_CHECKSUM_H) != previousChecksum)
+            {
+                break;
+            }
+        }
+        else
+        {
+            sawInvalid = true;
+        }
+    }
+    while (elapsed < timeout);
+
+    apc1->timing.resetReadyTime = elapsed;
+}
+
+static inline Result Apc1_Invoke(ScioSense_Apc1* apc1, Apc1_Command command, uint8_t* resultBuf, const size_t size, Apc1_ResponseCheck check)
 {
     Result result;
+    uint32_t start  = Apc1_Millis(apc1);
+    bool poll       = (apc1->io.protocol == APC1_PROTOCOL_I2C && apc1->timing.readinessPolling && resultBuf != NULL);
+
+    if
+    (
+        poll
+     && Apc1_Read(apc1, APC1_REGISTER_ADDRESS_COMMAND_RESULT, resultBuf, size) == RESULT_OK
+     && check(command, resultBuf, (Apc1_CommandResponse)size) == RESULT_OK
+    )
+    {
+        // the register holds a valid response to the same command already, so polling could not
+        // tell the new response from it; the fixed delay is used instead
+        poll = false;
+    }
 
     result = Apc1_Write(apc1, APC1_REGISTER_ADDRESS_COMMAND_WRITE, (uint8_t*)command, APC1_COMMAND_LENGTH);
 
     if (result == RESULT_OK)
     {
-        if (apc1->io.protocol == APC1_PROTOCOL_I2C)
+        if (poll)
         {
-            wait(APC1_SYSTEM_TIMING_COMMAND_EXEC);
+            result = Apc1_PollCommandResponse(apc1, command, resultBuf, size, check);
         }
-
-        if (resultBuf != NULL)
+        else
         {
-            result = Apc1_Read(apc1, APC1_REGISTER_ADDRESS_COMMAND_RESULT, resultBuf, size);
-            if (result == RESULT_OK)
+            // commands without a response keep the fixed delay, as there is nothing to poll for
+            if (apc1->io.protocol == APC1_PROTOCOL_I2C)
+            {
+                wait(APC1_SYSTEM_TIMING_COMMAND_EXEC);
+            }
+
+            if (resultBuf != NULL)
             {
-                result = Apc1_CheckCommandResponse(command, resultBuf, (Apc1_CommandResponse)size);
+                result = Apc1_Read(apc1, APC1_REGISTER_ADDRESS_COMMAND_RESULT, resultBuf, size);
+                if (result == RESULT_OK)
+                {
+                    result = check(command, resultBuf, (Apc1_CommandResponse)size);
+                }
             }
         }
     }
 
+    if (result != RESULT_OK)
+    {
+        addStat(commandErrors, 1);
+    }
+    Apc1_RecordLatency(apc1, apc1->stats.commandLatency, start);
+
     return result;
 }
 
@@ -97,7 +405,7 @@ static inline Result Apc1_InvokePassiveMeasurement(ScioSense_Apc1* apc1)
 {
     static const Apc1_Command command = APC1_COMMAND_PASSIVE_MEASUREMENT;
 
-    return Apc1_Invoke(apc1, command, NULL, 0);
+    return Apc1_Invoke(apc1, command, NULL, 0, NULL);
 }
 
 static inline Result Apc1_InvokeSetIdle(ScioSense_Apc1* apc1)
@@ -105,14 +413,14 @@ static inline Result Apc1_InvokeSetIdle(ScioSense_Apc1* apc1)
     static const Apc1_Command command = APC1_COMMAND_SET_IDLE;
     uint8_t buf[APC1_COMMAND_RESPONSE_DEFAULT_LENGTH];
 
-    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH);
+    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH, Apc1_CheckCommandResponse);
 }
 
 static inline Result Apc1_InvokeSetWake(ScioSense_Apc1* apc1)
 {
     static const Apc1_Command command = APC1_COMMAND_SET_WAKE;
 
-    return Apc1_Invoke(apc1, command, NULL, 0);
+    return Apc1_Invoke(apc1, command, NULL, 0, NULL);
 }
 
 static inline Result Apc1_InvokeSetMeasurementModeActive(ScioSense_Apc1* apc1)
@@ -120,7 +428,7 @@ static inline Result Apc1_InvokeSetMeasurementModeActive(ScioSense_Apc1* apc1)
     static const Apc1_Command command = APC1_COMMAND_SET_MEASUREMENT_MODE_ACTIVE;
     uint8_t buf[APC1_COMMAND_RESPONSE_DEFAULT_LENGTH];
 
-    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH);
+    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH, Apc1_CheckCommandResponse);
 }
 
 static inline Result Apc1_InvokeSetMeasurementModePassive(ScioSense_Apc1* apc1)
@@ -128,7 +436,7 @@ static inline Result Apc1_InvokeSetMeasurementModePassive(ScioSense_Apc1* apc1)
     static const Apc1_Command command = APC1_COMMAND_SET_MEASUREMENT_MODE_PASSIVE;
     uint8_t buf[APC1_COMMAND_RESPONSE_DEFAULT_LENGTH];
 
-    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH);
+    return Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_DEFAULT_LENGTH, Apc1_CheckCommandResponse);
 }
 
 static inline Result Apc1_InvokeReadSensorVersion(ScioSense_Apc1* apc1)
@@ -137,92 +445,348 @@ static inline Result Apc1_InvokeReadSensorVersion(ScioSense_Apc1* apc1)
     static const Apc1_Command command = APC1_COMMAND_READ_SENSOR_VERSION;
     uint8_t buf[APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH];
 
-    result = Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH);
-    if (buf[0] == APC1_COMMAND_ADDRESS_START_BYTE_1)
+    result = Apc1_Invoke(apc1, command, buf, APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH, Apc1_CheckSensorVersionResponse);
+    if (result == RESULT_OK)
     {
-        result = Apc1_CheckData(buf, APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH);
-        if (result == RESULT_OK)
-        {
-            memcpy(apc1->moduleName, (buf + APC1_RESULT_ADDRESS_SENSOR_TYPE), APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH);
-            apc1->moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH] = 0;
-            apc1->serialNumber  = Apc1_GetValueOf64(buf, APC1_RESULT_ADDRESS_SENSOR_UID);
-            apc1->fwVersion     = Apc1_GetValueOf16(buf, APC1_RESULT_ADDRESS_SENSOR_FIRMWARE_VERSION);
-        }
+        memcpy(apc1->moduleName, (buf + APC1_RESULT_ADDRESS_SENSOR_TYPE), APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH);
+        apc1->moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH] = 0;
+        apc1->serialNumber  = Apc1_GetValueOf64(buf, APC1_RESULT_ADDRESS_SENSOR_UID);
+        apc1->fwVersion     = Apc1_GetValueOf16(buf, APC1_RESULT_ADDRESS_SENSOR_FIRMWARE_VERSION);
     }
 
     return result;
 }
 
+static inline uint16_t Apc1_IdentityChecksum(const Apc1_Identity* identity)
+{
+    uint16_t checksum = APC1_IDENTITY_CHECKSUM_SEED;
+
+    for (uint8_t i = 0; i < APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH+1; i++)
+    {
+        checksum += identity->moduleName[i];
+    }
+
+    checksum += (uint8_t)(identity->fwVersion >> 8) + (uint8_t)identity->fwVersion;
+    for (uint8_t i = 0; i < 8; i++)
+    {
+        checksum += (uint8_t)(identity->serialNumber >> (i * 8));
+    }
+
+    return checksum;
+}
+
+static inline bool Apc1_LoadIdentity(ScioSense_Apc1* apc1)
+{
+    Apc1_Identity identity;
+
+    if (apc1->identityCache.load == NULL || !apc1->identityCache.load(apc1->identityCache.context, &identity))
+    {
+        return false;
+    }
+
+    if (identity.fwVersion == 0 || identity.checksum != Apc1_IdentityChecksum(&identity))
+    {
+        return false;
+    }
+
+    memcpy(apc1->moduleName, identity.moduleName, APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH);
+    apc1->moduleName[APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH] = 0;
+    apc1->serialNumber  = identity.serialNumber;
+    apc1->fwVersion     = identity.fwVersion;
+    apc1->identityState = APC1_IDENTITY_STATE_CACHED;
+
+    return true;
+}
+
+static inline void Apc1_StoreIdentity(ScioSense_Apc1* apc1)
+{
+    Apc1_Identity identity;
+
+    if (apc1->identityCache.store == NULL)
+    {
+        return;
+    }
+
+    memcpy(identity.moduleName, apc1->moduleName, APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH+1);
+    identity.serialNumber   = apc1->serialNumber;
+    identity.fwVersion      = apc1->fwVersion;
+    identity.checksum       = Apc1_IdentityChecksum(&identity);
+
+    apc1->identityCache.store(apc1->identityCache.context, &identity);
+}
+
+static inline void Apc1_ValidateIdentity(ScioSense_Apc1* apc1)
+{
+    // The measurement frame only carries the low byte of the firmware version, so a firmware
+    // which differs in the high byte only, or another device with the same firmware, passes.
+    // A mismatch is flagged only; reading the identity here would issue commands within an
+    // update (and overwrite the frame on UART with firmware < 34). The next Apc1_Reset reads it.
+    if ((uint8_t)apc1->fwVersion == apc1->measurementData[APC1_RESULT_ADDRESS_FIRMWARE_VERSION])
+    {
+        apc1->identityState = APC1_IDENTITY_STATE_VALIDATED;
+    }
+    else
+    {
+        apc1->identityState = APC1_IDENTITY_STATE_MISMATCH;
+    }
+}
+
 static inline Result Apc1_Reset(ScioSense_Apc1* apc1)
 {
     Result result;
+    bool cached;
+    const bool mismatch = (apc1->identityState == APC1_IDENTITY_STATE_MISMATCH);
 
     memset(apc1->moduleName     , 0, APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH+1);
     memset(apc1->measurementData, 0, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
 
     apc1->serialNumber  = 0;
     apc1->fwVersion     = 0;
+    apc1->identityState = APC1_IDENTITY_STATE_READ;
 
+    Apc1_ForgetFrame(apc1);
+    Apc1_ResetPhase(apc1);
     clear();
 
+    // after a mismatch the cache is stale; the identity is read from the device and stored again
+    cached = !mismatch && Apc1_LoadIdentity(apc1);
+
     if (apc1->io.protocol == APC1_PROTOCOL_UART)
     {
         result = Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD);
         if (result != RESULT_OK)
         {
             // retry
+            addStat(resetRetries, 1);
+            addStat(resyncs, 1);
             clear();
             Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD);
         }
 
-        Apc1_SetMeasurementMode(apc1, APC1_MEASUREMENT_MODE_PASSIVE);
-        result = Apc1_ReadSensorVersion(apc1);
+        result = Apc1_SetMeasurementMode(apc1, APC1_MEASUREMENT_MODE_PASSIVE);
+        if (!cached)
+        {
+            result = Apc1_ReadSensorVersion(apc1);
+        }
     }
     else
     {
         Apc1_Command reset = APC1_COMMAND_RESET;
-        Apc1_Invoke(apc1, reset, NULL, 0);
-        wait(APC1_SYSTEM_TIMING_STANDARD_MEASURE);
+
+        if (apc1->timing.readinessPolling)
+        {
+            uint8_t checksum[2];
+            uint16_t previousChecksum = 0;
+            if (Apc1_Read(apc1, APC1_RESULT_ADDRESS_CHECKSUM_H, checksum, 2) == RESULT_OK)
+            {
+                previousChecksum = Apc1_GetValueOf16(checksum, 0);
+            }
+
+            Apc1_Write(apc1, APC1_REGISTER_ADDRESS_COMMAND_WRITE, (uint8_t*)reset, APC1_COMMAND_LENGTH);
+            Apc1_PollReset(apc1, previousChecksum);
+            memset(apc1->measurementData, 0, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+        }
+        else
+        {
+            Apc1_Invoke(apc1, reset, NULL, 0, NULL);
+            wait(APC1_SYSTEM_TIMING_STANDARD_MEASURE);
+        }
+
         Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD);
         Apc1_SetMeasurementMode(apc1, APC1_MEASUREMENT_MODE_ACTIVE);
 
-        result = Apc1_ReadSensorVersion(apc1);
-        if (result != RESULT_OK)
+        if (cached)
+        {
+            // the device does not respond to the mode commands on i2c; check that it acknowledges a read
+            uint8_t header[2];
+            result = Apc1_Read(apc1, APC1_RESULT_ADDRESS_FRAME_HEADER, header, 2);
+        }
+        else
         {
-            //retry
-            wait(APC1_SYSTEM_TIMING_COMMAND_EXEC);
             result = Apc1_ReadSensorVersion(apc1);
+            if (result != RESULT_OK)
+            {
+                //retry
+                addStat(resetRetries, 1);
+                wait(APC1_SYSTEM_TIMING_COMMAND_EXEC);
+                result = Apc1_ReadSensorVersion(apc1);
+            }
+        }
+    }
+
+    if (!cached && result == RESULT_OK)
+    {
+        Apc1_StoreIdentity(apc1);
+    }
+
+    return result;
+}
+
+static inline Result Apc1_Realign(ScioSense_Apc1* apc1, const Result result)
+{
+    // The frame just read is invalid. If a frame header starts within it, the stream is misaligned
+    // (noise or the rest of an earlier frame came first): the candidate is moved to the front and
+    // completed with the missing bytes. At most APC1_UART_REALIGN_LIMIT bytes are skipped per call.
+    uint8_t* data       = apc1->measurementData;
+    size_t discarded    = 0;
+    size_t offset;
+
+    while (Apc1_FindMeasurementData(data, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH, &offset) == RESULT_INVALID)
+    {
+        // in passive mode, no data follows the requested frame; a candidate without the full
+        // header is most likely payload and reading on would only wait for the timeout
+        if
+        (
+            discarded + offset > APC1_UART_REALIGN_LIMIT
+         || (apc1->measurementMode == APC1_MEASUREMENT_MODE_PASSIVE && offset > APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH - APC1_COMMAND_RESPONSE_COMMAND_ADDRESS)
+        )
+        {
+            break;
+        }
+
+        for (size_t i = offset; i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH; i++)
+        {
+            data[i - offset] = data[i];
+        }
+        discarded += offset;
+        addStat(discardedBytes, (uint32_t)offset);
+
+        if (Apc1_Read(apc1, APC1_RESULT_ADDRESS_FRAME_HEADER, data + APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH - offset, offset) != RESULT_OK)
+        {
+            addStat(resyncs, 1);
+            return RESULT_IO_ERROR;
+        }
+
+        if (Apc1_CheckMeasurementData(data) == RESULT_OK)
+        {
+            addStat(resyncs, 1);
+            return RESULT_OK;
         }
     }
 
+    if (discarded > 0)
+    {
+        addStat(resyncs, 1);
+    }
+
+    return result;
+}
+
+static inline Result Apc1_Accept(ScioSense_Apc1* apc1, Result result, const uint32_t start)
+{
+    // the frame is in measurementData if the result is RESULT_OK; start is the time of the request
+    if (result == RESULT_OK || result == RESULT_NO_NEW_DATA)
+    {
+        const uint16_t crc  = Apc1_GetFrameCrc(apc1->measurementData);
+
+        // compensating byte changes keep the additive checksum, but not the CRC
+        if
+        (
+            result == RESULT_OK
+         && hasAnyFlag(apc1->updateOptions, APC1_UPDATE_OPTION_SUPPRESS_DUPLICATES | APC1_UPDATE_OPTION_PEEK_CHECKSUM)
+         && Apc1_GetValueOf16(apc1->measurementData, APC1_RESULT_ADDRESS_CHECKSUM_H) == apc1->frameChecksum
+         && crc == apc1->frameCrc
+        )
+        {
+            result = RESULT_NO_NEW_DATA;
+        }
+
+        Apc1_TrackPhase(apc1, start, Apc1_Millis(apc1), crc != apc1->frameCrc);
+        apc1->frameChecksum = Apc1_GetValueOf16(apc1->measurementData, APC1_RESULT_ADDRESS_CHECKSUM_H);
+        apc1->frameCrc      = crc;
+    }
+
+    if (result == RESULT_OK && apc1->identityState == APC1_IDENTITY_STATE_CACHED)
+    {
+        Apc1_ValidateIdentity(apc1);
+    }
+
+    Apc1_CountUpdateResult(apc1, result);
+    Apc1_RecordLatency(apc1, apc1->stats.updateLatency, start);
+
     return result;
 }
 
 static inline Result Apc1_Update(ScioSense_Apc1* apc1)
 {
     Result result;
+    uint32_t start;
 
     if (apc1->operatingMode != APC1_OPERATING_MODE_STANDARD)
     {
         return RESULT_NOT_ALLOWED;
     }
 
+    start   = Apc1_Millis(apc1);
+    result  = RESULT_OK;
+
     if (apc1->measurementMode == APC1_MEASUREMENT_MODE_PASSIVE)
     {
         result = Apc1_InvokePassiveMeasurement(apc1);
-        if (result != RESULT_OK)
+    }
+
+    // a pre-filter only; an equal checksum skips the frame read, so it accepts the collisions of the
+    // additive checksum for the 64 bytes it saves. Frames which are read are compared by their CRC
+    if
+    (
+        result == RESULT_OK
+     && apc1->frameChecksum != 0
+     && apc1->io.protocol == APC1_PROTOCOL_I2C
+     && hasFlag(apc1->updateOptions, APC1_UPDATE_OPTION_PEEK_CHECKSUM)
+    )
+    {
+        uint8_t checksum[2];
+        result = Apc1_Read(apc1, APC1_RESULT_ADDRESS_CHECKSUM_H, checksum, 2);
+        if (result == RESULT_OK && Apc1_GetValueOf16(checksum, 0) == apc1->frameChecksum)
         {
-            return result;
+            result = RESULT_NO_NEW_DATA;
         }
     }
 
-    result = Apc1_Read(apc1, APC1_RESULT_ADDRESS_FRAME_HEADER, apc1->measurementData, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
     if (result == RESULT_OK)
     {
-        result = Apc1_CheckMeasurementData(apc1->measurementData);
+        result = Apc1_Read(apc1, APC1_RESULT_ADDRESS_FRAME_HEADER, apc1->measurementData, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+        if (result == RESULT_OK)
+        {
+            result = Apc1_CheckMeasurementData(apc1->measurementData);
+        }
+
+        if (result != RESULT_OK && result != RESULT_IO_ERROR && apc1->io.protocol == APC1_PROTOCOL_UART)
+        {
+            result = Apc1_Realign(apc1, result);
+        }
     }
 
-    return result;
+    if (result != RESULT_OK && result != RESULT_NO_NEW_DATA)
+    {
+        // measurementData may hold the failed frame now; neither a checksum peek nor the duplicate
+        // check may match it against the last valid one
+        Apc1_ForgetFrame(apc1);
+    }
+
+    return Apc1_Accept(apc1, result, start);
+}
+
+static inline Result Apc1_Ingest(ScioSense_Apc1* apc1, const uint8_t* frame, const uint32_t requestTime)
+{
+    // an invalid frame keeps the previous measurement data
+    Result result = Apc1_CheckMeasurementData(frame);
+
+    if (result == RESULT_OK)
+    {
+        memcpy(apc1->measurementData, frame, APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH);
+    }
+
+    return Apc1_Accept(apc1, result, requestTime);
+}
+
+static inline void Apc1_ForgetFrame(ScioSense_Apc1* apc1)
+{
+    apc1->frameChecksum         = 0;
+    apc1->frameCrc              = 0;
+#ifndef APC1_NO_PHASE
+    apc1->phase.hasPrevious     = false;    // the phase tracker compares with frameCrc
+#endif
 }
 
 static inline Result Apc1_ReadSensorVersion(ScioSense_Apc1* apc1)
@@ -393,6 +957,54 @@ static inline float Apc1_GetRawRH(ScioSense_Apc1* apc1)
     return (float)Apc1_GetValueOf16(apc1->measurementData, APC1_RESULT_ADDRESS_RH_RAW) * 0.1f;
 }
 
+static inline uint32_t Apc1_GetFieldValue(const uint8_t* data, const Apc1_Field field)
+{
+    if (field <= APC1_FIELD_RH_RAW)
+    {
+        return Apc1_GetValueOf16(data, APC1_RESULT_ADDRESS_PM_1_0 + 2 * field);
+    }
+    else if (field <= APC1_FIELD_RS3)
+    {
+        return Apc1_GetValueOf32((uint8_t*)data, APC1_RESULT_ADDRESS_RS0 + 4 * (field - APC1_FIELD_RS0));
+    }
+    else if (field == APC1_FIELD_AQI)
+    {
+        return data[APC1_RESULT_ADDRESS_AQI];
+    }
+    else if (field == APC1_FIELD_ERROR_CODE)
+    {
+        return data[APC1_RESULT_ADDRESS_ERROR_CODE];
+    }
+
+    return 0;
+}
+
+static inline void Apc1_SetFieldValue(uint8_t* data, const Apc1_Field field, const uint32_t value)
+{
+    if (field <= APC1_FIELD_RH_RAW)
+    {
+        const uint8_t address = APC1_RESULT_ADDRESS_PM_1_0 + 2 * field;
+        data[address + 0] = (uint8_t)(value >> 8);
+        data[address + 1] = (uint8_t)value;
+    }
+    else if (field <= APC1_FIELD_RS3)
+    {
+        const uint8_t address = APC1_RESULT_ADDRESS_RS0 + 4 * (field - APC1_FIELD_RS0);
+        data[address + 0] = (uint8_t)(value >> 24);
+        data[address + 1] = (uint8_t)(value >> 16);
+        data[address + 2] = (uint8_t)(value >> 8);
+        data[address + 3] = (uint8_t)value;
+    }
+    else if (field == APC1_FIELD_AQI)
+    {
+        data[APC1_RESULT_ADDRESS_AQI] = (uint8_t)value;
+    }
+    else if (field == APC1_FIELD_ERROR_CODE)
+    {
+        data[APC1_RESULT_ADDRESS_ERROR_CODE] = (uint8_t)value;
+    }
+}
+
 static inline uint32_t Apc1_GetRS0(ScioSense_Apc1* apc1)
 {
     return Apc1_GetValueOf32(apc1->measurementData, APC1_RESULT_ADDRESS_RS0);
@@ -428,6 +1040,85 @@ static inline Apc1_ErrorCode Apc1_GetError(ScioSense_Apc1* apc1)
     return apc1->measurementData[APC1_RESULT_ADDRESS_ERROR_CODE];
 }
 
+static inline Apc1_IdentityState Apc1_GetIdentityState(ScioSense_Apc1* apc1)
+{
+    return apc1->identityState;
+}
+
+#ifndef APC1_NO_PHASE
+static inline uint32_t Apc1_GetSampleAge(ScioSense_Apc1* apc1)
+{
+    return apc1->phase.sampleAge;
+}
+
+static inline uint32_t Apc1_GetRequestDelay(ScioSense_Apc1* apc1)
+{
+    const Apc1_Phase* phase = &apc1->phase;
+    uint32_t now, target, offset, next;
+
+    if (apc1->io.millis == NULL || !phase->hasPrevious)
+    {
+        return 0;
+    }
+
+    now = apc1->io.millis();
+    if (phase->windowLength < APC1_PHASE_LOCK_WINDOW)
+    {
+        // right after the refresh about a period after the previous request
+        target = phase->windowStart + phase->windowLength + APC1_PHASE_REQUEST_MARGIN;
+        offset = Apc1_PhaseOffset(target, phase->lastRequest + APC1_SYSTEM_TIMING_STANDARD_MEASURE / 2);
+        next   = phase->lastRequest + APC1_SYSTEM_TIMING_STANDARD_MEASURE / 2 + offset;
+
+        return ((int32_t)(next - now) > 0) ? next - now : Apc1_PhaseOffset(target, now);
+    }
+
+    // Only a request less than a period after the previous one tells where the refresh is: probe the
+    // middle of the window, so the window halves with each request until the phase is known.
+    target = phase->windowStart + phase->windowLength / 2;
+    offset = Apc1_PhaseOffset(target, phase->lastRequest);
+    next   = phase->lastRequest + ((offset != 0) ? offset : APC1_SYSTEM_TIMING_STANDARD_MEASURE / 2);
+
+    return ((int32_t)(next - now) > 0) ? next - now : Apc1_PhaseOffset(target, now);
+}
+#else
+static inline uint32_t Apc1_GetSampleAge(ScioSense_Apc1* apc1)
+{
+    (void)apc1;
+    return APC1_SAMPLE_AGE_UNKNOWN;
+}
+
+static inline uint32_t Apc1_GetRequestDelay(ScioSense_Apc1* apc1)
+{
+    (void)apc1;
+    return 0;
+}
+#endif
+
+#ifndef APC1_NO_STATS
+static inline void Apc1_GetStats(ScioSense_Apc1* apc1, Apc1_Stats* snapshot)
+{
+    *snapshot = apc1->stats;
+}
+
+static inline void Apc1_ResetStats(ScioSense_Apc1* apc1)
+{
+    uint8_t* stats = (uint8_t*)&apc1->stats;
+    memset(stats, 0, sizeof(Apc1_Stats));
+}
+#else
+static inline void Apc1_GetStats(ScioSense_Apc1* apc1, Apc1_Stats* snapshot)
+{
+    uint8_t* stats = (uint8_t*)snapshot;
+    (void)apc1;
+    memset(stats, 0, sizeof(Apc1_Stats));
+}
+
+static inline void Apc1_ResetStats(ScioSense_Apc1* apc1)
+{
+    (void)apc1;
+}
+#endif
+
 static inline Result Apc1_CheckData(const uint8_t* data, const Apc1_CommandResponse size)
 {
     if (size < 3)
@@ -454,7 +1145,8 @@ static inline Result Apc1_CheckCommandResponse(const Apc1_Command command, const
 
     if
     (
-        command[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1] == data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]
+        size > APC1_COMMAND_RESPONSE_DATA_ADDRESS
+     && command[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1] == data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]
      && command[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2] == data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]
      && command[APC1_COMMAND_RESPONSE_COMMAND_ADDRESS]      == data[APC1_COMMAND_RESPONSE_COMMAND_ADDRESS]
      && command[APC1_COMMAND_RESPONSE_DATA_ADDRESS]         == data[APC1_COMMAND_RESPONSE_DATA_ADDRESS]
@@ -467,6 +1159,27 @@ static inline Result Apc1_CheckCommandResponse(const Apc1_Command command, const
     return result;
 }
 
+static inline Result Apc1_CheckSensorVersionResponse(const Apc1_Command command, const uint8_t* data, const Apc1_CommandResponse size)
+{
+    // the module name follows the frame length, where other responses echo the command
+    Result result = RESULT_INVALID;
+    (void)command;
+
+    if
+    (
+        APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH             == size
+     && APC1_COMMAND_ADDRESS_START_BYTE_1                       == data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]
+     && APC1_COMMAND_ADDRESS_START_BYTE_2                       == data[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]
+     && 0                                                       == data[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_H]
+     && APC1_COMMAND_RESPONSE_SENSOR_VERSION_PAYLOAD_LENGTH     == data[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]
+    )
+    {
+        result = Apc1_CheckData(data, size);
+    }
+
+    return result;
+}
+
 static inline Result Apc1_CheckMeasurementData(const uint8_t* data)
 {
     Result result = RESULT_INVALID;
@@ -496,6 +1209,50 @@ static inline Result Apc1_CheckMeasurementData(const uint8_t* data)
     return result;
 }
 
+static inline Result Apc1_FindMeasurementData(const uint8_t* data, const size_t size, size_t* offset)
+{
+    // Returns RESULT_OK and sets offset to the start of the first valid measurement frame in data.
+    // Otherwise, offset is set to the number of leading bytes which can not be the start of a valid frame;
+    // RESULT_INVALID means that a frame candidate at offset needs more data, RESULT_CHECKSUM_ERROR that there is none.
+    for (size_t i = 0; i < size; i++)
+    {
+        if (data[i] != APC1_COMMAND_ADDRESS_START_BYTE_1)
+        {
+            continue;
+        }
+
+        if (size - i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH)
+        {
+            // a candidate which is too short to be checked; discard it early, if its header does not match
+            if
+            (
+                (size - i > APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2      && data[i + APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]     != APC1_COMMAND_ADDRESS_START_BYTE_2)
+             || (size - i > APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_H    && data[i + APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_H]   != 0)
+             || (size - i > APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L    && data[i + APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]   != APC1_COMMAND_RESPONSE_MEASUREMENT_PAYLOAD_LENGTH)
+            )
+            {
+                continue;
+            }
+
+            *offset = i;
+            return RESULT_INVALID;
+        }
+
+        if
+        (
+            data[i + APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_H] == 0
+         && Apc1_CheckMeasurementData(data + i) == RESULT_OK
+        )
+        {
+            *offset = i;
+            return RESULT_OK;
+        }
+    }
+
+    *offset = size;
+    return RESULT_CHECKSUM_ERROR;
+}
+
 
 #undef wait
 #undef clear
@@ -503,5 +1260,14 @@ static inline Result Apc1_CheckMeasurementData(const uint8_t* data)
 #undef hasFlag
 #undef memset
 #undef memcpy
+#undef addStat
+#ifdef APC1_NO_STATS
+#undef Apc1_RecordLatency
+#undef Apc1_CountUpdateResult
+#endif
+#ifdef APC1_NO_PHASE
+#undef Apc1_ResetPhase
+#undef Apc1_TrackPhase
+#endif
 
 #endif // SCIOSENSE_APC1_C_INL
\ No newline at end of file
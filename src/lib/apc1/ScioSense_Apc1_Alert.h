@@ -0,0 +1,82 @@
+#ifndef SCIOSENSE_APC1_ALERT_C_H
+#define SCIOSENSE_APC1_ALERT_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Threshold alerts evaluated on every validated measurement frame
+//
+// Rules are a flat table, usually const, of up to APC1_ALERT_MAX_RULES entries. Each rule reads
+// one field straight from the measurement frame, so a frame is checked in one pass without
+// converting values. Thresholds are in the unit of the field in the frame (T/RH in 0.1).
+//
+//      APC1_ALERT_ABOVE    value > threshold;      clears at value <= threshold - hysteresis
+//      APC1_ALERT_BELOW    value < threshold;      clears at value >= threshold + hysteresis
+//      APC1_ALERT_RISE     value - previous value > threshold;  clears at <= threshold - hysteresis
+//      APC1_ALERT_FALL     previous value - value > threshold;  clears at <= threshold - hysteresis
+//      APC1_ALERT_ERROR    (error code & bits) != 0; clears when none of the bits are set
+//
+// A rule is raised after its condition held for `samples` frames in a row and cleared after its
+// clear condition held as often (debounce). Between both levels nothing changes. An event is
+// reported only when a rule changes its state, so a node can keep its radio off until then.
+
+#define APC1_ALERT_MAX_RULES            (32)
+
+typedef uint8_t Apc1_AlertKind;
+#define APC1_ALERT_KIND_ABOVE           (0)
+#define APC1_ALERT_KIND_BELOW           (1)
+#define APC1_ALERT_KIND_RISE            (2)
+#define APC1_ALERT_KIND_FALL            (3)
+#define APC1_ALERT_KIND_ERROR           (4)
+
+typedef struct Apc1_AlertRule
+{
+    Apc1_Field      field;
+    Apc1_AlertKind  kind;
+    uint8_t         raiseCount;                 // consecutive frames to raise; 0 is the same as 1
+    uint8_t         clearCount;                 // consecutive frames to clear; 0 is the same as 1
+    int32_t         threshold;                  // APC1_ALERT_KIND_ERROR: the Apc1_ErrorCode bits
+    int32_t         hysteresis;
+} Apc1_AlertRule;
+
+// initializers for the rule table
+#define APC1_ALERT_ABOVE(field, threshold, hysteresis, samples)     { (field), APC1_ALERT_KIND_ABOVE, (samples), (samples), (threshold), (hysteresis) }
+#define APC1_ALERT_BELOW(field, threshold, hysteresis, samples)     { (field), APC1_ALERT_KIND_BELOW, (samples), (samples), (threshold), (hysteresis) }
+#define APC1_ALERT_RISE(field, threshold, hysteresis, samples)      { (field), APC1_ALERT_KIND_RISE , (samples), (samples), (threshold), (hysteresis) }
+#define APC1_ALERT_FALL(field, threshold, hysteresis, samples)      { (field), APC1_ALERT_KIND_FALL , (samples), (samples), (threshold), (hysteresis) }
+#define APC1_ALERT_ERROR(bits, samples)                             { APC1_FIELD_ERROR_CODE, APC1_ALERT_KIND_ERROR, (samples), (samples), (bits), 0 }
+
+typedef struct Apc1_AlertState
+{
+    uint32_t        previous;                   // value of the previous frame; RISE and FALL only
+    uint8_t         count;                      // consecutive frames towards the next state change
+    bool            primed;                     // previous is set
+} Apc1_AlertState;
+
+typedef struct Apc1_AlertEvent
+{
+    uint8_t         rule;                       // index in the rule table
+    bool            active;                     // true: raised, false: cleared
+    Apc1_Field      field;
+    uint32_t        value;                      // value of the field in the frame which changed the state
+} Apc1_AlertEvent;
+
+typedef void (*Apc1_AlertCallback)(void* context, const Apc1_AlertEvent* event);
+
+typedef struct Apc1_AlertEngine
+{
+    const Apc1_AlertRule*   rules;
+    Apc1_AlertState*        states;                                         // one per rule
+    uint8_t                 ruleCount;
+    uint32_t                active;                                         // bit i is set while rule i is raised
+    uint32_t                changed;                                        // bit i is set if rule i changed its state in the last evaluation
+    Apc1_AlertCallback      onEvent;                                        // called for every state change; may be NULL
+    void*                   context;
+} Apc1_AlertEngine;
+
+static inline Result    Apc1_AlertEngine_Init       (Apc1_AlertEngine* engine, const Apc1_AlertRule* rules, Apc1_AlertState* states, const uint8_t ruleCount, Apc1_AlertCallback onEvent, void* context);  // checks the rules and clears all states; onEvent may be NULL; RESULT_INVALID for unknown fields or kinds, or too many rules
+static inline uint8_t   Apc1_AlertEngine_Evaluate   (Apc1_AlertEngine* engine, const uint8_t* measurementData);                                                                                            // evaluates all rules on a validated measurement frame; returns the number of state changes
+static inline void      Apc1_AlertEngine_Reset      (Apc1_AlertEngine* engine);                                                                                                                            // clears all rules without events
+static inline bool      Apc1_AlertEngine_IsActive   (const Apc1_AlertEngine* engine, const uint8_t rule);                                                                                                  // returns true, if the rule is raised
+
+#include "ScioSense_Apc1_Alert.inl.h"
+#endif // SCIOSENSE_APC1_ALERT_C_H
@@ -0,0 +1,141 @@
+#ifndef SCIOSENSE_APC1_ALERT_C_INL
+#define SCIOSENSE_APC1_ALERT_C_INL
+
+#include "ScioSense_Apc1_Alert.h"
+
+#define APC1_ALERT_CONDITION_CLEAR      (0)
+#define APC1_ALERT_CONDITION_RAISE      (1)
+#define APC1_ALERT_CONDITION_HOLD       (2)     // within the hysteresis; neither raises nor clears
+
+static inline Result Apc1_AlertEngine_Init(Apc1_AlertEngine* engine, const Apc1_AlertRule* rules, Apc1_AlertState* states, const uint8_t ruleCount, Apc1_AlertCallback onEvent, void* context)
+{
+    if (ruleCount > APC1_ALERT_MAX_RULES)
+    {
+        return RESULT_INVALID;
+    }
+
+    for (uint8_t i = 0; i < ruleCount; i++)
+    {
+        if (rules[i].field >= APC1_FIELD_COUNT || rules[i].kind > APC1_ALERT_KIND_ERROR)
+        {
+            return RESULT_INVALID;
+        }
+    }
+
+    engine->rules       = rules;
+    engine->states      = states;
+    engine->ruleCount   = ruleCount;
+    engine->onEvent     = onEvent;
+    engine->context     = context;
+    Apc1_AlertEngine_Reset(engine);
+
+    return RESULT_OK;
+}
+
+static inline void Apc1_AlertEngine_Reset(Apc1_AlertEngine* engine)
+{
+    for (uint8_t i = 0; i < engine->ruleCount; i++)
+    {
+        engine->states[i].previous  = 0;
+        engine->states[i].count     = 0;
+        engine->states[i].primed    = false;
+    }
+
+    engine->active  = 0;
+    engine->changed = 0;
+}
+
+static inline bool Apc1_AlertEngine_IsActive(const Apc1_AlertEngine* engine, const uint8_t rule)
+{
+    return rule < engine->ruleCount && (engine->active & (1UL << rule));
+}
+
+static inline uint8_t Apc1_AlertCondition(const Apc1_AlertRule* rule, Apc1_AlertState* state, const uint32_t value)
+{
+    // 64 bit, so RS values and deltas of any sign compare correctly with the signed thresholds
+    int64_t level;
+    int64_t threshold = rule->threshold;
+
+    switch (rule->kind)
+    {
+        case APC1_ALERT_KIND_ABOVE:
+            level = (int64_t)value;
+            break;
+
+        case APC1_ALERT_KIND_BELOW:
+            // mirrored, so the comparison below applies
+            level       = -(int64_t)value;
+            threshold   = -threshold;
+            break;
+
+        case APC1_ALERT_KIND_RISE:
+        case APC1_ALERT_KIND_FALL:
+            if (!state->primed)
+            {
+                state->previous = value;
+                state->primed   = true;
+                return APC1_ALERT_CONDITION_HOLD;
+            }
+            level           = (rule->kind == APC1_ALERT_KIND_RISE) ? (int64_t)value - state->previous : (int64_t)state->previous - value;
+            state->previous = value;
+            break;
+
+        default:
+            return (value & (uint32_t)rule->threshold) ? APC1_ALERT_CONDITION_RAISE : APC1_ALERT_CONDITION_CLEAR;
+    }
+
+    return (level > threshold) ? APC1_ALERT_CONDITION_RAISE : (level <= threshold - rule->hysteresis) ? APC1_ALERT_CONDITION_CLEAR : APC1_ALERT_CONDITION_HOLD;
+}
+
+static inline uint8_t Apc1_AlertEngine_Evaluate(Apc1_AlertEngine* engine, const uint8_t* measurementData)
+{
+    uint8_t events = 0;
+
+    engine->changed = 0;
+
+    for (uint8_t i = 0; i < engine->ruleCount; i++)
+    {
+        const Apc1_AlertRule* rule  = &engine->rules[i];
+        Apc1_AlertState* state      = &engine->states[i];
+        const uint32_t bit          = 1UL << i;
+        const bool active           = (engine->active & bit) != 0;
+        const uint32_t value        = Apc1_GetFieldValue(measurementData, rule->field);
+        const uint8_t condition     = Apc1_AlertCondition(rule, state, value);
+        const uint8_t required      = active ? rule->clearCount : rule->raiseCount;
+
+        // counts frames towards the other state; any other frame starts over
+        if (condition != (active ? APC1_ALERT_CONDITION_CLEAR : APC1_ALERT_CONDITION_RAISE))
+        {
+            state->count = 0;
+            continue;
+        }
+
+        if (++state->count < required)
+        {
+            continue;
+        }
+
+        state->count     = 0;
+        engine->active  ^= bit;
+        engine->changed |= bit;
+        events++;
+
+        if (engine->onEvent != NULL)
+        {
+            Apc1_AlertEvent event;
+            event.rule      = i;
+            event.active    = !active;
+            event.field     = rule->field;
+            event.value     = value;
+            engine->onEvent(engine->context, &event);
+        }
+    }
+
+    return events;
+}
+
+#undef APC1_ALERT_CONDITION_CLEAR
+#undef APC1_ALERT_CONDITION_RAISE
+#undef APC1_ALERT_CONDITION_HOLD
+
+#endif // SCIOSENSE_APC1_ALERT_C_INL
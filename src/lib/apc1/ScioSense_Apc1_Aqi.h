@@ -0,0 +1,99 @@
+#ifndef SCIOSENSE_APC1_AQI_C_H
+#define SCIOSENSE_APC1_AQI_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// PM based air quality indices: US EPA AQI, NowCast and EU CAQI
+//
+// Apc1_GetAQI returns the UBA class of TVOC which the device computes itself. Apc1_AqiEngine adds
+// the PM2.5 and PM10 indices, computed from validated frames with integer arithmetic only:
+//
+//      hourly      mean of the frames of each clock hour (timestamp / 3600)
+//      NowCast     EPA weighted mean of the last 12 hourly means; valid with 2 of the last 3 hours
+//      daily       mean of the last 24 hourly means; valid with at least 18 of them
+//
+//      usAqi       EPA AQI (2024 breakpoints) from the NowCast concentrations, as AirNow reports it
+//      usAqiDaily  EPA AQI from the daily means, as the regulatory index
+//      caqi        CAQI from the hourly means, hourly grid
+//      caqiDaily   CAQI from the daily means, daily grid
+//
+// Each index is the maximum of its PM2.5 and PM10 subindices. Concentrations are in 0.1 µg/m³,
+// truncated like the EPA does (PM2.5 to 0.1, PM10 to 1 µg/m³ before the AQI). The EPA AQI ends at
+// 500; CAQI continues above 100 with the slope of its last band.
+//
+// A frame adds to the open hour in O(1). Only when a frame starts a new hour, the closed hour is
+// stored and the indices are recomputed from the 24 stored hours, so the cost does not depend on
+// the frame rate. Hours without enough frames (minSamples) and gaps count as missing.
+
+#define APC1_AQI_HOURS                  (24)
+#define APC1_AQI_NOWCAST_HOURS          (12)
+#define APC1_AQI_DAILY_MIN_HOURS        (18)        // 75 % of 24 h
+#define APC1_AQI_NONE                   (0xFFFF)    // concentration or index not available
+#define APC1_AQI_US_MAX                 (500)
+
+typedef uint8_t Apc1_AqiCategory;
+#define APC1_AQI_CATEGORY_UNKNOWN       (0)
+#define APC1_AQI_CATEGORY_1             (1)         // EPA: good;                               CAQI: very low
+#define APC1_AQI_CATEGORY_2             (2)         // EPA: moderate;                           CAQI: low
+#define APC1_AQI_CATEGORY_3             (3)         // EPA: unhealthy for sensitive groups;     CAQI: medium
+#define APC1_AQI_CATEGORY_4             (4)         // EPA: unhealthy;                          CAQI: high
+#define APC1_AQI_CATEGORY_5             (5)         // EPA: very unhealthy;                     CAQI: very high
+#define APC1_AQI_CATEGORY_6             (6)         // EPA: hazardous
+
+typedef struct Apc1_AqiBreakpoint
+{
+    uint16_t    low;                        // 0.1 µg/m³
+    uint16_t    high;                       // 0.1 µg/m³; the next band starts at high or high + 1
+    uint16_t    indexLow;
+    uint16_t    indexHigh;
+} Apc1_AqiBreakpoint;
+
+typedef struct Apc1_AqiConfig
+{
+    Apc1_Field  pm25Field;                  // APC1_FIELD_PMINAIR_2_5 or APC1_FIELD_PM_2_5
+    Apc1_Field  pm10Field;                  // APC1_FIELD_PMINAIR_10 or APC1_FIELD_PM_10
+    uint16_t    minSamples;                 // frames an hour needs to count
+} Apc1_AqiConfig;
+
+typedef struct Apc1_AqiHour
+{
+    uint16_t    pm25;                       // 0.1 µg/m³; APC1_AQI_NONE if missing
+    uint16_t    pm10;
+} Apc1_AqiHour;
+
+typedef struct Apc1_AqiIndices
+{
+    uint32_t    hour;                       // timestamp / 3600 of the last closed hour
+    Apc1_AqiHour hourly;                    // mean of the last closed hour
+    Apc1_AqiHour nowcast;
+    Apc1_AqiHour daily;
+    uint16_t    usAqi;                      // APC1_AQI_NONE if not available
+    uint16_t    usAqiDaily;
+    uint16_t    caqi;
+    uint16_t    caqiDaily;
+} Apc1_AqiIndices;
+
+typedef struct Apc1_AqiEngine
+{
+    Apc1_AqiConfig  config;
+    uint32_t        hour;                                   // timestamp / 3600 of the open hour
+    uint32_t        sum25;                                  // µg/m³ over the frames of the open hour
+    uint32_t        sum10;
+    uint16_t        samples;                                // frames in the open hour
+    uint8_t         head;                                   // index of the last closed hour in hours
+    bool            started;
+    Apc1_AqiHour    hours[APC1_AQI_HOURS];                  // hourly means, a ring
+    Apc1_AqiIndices indices;
+} Apc1_AqiEngine;
+
+static inline void              Apc1_Aqi_DefaultConfig  (Apc1_AqiConfig* config);                                                          // atmospheric PM fields, 45 frames per hour (75 % at one frame per minute)
+static inline void              Apc1_Aqi_Init           (Apc1_AqiEngine* engine, const Apc1_AqiConfig* config);                            // starts with all hours missing
+static inline Result            Apc1_Aqi_Add            (Apc1_AqiEngine* engine, const uint32_t timestamp, const uint8_t* measurementData); // adds a validated frame; timestamp in s; RESULT_OK if an hour closed and the indices changed, RESULT_NO_NEW_DATA if not, RESULT_INVALID for a timestamp before the open hour
+static inline uint16_t          Apc1_Aqi_NowCast        (const uint16_t* hours, const uint8_t count);                                      // NowCast of count hourly concentrations, the latest first; APC1_AQI_NONE for missing ones
+static inline uint16_t          Apc1_Aqi_UsEpa          (const uint16_t pm25, const uint16_t pm10);                                        // EPA AQI of concentrations in 0.1 µg/m³; APC1_AQI_NONE values are ignored
+static inline uint16_t          Apc1_Aqi_Caqi           (const uint16_t pm25, const uint16_t pm10, const bool daily);                      // CAQI of concentrations in 0.1 µg/m³, hourly or daily grid; APC1_AQI_NONE values are ignored
+static inline Apc1_AqiCategory  Apc1_Aqi_UsCategory     (const uint16_t index);                                                            // EPA category of an AQI
+static inline Apc1_AqiCategory  Apc1_Aqi_CaqiCategory   (const uint16_t index);                                                            // CAQI level of an index
+
+#include "ScioSense_Apc1_Aqi.inl.h"
+#endif // SCIOSENSE_APC1_AQI_C_H
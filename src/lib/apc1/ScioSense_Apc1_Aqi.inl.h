@@ -0,0 +1,308 @@
+#ifndef SCIOSENSE_APC1_AQI_C_INL
+#define SCIOSENSE_APC1_AQI_C_INL
+
+#include "ScioSense_Apc1_Aqi.h"
+
+// concentration bands in 0.1 µg/m³ and their index ranges
+#define APC1_AQI_US_PM25        { {    0,   90,   0,  50 }, {   91,  354,  51, 100 }, {  355,  554, 101, 150 }, \
+                                  {  555, 1254, 151, 200 }, { 1255, 2254, 201, 300 }, { 2255, 3254, 301, 500 } }
+#define APC1_AQI_US_PM10        { {    0,  540,   0,  50 }, {  550, 1540,  51, 100 }, { 1550, 2540, 101, 150 }, \
+                                  { 2550, 3540, 151, 200 }, { 3550, 4240, 201, 300 }, { 4250, 6040, 301, 500 } }
+#define APC1_AQI_CAQI_PM25      { {    0,  150,   0,  25 }, {  150,  300,  25,  50 }, {  300,  550,  50,  75 }, {  550, 1100,  75, 100 } }
+#define APC1_AQI_CAQI_PM10      { {    0,  250,   0,  25 }, {  250,  500,  25,  50 }, {  500,  900,  50,  75 }, {  900, 1800,  75, 100 } }
+#define APC1_AQI_CAQI_DAILY_PM25 { {   0,  100,   0,  25 }, {  100,  200,  25,  50 }, {  200,  300,  50,  75 }, {  300,  600,  75, 100 } }
+#define APC1_AQI_CAQI_DAILY_PM10 { {   0,  150,   0,  25 }, {  150,  300,  25,  50 }, {  300,  500,  50,  75 }, {  500, 1000,  75, 100 } }
+
+#define APC1_AQI_WEIGHT_ONE     (4096)      // NowCast weights in Q12, so 12 weighted hours fit 32 bits
+
+static inline void Apc1_Aqi_DefaultConfig(Apc1_AqiConfig* config)
+{
+    config->pm25Field   = APC1_FIELD_PMINAIR_2_5;
+    config->pm10Field   = APC1_FIELD_PMINAIR_10;
+    config->minSamples  = 45;
+}
+
+static inline void Apc1_Aqi_Init(Apc1_AqiEngine* engine, const Apc1_AqiConfig* config)
+{
+    engine->config  = *config;
+    engine->hour    = 0;
+    engine->sum25   = 0;
+    engine->sum10   = 0;
+    engine->samples = 0;
+    engine->head    = 0;
+    engine->started = false;
+
+    for (uint8_t i = 0; i < APC1_AQI_HOURS; i++)
+    {
+        engine->hours[i].pm25 = APC1_AQI_NONE;
+        engine->hours[i].pm10 = APC1_AQI_NONE;
+    }
+
+    engine->indices.hour            = 0;
+    engine->indices.hourly          = engine->hours[0];
+    engine->indices.nowcast         = engine->hours[0];
+    engine->indices.daily           = engine->hours[0];
+    engine->indices.usAqi           = APC1_AQI_NONE;
+    engine->indices.usAqiDaily      = APC1_AQI_NONE;
+    engine->indices.caqi            = APC1_AQI_NONE;
+    engine->indices.caqiDaily       = APC1_AQI_NONE;
+}
+
+static inline uint16_t Apc1_Aqi_Interpolate(const Apc1_AqiBreakpoint* table, const uint8_t rows, const uint16_t concentration)
+{
+    const Apc1_AqiBreakpoint* band = &table[rows - 1];      // above the last band, its slope continues
+
+    for (uint8_t i = 0; i < rows; i++)
+    {
+        if (concentration <= table[i].high)
+        {
+            band = &table[i];
+            break;
+        }
+    }
+
+    {
+        const uint32_t span     = band->high - band->low;
+        const uint32_t range    = band->indexHigh - band->indexLow;
+        const uint32_t index    = band->indexLow + (range * (uint32_t)(concentration - band->low) * 2 + span) / (2 * span);
+
+        return (index < APC1_AQI_NONE) ? (uint16_t)index : APC1_AQI_NONE - 1;
+    }
+}
+
+static inline uint16_t Apc1_Aqi_Max(const uint16_t a, const uint16_t b)
+{
+    // APC1_AQI_NONE is the largest value, so it has to be excluded
+    if (a == APC1_AQI_NONE)
+    {
+        return b;
+    }
+    if (b == APC1_AQI_NONE)
+    {
+        return a;
+    }
+
+    return (a > b) ? a : b;
+}
+
+static inline uint16_t Apc1_Aqi_UsEpa(const uint16_t pm25, const uint16_t pm10)
+{
+    static const Apc1_AqiBreakpoint bandsPm25[6] = APC1_AQI_US_PM25;
+    static const Apc1_AqiBreakpoint bandsPm10[6] = APC1_AQI_US_PM10;
+    uint16_t index25 = APC1_AQI_NONE;
+    uint16_t index10 = APC1_AQI_NONE;
+
+    if (pm25 != APC1_AQI_NONE)
+    {
+        index25 = Apc1_Aqi_Interpolate(bandsPm25, 6, pm25);
+        index25 = (index25 < APC1_AQI_US_MAX) ? index25 : APC1_AQI_US_MAX;
+    }
+    if (pm10 != APC1_AQI_NONE)
+    {
+        // PM10 is truncated to 1 µg/m³
+        index10 = Apc1_Aqi_Interpolate(bandsPm10, 6, (uint16_t)(pm10 - pm10 % 10));
+        index10 = (index10 < APC1_AQI_US_MAX) ? index10 : APC1_AQI_US_MAX;
+    }
+
+    return Apc1_Aqi_Max(index25, index10);
+}
+
+static inline uint16_t Apc1_Aqi_Caqi(const uint16_t pm25, const uint16_t pm10, const bool daily)
+{
+    static const Apc1_AqiBreakpoint hourlyPm25[4]   = APC1_AQI_CAQI_PM25;
+    static const Apc1_AqiBreakpoint hourlyPm10[4]   = APC1_AQI_CAQI_PM10;
+    static const Apc1_AqiBreakpoint dailyPm25[4]    = APC1_AQI_CAQI_DAILY_PM25;
+    static const Apc1_AqiBreakpoint dailyPm10[4]    = APC1_AQI_CAQI_DAILY_PM10;
+    const uint16_t index25 = (pm25 != APC1_AQI_NONE) ? Apc1_Aqi_Interpolate(daily ? dailyPm25 : hourlyPm25, 4, pm25) : APC1_AQI_NONE;
+    const uint16_t index10 = (pm10 != APC1_AQI_NONE) ? Apc1_Aqi_Interpolate(daily ? dailyPm10 : hourlyPm10, 4, pm10) : APC1_AQI_NONE;
+
+    return Apc1_Aqi_Max(index25, index10);
+}
+
+static inline Apc1_AqiCategory Apc1_Aqi_UsCategory(const uint16_t index)
+{
+    static const uint16_t upper[5] = { 50, 100, 150, 200, 300 };
+    Apc1_AqiCategory category = APC1_AQI_CATEGORY_1;
+
+    if (index == APC1_AQI_NONE)
+    {
+        return APC1_AQI_CATEGORY_UNKNOWN;
+    }
+
+    while (category <= 5 && index > upper[category - 1])
+    {
+        category++;
+    }
+
+    return category;
+}
+
+static inline Apc1_AqiCategory Apc1_Aqi_CaqiCategory(const uint16_t index)
+{
+    if (index == APC1_AQI_NONE)
+    {
+        return APC1_AQI_CATEGORY_UNKNOWN;
+    }
+
+    // 0-25, 25-50, 50-75, 75-100, > 100; a boundary belongs to the lower level
+    return (index > 100) ? APC1_AQI_CATEGORY_5 : (Apc1_AqiCategory)(APC1_AQI_CATEGORY_1 + ((index > 0) ? (index - 1) / 25 : 0));
+}
+
+static inline uint16_t Apc1_Aqi_NowCast(const uint16_t* hours, const uint8_t count)
+{
+    const uint8_t n = (count < APC1_AQI_NOWCAST_HOURS) ? count : APC1_AQI_NOWCAST_HOURS;
+    uint16_t min    = APC1_AQI_NONE;
+    uint16_t max    = 0;
+    uint8_t recent  = 0;
+    uint32_t weight;
+    uint32_t factor = APC1_AQI_WEIGHT_ONE;
+    uint32_t sum    = 0;
+    uint32_t weights = 0;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (hours[i] == APC1_AQI_NONE)
+        {
+            continue;
+        }
+
+        min     = (hours[i] < min) ? hours[i] : min;
+        max     = (hours[i] > max) ? hours[i] : max;
+        recent += (i < 3) ? 1 : 0;
+    }
+
+    if (recent < 2)
+    {
+        return APC1_AQI_NONE;
+    }
+    if (max == 0)
+    {
+        return 0;
+    }
+
+    // w = min / max, at least 1/2; hour i weighs w^i, also if hours before it are missing
+    weight = ((uint32_t)min * APC1_AQI_WEIGHT_ONE) / max;
+    weight = (weight > APC1_AQI_WEIGHT_ONE / 2) ? weight : APC1_AQI_WEIGHT_ONE / 2;
+
+    for (uint8_t i = 0; i < n; i++)
+    {
+        if (hours[i] != APC1_AQI_NONE)
+        {
+            sum     += factor * hours[i];
+            weights += factor;
+        }
+        factor = (factor * weight + APC1_AQI_WEIGHT_ONE / 2) / APC1_AQI_WEIGHT_ONE;
+    }
+
+    // truncated to 0.1 µg/m³
+    return (uint16_t)(sum / weights);
+}
+
+static inline uint16_t Apc1_Aqi_Mean(const uint32_t sum, const uint16_t samples)
+{
+    // µg/m³ -> 0.1 µg/m³, truncated, without overflowing sum * 10
+    const uint32_t mean = (sum / samples) * 10 + ((sum % samples) * 10) / samples;
+
+    return (mean < APC1_AQI_NONE) ? (uint16_t)mean : APC1_AQI_NONE - 1;
+}
+
+static inline void Apc1_Aqi_Store(Apc1_AqiEngine* engine, const uint16_t pm25, const uint16_t pm10)
+{
+    engine->head                    = (uint8_t)((engine->head + 1) % APC1_AQI_HOURS);
+    engine->hours[engine->head].pm25 = pm25;
+    engine->hours[engine->head].pm10 = pm10;
+}
+
+static inline void Apc1_Aqi_Compute(Apc1_AqiEngine* engine)
+{
+    Apc1_AqiIndices* indices = &engine->indices;
+    uint16_t recent25[APC1_AQI_NOWCAST_HOURS];
+    uint16_t recent10[APC1_AQI_NOWCAST_HOURS];
+    uint32_t sum25      = 0;
+    uint32_t sum10      = 0;
+    uint8_t valid25     = 0;
+    uint8_t valid10     = 0;
+
+    for (uint8_t i = 0; i < APC1_AQI_HOURS; i++)
+    {
+        const Apc1_AqiHour* hour = &engine->hours[(engine->head + APC1_AQI_HOURS - i) % APC1_AQI_HOURS];
+
+        if (i < APC1_AQI_NOWCAST_HOURS)
+        {
+            recent25[i] = hour->pm25;
+            recent10[i] = hour->pm10;
+        }
+        if (hour->pm25 != APC1_AQI_NONE)
+        {
+            sum25 += hour->pm25;
+            valid25++;
+        }
+        if (hour->pm10 != APC1_AQI_NONE)
+        {
+            sum10 += hour->pm10;
+            valid10++;
+        }
+    }
+
+    indices->hourly         = engine->hours[engine->head];
+    indices->nowcast.pm25   = Apc1_Aqi_NowCast(recent25, APC1_AQI_NOWCAST_HOURS);
+    indices->nowcast.pm10   = Apc1_Aqi_NowCast(recent10, APC1_AQI_NOWCAST_HOURS);
+    indices->daily.pm25     = (valid25 >= APC1_AQI_DAILY_MIN_HOURS) ? (uint16_t)(sum25 / valid25) : APC1_AQI_NONE;
+    indices->daily.pm10     = (valid10 >= APC1_AQI_DAILY_MIN_HOURS) ? (uint16_t)(sum10 / valid10) : APC1_AQI_NONE;
+    indices->usAqi          = Apc1_Aqi_UsEpa(indices->nowcast.pm25, indices->nowcast.pm10);
+    indices->usAqiDaily     = Apc1_Aqi_UsEpa(indices->daily.pm25, indices->daily.pm10);
+    indices->caqi           = Apc1_Aqi_Caqi(indices->hourly.pm25, indices->hourly.pm10, false);
+    indices->caqiDaily      = Apc1_Aqi_Caqi(indices->daily.pm25, indices->daily.pm10, true);
+}
+
+static inline Result Apc1_Aqi_Add(Apc1_AqiEngine* engine, const uint32_t timestamp, const uint8_t* measurementData)
+{
+    const uint32_t hour = timestamp / 3600;
+    Result result       = RESULT_NO_NEW_DATA;
+
+    if (!engine->started)
+    {
+        engine->started = true;
+        engine->hour    = hour;
+    }
+    else if (hour < engine->hour)
+    {
+        return RESULT_INVALID;
+    }
+    else if (hour != engine->hour)
+    {
+        const bool enough   = engine->samples >= engine->config.minSamples;
+        const uint32_t gap  = hour - engine->hour - 1;
+
+        Apc1_Aqi_Store(engine,
+            enough ? Apc1_Aqi_Mean(engine->sum25, engine->samples) : APC1_AQI_NONE,
+            enough ? Apc1_Aqi_Mean(engine->sum10, engine->samples) : APC1_AQI_NONE);
+
+        // hours without frames are missing; more than a day of them clears all
+        for (uint32_t i = 0; i < gap && i < APC1_AQI_HOURS; i++)
+        {
+            Apc1_Aqi_Store(engine, APC1_AQI_NONE, APC1_AQI_NONE);
+        }
+
+        engine->indices.hour    = hour - 1;
+        engine->hour            = hour;
+        engine->sum25           = 0;
+        engine->sum10           = 0;
+        engine->samples         = 0;
+        Apc1_Aqi_Compute(engine);
+        result = RESULT_OK;
+    }
+
+    if (engine->samples < 0xFFFF)
+    {
+        engine->sum25 += Apc1_GetFieldValue(measurementData, engine->config.pm25Field);
+        engine->sum10 += Apc1_GetFieldValue(measurementData, engine->config.pm10Field);
+        engine->samples++;
+    }
+
+    return result;
+}
+
+#undef APC1_AQI_WEIGHT_ONE
+
+#endif // SCIOSENSE_APC1_AQI_C_INL
@@ -0,0 +1,76 @@
+#ifndef SCIOSENSE_APC1_BASELINE_C_H
+#define SCIOSENSE_APC1_BASELINE_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Streaming baseline tracking and drift compensation of the gas sensor resistances RS0 - RS3
+//
+// The MOX resistances fall with reducing gases, but also with humidity and temperature, and their
+// clean air level drifts over weeks. Apc1_Baseline keeps per channel, in constant memory:
+//
+//      compensated     ln(RS) - temperatureCoefficient * (T - referenceT) - humidityCoefficient * (RH - referenceRH),
+//                      with the compensated T/RH of the frame
+//      fast            the compensated value, low pass filtered with tauFast against noise
+//      baseline        the clean air level of fast: it rises towards higher values with tauRise and
+//                      falls towards lower values with tauDrift only, so gas events of hours barely
+//                      move it while a drift over days is followed
+//      ratio           exp(fast - baseline) = RS / RS(clean air); 1 in clean air, lower with gas
+//
+// The ratios are ready once the baselines have learned for `warmup` seconds. The baselines survive
+// reboots through the optional store callbacks: they are written every storeInterval seconds and
+// by Apc1_Baseline_Save, and loaded by Apc1_Baseline_Init. A stored state older than maxAge at the
+// first frame is dropped and the baselines learn from scratch. Times are in s.
+
+#define APC1_BASELINE_CHANNELS          (4)         // RS0 ... RS3
+
+typedef struct Apc1_BaselineConfig
+{
+    uint32_t    tauFast;                                        // noise filter, e.g. 60 s
+    uint32_t    tauRise;                                        // baseline towards cleaner air, e.g. 10 min
+    uint32_t    tauDrift;                                       // baseline towards lower resistance, e.g. 3 days
+    uint32_t    warmup;                                         // learning time before the ratios are ready
+    uint32_t    storeInterval;                                  // 0: store with Apc1_Baseline_Save only
+    uint32_t    maxAge;                                         // a stored state older than this is dropped
+    float       referenceT;                                     // °C
+    float       referenceRH;                                    // %
+    float       temperatureCoefficient[APC1_BASELINE_CHANNELS]; // d ln(RS) / d °C
+    float       humidityCoefficient[APC1_BASELINE_CHANNELS];    // d ln(RS) / d %RH
+} Apc1_BaselineConfig;
+
+typedef struct Apc1_BaselineState
+{
+    uint32_t    timestamp;                                      // of the last frame
+    uint32_t    learned;                                        // s of frames the baselines have seen
+    float       baseline[APC1_BASELINE_CHANNELS];               // ln(RS / 100 kOhm) of clean air, compensated
+    uint16_t    checksum;                                       // set and verified by the library; persist it with the state
+} Apc1_BaselineState;
+
+typedef struct Apc1_BaselineStore
+{
+    bool    (*load)     (void* context, Apc1_BaselineState* state);         // returns true, if a state was loaded from persistent memory
+    void    (*store)    (void* context, const Apc1_BaselineState* state);   // writes the state to persistent memory (NVS, EEPROM, file)
+    void*   context;
+} Apc1_BaselineStore;
+
+typedef struct Apc1_Baseline
+{
+    Apc1_BaselineConfig config;
+    Apc1_BaselineStore  store;
+    Apc1_BaselineState  state;
+    float               fast[APC1_BASELINE_CHANNELS];           // compensated ln(RS), filtered
+    float               ratio[APC1_BASELINE_CHANNELS];          // RS / RS(clean air); 1 until the first frame
+    uint32_t            stored;                                 // timestamp of the last store
+    uint32_t            elapsed;                                // s since the last baseline step
+    bool                loaded;                                 // state holds a loaded state, not yet checked at the first frame
+    bool                started;                                // a frame was added since Apc1_Baseline_Init
+} Apc1_Baseline;
+
+static inline void      Apc1_Baseline_DefaultConfig (Apc1_BaselineConfig* config);                                                 // 1 min / 10 min / 3 days, 1 h warmup, stores every 6 h, 7 days max age, typical SnO2 T/RH coefficients
+static inline bool      Apc1_Baseline_Init          (Apc1_Baseline* baseline, const Apc1_BaselineConfig* config, const Apc1_BaselineStore* store); // store may be NULL; returns true, if a stored state was loaded
+static inline Result    Apc1_Baseline_Add           (Apc1_Baseline* baseline, const uint32_t timestamp, const uint8_t* measurementData);  // adds a validated frame; RESULT_INVALID for a zero resistance or a timestamp before the last one
+static inline void      Apc1_Baseline_Save          (Apc1_Baseline* baseline);                                                      // stores the state now
+static inline bool      Apc1_Baseline_IsReady       (const Apc1_Baseline* baseline);                                                // returns true, once the baselines have learned for warmup seconds
+static inline float     Apc1_Baseline_GetRatio      (const Apc1_Baseline* baseline, const uint8_t channel);                         // returns RS / RS(clean air) of a channel; 1 in clean air
+
+#include "ScioSense_Apc1_Baseline.inl.h"
+#endif // SCIOSENSE_APC1_BASELINE_C_H
@@ -0,0 +1,207 @@
+#ifndef SCIOSENSE_APC1_BASELINE_C_INL
+#define SCIOSENSE_APC1_BASELINE_C_INL
+
+#include <math.h>
+
+#include "ScioSense_Apc1_Baseline.h"
+
+// ln(RS) is kept relative to 100 kOhm, so the float values stay small and the slow baseline steps
+// are not lost in rounding; for the same reason the baselines are updated once per step only
+#define APC1_BASELINE_SCALE             (1e-5f)
+#define APC1_BASELINE_STEP              (60)
+#define APC1_BASELINE_CHECKSUM_SEED     (0x5A)
+
+static inline void Apc1_Baseline_DefaultConfig(Apc1_BaselineConfig* config)
+{
+    config->tauFast         = 60;
+    config->tauRise         = 600;
+    config->tauDrift        = 3 * 86400;
+    config->warmup          = 3600;
+    config->storeInterval   = 6 * 3600;
+    config->maxAge          = 7 * 86400;
+    config->referenceT      = 25.0f;
+    config->referenceRH     = 50.0f;
+
+    for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+    {
+        config->temperatureCoefficient[channel] = -0.02f;
+        config->humidityCoefficient[channel]    = -0.01f;
+    }
+}
+
+static inline uint16_t Apc1_Baseline_Checksum(const Apc1_BaselineState* state)
+{
+    const uint8_t* bytes    = (const uint8_t*)state->baseline;
+    uint16_t checksum       = APC1_BASELINE_CHECKSUM_SEED;
+
+    for (uint8_t i = 0; i < 4; i++)
+    {
+        checksum += (uint8_t)(state->timestamp >> (i * 8)) + (uint8_t)(state->learned >> (i * 8));
+    }
+    for (uint8_t i = 0; i < sizeof(state->baseline); i++)
+    {
+        checksum += bytes[i];
+    }
+
+    return checksum;
+}
+
+static inline bool Apc1_Baseline_Init(Apc1_Baseline* baseline, const Apc1_BaselineConfig* config, const Apc1_BaselineStore* store)
+{
+    baseline->config    = *config;
+    baseline->stored    = 0;
+    baseline->elapsed   = 0;
+    baseline->loaded    = false;
+    baseline->started   = false;
+
+    baseline->store.load    = NULL;
+    baseline->store.store   = NULL;
+    baseline->store.context = NULL;
+    if (store != NULL)
+    {
+        baseline->store = *store;
+    }
+
+    baseline->state.timestamp   = 0;
+    baseline->state.learned     = 0;
+    for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+    {
+        baseline->state.baseline[channel]   = 0.0f;
+        baseline->fast[channel]             = 0.0f;
+        baseline->ratio[channel]            = 1.0f;
+    }
+
+    if (baseline->store.load != NULL && baseline->store.load(baseline->store.context, &baseline->state))
+    {
+        baseline->loaded = (baseline->state.checksum == Apc1_Baseline_Checksum(&baseline->state));
+    }
+    if (!baseline->loaded)
+    {
+        baseline->state.timestamp   = 0;
+        baseline->state.learned     = 0;
+    }
+
+    return baseline->loaded;
+}
+
+static inline void Apc1_Baseline_Save(Apc1_Baseline* baseline)
+{
+    baseline->stored = baseline->state.timestamp;
+
+    if (baseline->store.store == NULL)
+    {
+        return;
+    }
+
+    baseline->state.checksum = Apc1_Baseline_Checksum(&baseline->state);
+    baseline->store.store(baseline->store.context, &baseline->state);
+}
+
+static inline bool Apc1_Baseline_IsReady(const Apc1_Baseline* baseline)
+{
+    return baseline->started && baseline->state.learned >= baseline->config.warmup;
+}
+
+static inline float Apc1_Baseline_GetRatio(const Apc1_Baseline* baseline, const uint8_t channel)
+{
+    return (channel < APC1_BASELINE_CHANNELS) ? baseline->ratio[channel] : 1.0f;
+}
+
+static inline float Apc1_Baseline_Alpha(const uint32_t dt, const uint32_t tau)
+{
+    return (float)dt / (float)(tau + dt);
+}
+
+static inline Result Apc1_Baseline_Add(Apc1_Baseline* baseline, const uint32_t timestamp, const uint8_t* measurementData)
+{
+    const Apc1_BaselineConfig* config   = &baseline->config;
+    Apc1_BaselineState* state           = &baseline->state;
+    const float t                       = (float)(int16_t)Apc1_GetFieldValue(measurementData, APC1_FIELD_T_COMP) * 0.1f;
+    const float rh                      = (float)Apc1_GetFieldValue(measurementData, APC1_FIELD_RH_COMP) * 0.1f;
+    float compensated[APC1_BASELINE_CHANNELS];
+    uint32_t dt = 0;
+
+    if (baseline->started && (int32_t)(timestamp - state->timestamp) < 0)
+    {
+        return RESULT_INVALID;
+    }
+
+    for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+    {
+        const uint32_t rs = Apc1_GetFieldValue(measurementData, APC1_FIELD_RS0 + channel);
+        if (rs == 0)
+        {
+            return RESULT_INVALID;
+        }
+
+        compensated[channel] = logf((float)rs * APC1_BASELINE_SCALE)
+                             - config->temperatureCoefficient[channel] * (t - config->referenceT)
+                             - config->humidityCoefficient[channel] * (rh - config->referenceRH);
+    }
+
+    if (!baseline->started)
+    {
+        // a stored state is used, if it is recent; otherwise the baselines start at the first frame
+        const bool recent = baseline->loaded
+                         && (int32_t)(timestamp - state->timestamp) >= 0
+                         && timestamp - state->timestamp <= config->maxAge;
+
+        for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+        {
+            baseline->fast[channel] = compensated[channel];
+            if (!recent)
+            {
+                state->baseline[channel] = compensated[channel];
+            }
+        }
+
+        state->learned      = recent ? state->learned : 0;
+        baseline->started   = true;
+        baseline->loaded    = false;
+        baseline->stored    = timestamp;
+    }
+    else
+    {
+        // a gap counts as one filter time constant at most
+        dt = timestamp - state->timestamp;
+        dt = (dt < config->tauFast) ? dt : config->tauFast;
+    }
+
+    baseline->elapsed  += dt;
+    state->learned      = (state->learned < UINT32_MAX - dt) ? state->learned + dt : UINT32_MAX;
+    state->timestamp    = timestamp;
+
+    for (uint8_t channel = 0; channel < APC1_BASELINE_CHANNELS; channel++)
+    {
+        float* fast         = &baseline->fast[channel];
+        float* clean        = &state->baseline[channel];
+
+        *fast += (compensated[channel] - *fast) * Apc1_Baseline_Alpha(dt, config->tauFast);
+
+        if (baseline->elapsed >= APC1_BASELINE_STEP)
+        {
+            const uint32_t tau = (*fast > *clean) ? config->tauRise : config->tauDrift;
+            *clean += (*fast - *clean) * Apc1_Baseline_Alpha(baseline->elapsed, tau);
+        }
+
+        baseline->ratio[channel] = expf(*fast - *clean);
+    }
+
+    if (baseline->elapsed >= APC1_BASELINE_STEP)
+    {
+        baseline->elapsed = 0;
+    }
+
+    if (config->storeInterval > 0 && timestamp - baseline->stored >= config->storeInterval)
+    {
+        Apc1_Baseline_Save(baseline);
+    }
+
+    return RESULT_OK;
+}
+
+#undef APC1_BASELINE_SCALE
+#undef APC1_BASELINE_STEP
+#undef APC1_BASELINE_CHECKSUM_SEED
+
+#endif // SCIOSENSE_APC1_BASELINE_C_INL
@@ -0,0 +1,54 @@
+#ifndef SCIOSENSE_APC1_BINARY_C_H
+#define SCIOSENSE_APC1_BINARY_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Binary uplink encodings of a measurement frame with the module identity
+//
+// CBOR (RFC 8949): a map with integer keys. Negative keys hold the metadata, keys >= 0 are the
+// Apc1_Field of a value (unscaled, as in the measurement frame). Every integer takes the shortest
+// CBOR form, so small readings take 2 bytes per field including the key. The error code is always
+// written.
+//
+//      -1  schema version              -3  firmware version
+//      -2  serial number               -4  timestamp (only if not 0)
+//
+// Packed: fixed layout of APC1_BINARY_PACKED_SIZE bytes, big endian like the measurement frame.
+// It fits the smallest LoRaWAN payload of 51 bytes (EU868, DR0 to DR2).
+//
+//       0  u8      schema version      30  u16     TVOC
+//       1  u64     serial number       32  u16     eCO2
+//       9  u16     firmware version    34  u16     T comp   (0.1 °C)
+//      11  u8      error code          36  u16     RH comp  (0.1 %)
+//      12  u16[3]  PM1.0, PM2.5, PM10  38  u8      AQI
+//      18  u16[6]  particles >0.3..>10 39  u24[4]  RS0..RS3 (saturated at 0xFFFFFF)
+//
+// Decoders must reject schema versions they do not know; new fields get a new version.
+
+#define APC1_BINARY_SCHEMA_VERSION      (1)
+#define APC1_BINARY_PACKED_SIZE         (51)
+#define APC1_BINARY_LORA_PAYLOAD_SIZE   (51)    // max application payload of LoRaWAN EU868 at DR0..DR2
+#define APC1_BINARY_CBOR_BUFFER_SIZE    (160)   // fits all fields and a timestamp
+
+#define APC1_CBOR_KEY_SCHEMA            (-1)
+#define APC1_CBOR_KEY_SERIAL_NUMBER     (-2)
+#define APC1_CBOR_KEY_FW_VERSION        (-3)
+#define APC1_CBOR_KEY_TIMESTAMP         (-4)
+
+// PM, TVOC, eCO2, compensated T/RH and AQI; with the identity about 45 bytes of CBOR, within APC1_BINARY_LORA_PAYLOAD_SIZE
+#define APC1_BINARY_DEFAULT_FIELD_MASK  ( APC1_FIELD_MASK(APC1_FIELD_PM_1_0)  | APC1_FIELD_MASK(APC1_FIELD_PM_2_5)   | APC1_FIELD_MASK(APC1_FIELD_PM_10)   \
+                                        | APC1_FIELD_MASK(APC1_FIELD_TVOC)    | APC1_FIELD_MASK(APC1_FIELD_ECO2)                                        \
+                                        | APC1_FIELD_MASK(APC1_FIELD_T_COMP)  | APC1_FIELD_MASK(APC1_FIELD_RH_COMP)  | APC1_FIELD_MASK(APC1_FIELD_AQI) )
+
+// the fields of the packed layout
+#define APC1_BINARY_PACKED_FIELD_MASK   ( APC1_BINARY_DEFAULT_FIELD_MASK              | APC1_FIELD_MASK(APC1_FIELD_ERROR_CODE)                                                      \
+                                        | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_0_3) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_0_5) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_1_0) \
+                                        | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_2_5) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_5_0) | APC1_FIELD_MASK(APC1_FIELD_NOPARTICLES_10)  \
+                                        | APC1_FIELD_MASK(APC1_FIELD_RS0)             | APC1_FIELD_MASK(APC1_FIELD_RS1)             | APC1_FIELD_MASK(APC1_FIELD_RS2)             \
+                                        | APC1_FIELD_MASK(APC1_FIELD_RS3) )
+
+static inline size_t    Apc1_EncodeCbor     (ScioSense_Apc1* apc1, const uint32_t fieldMask, const uint64_t timestamp, uint8_t* buffer, const size_t size);    // writes the latest measurement and the identity as a CBOR map; returns its length, 0 if the buffer is too small
+static inline size_t    Apc1_EncodePacked   (ScioSense_Apc1* apc1, uint8_t* buffer, const size_t size);                                                        // writes the latest measurement and the identity in the packed layout; returns APC1_BINARY_PACKED_SIZE, 0 if the buffer is too small
+
+#include "ScioSense_Apc1_Binary.inl.h"
+#endif // SCIOSENSE_APC1_BINARY_C_H
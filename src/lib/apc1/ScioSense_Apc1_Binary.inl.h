@@ -0,0 +1,146 @@
+#ifndef SCIOSENSE_APC1_BINARY_C_INL
+#define SCIOSENSE_APC1_BINARY_C_INL
+
+#include "ScioSense_Apc1_Binary.h"
+
+#define APC1_CBOR_MAJOR_UNSIGNED        (0x00)
+#define APC1_CBOR_MAJOR_NEGATIVE        (0x20)
+#define APC1_CBOR_MAJOR_MAP             (0xA0)
+
+static inline uint8_t Apc1_CborSize(const uint64_t value)
+{
+    return (value < 24) ? 1 : (value <= 0xFF) ? 2 : (value <= 0xFFFF) ? 3 : (value <= 0xFFFFFFFF) ? 5 : 9;
+}
+
+static inline uint8_t* Apc1_CborPut(uint8_t* data, const uint8_t major, const uint64_t value)
+{
+    const uint8_t size = Apc1_CborSize(value);
+
+    if (size == 1)
+    {
+        *data++ = major | (uint8_t)value;
+        return data;
+    }
+
+    // additional information 24, 25, 26, 27 for 1, 2, 4, 8 following bytes
+    *data++ = major | (uint8_t)((size == 2) ? 24 : (size == 3) ? 25 : (size == 5) ? 26 : 27);
+    for (uint8_t i = size - 1; i > 0; i--)
+    {
+        *data++ = (uint8_t)(value >> ((i - 1) * 8));
+    }
+
+    return data;
+}
+
+static inline uint8_t* Apc1_CborPutKey(uint8_t* data, const int8_t key)
+{
+    return (key < 0) ? Apc1_CborPut(data, APC1_CBOR_MAJOR_NEGATIVE, (uint64_t)(-1 - key)) : Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, (uint64_t)key);
+}
+
+static inline size_t Apc1_EncodeCbor(ScioSense_Apc1* apc1, const uint32_t fieldMask, const uint64_t timestamp, uint8_t* buffer, const size_t size)
+{
+    const uint32_t mask = (fieldMask & APC1_FIELD_MASK_ALL) | APC1_FIELD_MASK(APC1_FIELD_ERROR_CODE);
+    uint32_t values[APC1_FIELD_COUNT];
+    uint8_t entries = 3;
+    size_t length   = 1 + Apc1_CborSize(APC1_BINARY_SCHEMA_VERSION) + 1 + Apc1_CborSize(apc1->serialNumber) + 1 + Apc1_CborSize(apc1->fwVersion);
+
+    // sizes first, so the buffer is checked once; the map header follows from the entries
+    if (timestamp)
+    {
+        entries++;
+        length += 1 + Apc1_CborSize(timestamp);
+    }
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (mask & APC1_FIELD_MASK(field))
+        {
+            values[field]   = Apc1_GetFieldValue(apc1->measurementData, field);
+            length         += Apc1_CborSize(field) + Apc1_CborSize(values[field]);
+            entries++;
+        }
+    }
+    length += Apc1_CborSize(entries);
+
+    if (length > size)
+    {
+        return 0;
+    }
+
+    uint8_t* data = buffer;
+    data = Apc1_CborPut(data, APC1_CBOR_MAJOR_MAP, entries);    // 2 bytes from 24 entries on
+    data = Apc1_CborPutKey(data, APC1_CBOR_KEY_SCHEMA);
+    data = Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, APC1_BINARY_SCHEMA_VERSION);
+    data = Apc1_CborPutKey(data, APC1_CBOR_KEY_SERIAL_NUMBER);
+    data = Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, apc1->serialNumber);
+    data = Apc1_CborPutKey(data, APC1_CBOR_KEY_FW_VERSION);
+    data = Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, apc1->fwVersion);
+    if (timestamp)
+    {
+        data = Apc1_CborPutKey(data, APC1_CBOR_KEY_TIMESTAMP);
+        data = Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, timestamp);
+    }
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (mask & APC1_FIELD_MASK(field))
+        {
+            data = Apc1_CborPutKey(data, (int8_t)field);
+            data = Apc1_CborPut(data, APC1_CBOR_MAJOR_UNSIGNED, values[field]);
+        }
+    }
+
+    return (size_t)(data - buffer);
+}
+
+static inline uint8_t* Apc1_BinaryPut(uint8_t* data, const uint64_t value, const uint8_t size)
+{
+    for (uint8_t i = size; i > 0; i--)
+    {
+        *data++ = (uint8_t)(value >> ((i - 1) * 8));
+    }
+
+    return data;
+}
+
+static inline size_t Apc1_EncodePacked(ScioSense_Apc1* apc1, uint8_t* buffer, const size_t size)
+{
+    const uint8_t* frame = apc1->measurementData;
+    uint8_t* data = buffer;
+
+    if (size < APC1_BINARY_PACKED_SIZE)
+    {
+        return 0;
+    }
+
+    data = Apc1_BinaryPut(data, APC1_BINARY_SCHEMA_VERSION, 1);
+    data = Apc1_BinaryPut(data, apc1->serialNumber, 8);
+    data = Apc1_BinaryPut(data, apc1->fwVersion, 2);
+    data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, APC1_FIELD_ERROR_CODE), 1);
+
+    for (Apc1_Field field = APC1_FIELD_PM_1_0; field <= APC1_FIELD_PM_10; field++)
+    {
+        data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, field), 2);
+    }
+    for (Apc1_Field field = APC1_FIELD_NOPARTICLES_0_3; field <= APC1_FIELD_ECO2; field++)
+    {
+        data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, field), 2);
+    }
+    data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, APC1_FIELD_T_COMP), 2);
+    data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, APC1_FIELD_RH_COMP), 2);
+    data = Apc1_BinaryPut(data, Apc1_GetFieldValue(frame, APC1_FIELD_AQI), 1);
+
+    for (Apc1_Field field = APC1_FIELD_RS0; field <= APC1_FIELD_RS3; field++)
+    {
+        const uint32_t rs = Apc1_GetFieldValue(frame, field);
+        data = Apc1_BinaryPut(data, (rs > 0xFFFFFF) ? 0xFFFFFF : rs, 3);
+    }
+
+    return (size_t)(data - buffer);
+}
+
+#undef APC1_CBOR_MAJOR_UNSIGNED
+#undef APC1_CBOR_MAJOR_NEGATIVE
+#undef APC1_CBOR_MAJOR_MAP
+
+#endif // SCIOSENSE_APC1_BINARY_C_INL
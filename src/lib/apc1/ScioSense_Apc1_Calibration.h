@@ -0,0 +1,84 @@
+#ifndef SCIOSENSE_APC1_CALIBRATION_C_H
+#define SCIOSENSE_APC1_CALIBRATION_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Per sensor calibration and humidity correction of the PM outputs
+//
+// Apc1_Calibration_Apply corrects the six PM fields of a validated frame once; the frame keeps the
+// raw values, the results go to an Apc1_CorrectedPM. Two steps are applied:
+//
+//      calibration     piecewise linear per size (PM1.0, PM2.5, PM10; the same for PM and PM in air):
+//                      the last segment with from <= raw applies: raw * gain / 4096 + offset
+//      humidity        hygroscopic growth (kappa-Koehler): value / (1 + kappa / 1.65 * RH / (100 - RH)),
+//                      with the compensated RH of the frame, capped at rhLimit
+//
+// A linear correction is a single segment from 0. The coefficients are a compact table of integers
+// (80 bytes), so it can be stored in flash or EEPROM per unit. The humidity step is computed in one
+// of three ways:
+//
+//      FLOAT       float arithmetic; for MCUs with an FPU
+//      FIXED       Q12 integer arithmetic with two 32 bit divisions
+//      LUT         Q12 factors every 5 % RH up to 80 % and every 1 % above, computed by
+//                  Apc1_Calibration_Init and interpolated; no division per frame
+//
+// Apc1_Calibration_ApplyBatch corrects the frames of many sensors at once, each with its own
+// calibrator, e.g. on a gateway. Code which reads its fields from a frame, like alert rules, AQI
+// and serializers, gets the corrected values from a copy of the frame passed to
+// Apc1_Calibration_Correct.
+
+#define APC1_CALIBRATION_SIZES          (3)         // PM1.0, PM2.5, PM10
+#define APC1_CALIBRATION_MAX_SEGMENTS   (4)
+#define APC1_CALIBRATION_GAIN_ONE       (4096)      // gain 1.0 in Q12
+#define APC1_CALIBRATION_RH_STEP        (50)        // LUT: 5 % in 0.1 % ...
+#define APC1_CALIBRATION_RH_KNEE        (800)       // ... up to 80 % ...
+#define APC1_CALIBRATION_RH_FINE_STEP   (10)        // ... and 1 % above, where the growth is steep
+#define APC1_CALIBRATION_RH_POINTS      (APC1_CALIBRATION_RH_KNEE / APC1_CALIBRATION_RH_STEP + (1000 - APC1_CALIBRATION_RH_KNEE) / APC1_CALIBRATION_RH_FINE_STEP + 1)
+#define APC1_CALIBRATION_PM_FIELDS      (6)         // APC1_FIELD_PM_1_0 ... APC1_FIELD_PMINAIR_10
+
+typedef uint8_t Apc1_CalibrationMethod;
+#define APC1_CALIBRATION_METHOD_FLOAT   (0)
+#define APC1_CALIBRATION_METHOD_FIXED   (1)
+#define APC1_CALIBRATION_METHOD_LUT     (2)
+
+typedef struct Apc1_CalibrationSegment
+{
+    uint16_t    from;                       // raw µg/m³ from which on the segment applies
+    uint16_t    gain;                       // Q12
+    int16_t     offset;                     // 0.1 µg/m³
+} Apc1_CalibrationSegment;
+
+typedef struct Apc1_CalibrationTable
+{
+    uint8_t                 segmentCount[APC1_CALIBRATION_SIZES];                               // 0: no calibration for this size
+    uint8_t                 reserved;
+    uint16_t                kappa;                                                              // hygroscopicity * 1000, e.g. 400; 0: no humidity correction
+    uint16_t                rhLimit;                                                            // 0.1 %; RH above is treated as rhLimit, at most 990
+    Apc1_CalibrationSegment segments[APC1_CALIBRATION_SIZES][APC1_CALIBRATION_MAX_SEGMENTS];   // ascending from per size
+} Apc1_CalibrationTable;
+
+// initializer of the segments of one size: a single segment from 0, i.e. linear
+#define APC1_CALIBRATION_LINEAR(gain, offset)   { { 0, (uint16_t)((gain) * APC1_CALIBRATION_GAIN_ONE + 0.5), (int16_t)(offset) } }
+
+typedef struct Apc1_Calibrator
+{
+    const Apc1_CalibrationTable*    table;
+    Apc1_CalibrationMethod          method;
+    uint32_t                        kappa;                                  // kappa / 1.65 in Q12
+    uint16_t                        factors[APC1_CALIBRATION_RH_POINTS];    // LUT: Q12 humidity factors at the RH steps
+} Apc1_Calibrator;
+
+typedef struct Apc1_CorrectedPM
+{
+    uint16_t    values[APC1_CALIBRATION_PM_FIELDS];     // 0.1 µg/m³, in the order of the fields
+    uint16_t    rh;                                     // 0.1 %; the RH used for the humidity correction
+} Apc1_CorrectedPM;
+
+static inline Result    Apc1_Calibration_Init       (Apc1_Calibrator* calibrator, const Apc1_CalibrationTable* table, const Apc1_CalibrationMethod method);                           // checks the table and prepares the method; RESULT_INVALID for too many or unordered segments, an RH limit above 990 or an unknown method
+static inline void      Apc1_Calibration_Apply      (const Apc1_Calibrator* calibrator, const uint8_t* measurementData, Apc1_CorrectedPM* corrected);                                 // corrects the PM fields of a validated frame
+static inline void      Apc1_Calibration_ApplyBatch (const Apc1_Calibrator* const* calibrators, const uint8_t* const* frames, const size_t count, Apc1_CorrectedPM* corrected);     // corrects count frames, frame i with calibrator i
+static inline void      Apc1_Calibration_Correct    (const Apc1_CorrectedPM* corrected, uint8_t* measurementData);                                                                     // writes the corrected PM fields, rounded to µg/m³, to a copy of the frame they were computed from and updates its checksum
+static inline float     Apc1_Calibration_ToFloat    (const Apc1_CorrectedPM* corrected, const Apc1_Field field);                                                                      // returns the corrected value of a PM field in µg/m³; 0 for other fields
+
+#include "ScioSense_Apc1_Calibration.inl.h"
+#endif // SCIOSENSE_APC1_CALIBRATION_C_H
@@ -0,0 +1,189 @@
+#ifndef SCIOSENSE_APC1_CALIBRATION_C_INL
+#define SCIOSENSE_APC1_CALIBRATION_C_INL
+
+#include "ScioSense_Apc1_Calibration.h"
+
+#define APC1_CALIBRATION_RH_MAX         (990)
+#define APC1_CALIBRATION_KOEHLER        (1650)      // kappa * 1000 / 1.65 for kappa in 1/1000
+
+// Q12 factor 1 / (1 + k * RH / (1000 - RH)); k in Q12, RH in 0.1 % up to APC1_CALIBRATION_RH_MAX
+static inline uint16_t Apc1_Calibration_Factor(const uint32_t kappa, const uint16_t rh)
+{
+    const uint32_t growth = (kappa * rh) / (1000 - rh);
+
+    return (uint16_t)(((uint32_t)APC1_CALIBRATION_GAIN_ONE * APC1_CALIBRATION_GAIN_ONE) / (APC1_CALIBRATION_GAIN_ONE + growth));
+}
+
+static inline Result Apc1_Calibration_Init(Apc1_Calibrator* calibrator, const Apc1_CalibrationTable* table, const Apc1_CalibrationMethod method)
+{
+    if (method > APC1_CALIBRATION_METHOD_LUT || table->rhLimit > APC1_CALIBRATION_RH_MAX)
+    {
+        return RESULT_INVALID;
+    }
+
+    for (uint8_t size = 0; size < APC1_CALIBRATION_SIZES; size++)
+    {
+        if (table->segmentCount[size] > APC1_CALIBRATION_MAX_SEGMENTS)
+        {
+            return RESULT_INVALID;
+        }
+        for (uint8_t i = 1; i < table->segmentCount[size]; i++)
+        {
+            if (table->segments[size][i].from <= table->segments[size][i - 1].from)
+            {
+                return RESULT_INVALID;
+            }
+        }
+    }
+
+    calibrator->table   = table;
+    calibrator->method  = method;
+    calibrator->kappa   = ((uint32_t)table->kappa * APC1_CALIBRATION_GAIN_ONE + APC1_CALIBRATION_KOEHLER / 2) / APC1_CALIBRATION_KOEHLER;
+
+    for (uint8_t i = 0; i < APC1_CALIBRATION_RH_POINTS; i++)
+    {
+        const uint8_t coarse    = APC1_CALIBRATION_RH_KNEE / APC1_CALIBRATION_RH_STEP;
+        const uint16_t rh       = (i < coarse) ? (uint16_t)(i * APC1_CALIBRATION_RH_STEP) : (uint16_t)(APC1_CALIBRATION_RH_KNEE + (i - coarse) * APC1_CALIBRATION_RH_FINE_STEP);
+        calibrator->factors[i]  = Apc1_Calibration_Factor(calibrator->kappa, (rh < table->rhLimit) ? rh : table->rhLimit);
+    }
+
+    return RESULT_OK;
+}
+
+static inline const Apc1_CalibrationSegment* Apc1_Calibration_Segment(const Apc1_CalibrationTable* table, const uint8_t size, const uint16_t raw)
+{
+    const Apc1_CalibrationSegment* segment = NULL;
+
+    for (uint8_t i = 0; i < table->segmentCount[size] && table->segments[size][i].from <= raw; i++)
+    {
+        segment = &table->segments[size][i];
+    }
+
+    return segment;
+}
+
+static inline uint16_t Apc1_Calibration_Clamp(const int32_t value)
+{
+    return (value < 0) ? 0 : (value > 0xFFFF) ? 0xFFFF : (uint16_t)value;
+}
+
+static inline void Apc1_Calibration_ApplyFloat(const Apc1_Calibrator* calibrator, const uint8_t* measurementData, Apc1_CorrectedPM* corrected)
+{
+    const Apc1_CalibrationTable* table  = calibrator->table;
+    const float rh                      = (float)corrected->rh;
+    const float factor                  = 1.0f / (1.0f + (float)table->kappa / (float)APC1_CALIBRATION_KOEHLER * rh / (1000.0f - rh));
+
+    for (Apc1_Field field = 0; field < APC1_CALIBRATION_PM_FIELDS; field++)
+    {
+        const uint16_t raw                      = (uint16_t)Apc1_GetFieldValue(measurementData, field);
+        const Apc1_CalibrationSegment* segment  = Apc1_Calibration_Segment(table, field % APC1_CALIBRATION_SIZES, raw);
+        float value                             = 10.0f * (float)raw;
+
+        if (segment != NULL)
+        {
+            value = value * (float)segment->gain / (float)APC1_CALIBRATION_GAIN_ONE + (float)segment->offset;
+        }
+
+        corrected->values[field] = Apc1_Calibration_Clamp((int32_t)(value * factor + 0.5f));
+    }
+}
+
+static inline void Apc1_Calibration_ApplyFixed(const Apc1_Calibrator* calibrator, const uint8_t* measurementData, Apc1_CorrectedPM* corrected, const uint32_t factor)
+{
+    const Apc1_CalibrationTable* table = calibrator->table;
+
+    for (Apc1_Field field = 0; field < APC1_CALIBRATION_PM_FIELDS; field++)
+    {
+        const uint16_t raw                      = (uint16_t)Apc1_GetFieldValue(measurementData, field);
+        const Apc1_CalibrationSegment* segment  = Apc1_Calibration_Segment(table, field % APC1_CALIBRATION_SIZES, raw);
+        int32_t value                           = 10 * (int32_t)raw;
+
+        if (segment != NULL)
+        {
+            // raw * gain fits 32 bits; its fraction is kept to 0.1 µg/m³
+            const uint32_t scaled = (uint32_t)raw * segment->gain;
+            value = (int32_t)((scaled / APC1_CALIBRATION_GAIN_ONE) * 10 + ((scaled % APC1_CALIBRATION_GAIN_ONE) * 10 + APC1_CALIBRATION_GAIN_ONE / 2) / APC1_CALIBRATION_GAIN_ONE) + segment->offset;
+        }
+
+        // clamped first, so the product with the Q12 factor fits 32 bits
+        corrected->values[field] = (uint16_t)(((uint32_t)Apc1_Calibration_Clamp(value) * factor + APC1_CALIBRATION_GAIN_ONE / 2) / APC1_CALIBRATION_GAIN_ONE);
+    }
+}
+
+static inline void Apc1_Calibration_Apply(const Apc1_Calibrator* calibrator, const uint8_t* measurementData, Apc1_CorrectedPM* corrected)
+{
+    const uint16_t measured = (uint16_t)Apc1_GetFieldValue(measurementData, APC1_FIELD_RH_COMP);
+    const uint16_t rh       = (measured < calibrator->table->rhLimit) ? measured : calibrator->table->rhLimit;
+    uint32_t factor;
+
+    corrected->rh = rh;
+
+    switch (calibrator->method)
+    {
+        case APC1_CALIBRATION_METHOD_FLOAT:
+            Apc1_Calibration_ApplyFloat(calibrator, measurementData, corrected);
+            return;
+
+        case APC1_CALIBRATION_METHOD_FIXED:
+            factor = Apc1_Calibration_Factor(calibrator->kappa, rh);
+            break;
+
+        default:
+        {
+            // the factors fall with RH; interpolated as low - (low - high) * fraction
+            uint8_t i;
+            uint32_t fraction;  // Q8
+
+            if (rh < APC1_CALIBRATION_RH_KNEE)
+            {
+                i           = (uint8_t)(rh / APC1_CALIBRATION_RH_STEP);
+                fraction    = ((uint32_t)(rh % APC1_CALIBRATION_RH_STEP) << 8) / APC1_CALIBRATION_RH_STEP;
+            }
+            else
+            {
+                i           = (uint8_t)(APC1_CALIBRATION_RH_KNEE / APC1_CALIBRATION_RH_STEP + (rh - APC1_CALIBRATION_RH_KNEE) / APC1_CALIBRATION_RH_FINE_STEP);
+                fraction    = ((uint32_t)((rh - APC1_CALIBRATION_RH_KNEE) % APC1_CALIBRATION_RH_FINE_STEP) << 8) / APC1_CALIBRATION_RH_FINE_STEP;
+            }
+
+            factor = calibrator->factors[i] - (((uint32_t)(calibrator->factors[i] - calibrator->factors[i + 1]) * fraction + 128) >> 8);
+            break;
+        }
+    }
+
+    Apc1_Calibration_ApplyFixed(calibrator, measurementData, corrected, factor);
+}
+
+static inline void Apc1_Calibration_ApplyBatch(const Apc1_Calibrator* const* calibrators, const uint8_t* const* frames, const size_t count, Apc1_CorrectedPM* corrected)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        Apc1_Calibration_Apply(calibrators[i], frames[i], &corrected[i]);
+    }
+}
+
+static inline void Apc1_Calibration_Correct(const Apc1_CorrectedPM* corrected, uint8_t* measurementData)
+{
+    uint16_t checksum = 0;
+
+    for (Apc1_Field field = 0; field < APC1_CALIBRATION_PM_FIELDS; field++)
+    {
+        Apc1_SetFieldValue(measurementData, field, (corrected->values[field] + 5u) / 10u);
+    }
+
+    for (uint8_t i = 0; i < APC1_RESULT_ADDRESS_CHECKSUM_H; i++)
+    {
+        checksum += measurementData[i];
+    }
+    measurementData[APC1_RESULT_ADDRESS_CHECKSUM_H] = (uint8_t)(checksum >> 8);
+    measurementData[APC1_RESULT_ADDRESS_CHECKSUM_L] = (uint8_t)checksum;
+}
+
+static inline float Apc1_Calibration_ToFloat(const Apc1_CorrectedPM* corrected, const Apc1_Field field)
+{
+    return (field < APC1_CALIBRATION_PM_FIELDS) ? (float)corrected->values[field] * 0.1f : 0.0f;
+}
+
+#undef APC1_CALIBRATION_RH_MAX
+#undef APC1_CALIBRATION_KOEHLER
+
+#endif // SCIOSENSE_APC1_CALIBRATION_C_INL
@@ -0,0 +1,59 @@
+#ifndef SCIOSENSE_APC1_DISTRIBUTION_C_H
+#define SCIOSENSE_APC1_DISTRIBUTION_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Particle size distribution from the cumulative particle counts
+//
+// The APC1 reports the particles larger than 0.3, 0.5, 1.0, 2.5, 5.0 and 10 µm per 0.1 L. Their
+// differences are the counts per size bin:
+//
+//      bin     0           1           2           3           4           5
+//      µm      0.3-0.5     0.5-1.0     1.0-2.5     2.5-5.0     5.0-10      > 10
+//      d µm    0.387       0.707       1.581       3.536       7.071       14.14
+//
+// Each bin is represented by the geometric mean of its edges (d); the open bin > 10 µm is assumed to
+// end at 20 µm. A count which is larger than the one of the next smaller size (noise) gives 0.
+// From the bins follow:
+//
+//      number      particles per m³ (counts per 0.1 L * 10^4)
+//      mass        µg/m³, assuming spheres of diameter d and the given density in g/cm³
+//      gmd, gsd    count weighted geometric mean diameter in µm and geometric standard deviation
+//
+// The mass is an estimate from 6 bins and a fixed density; it does not replace the PM outputs.
+//
+// Apc1_Distribution_Batch processes a stored history in structure-of-arrays layout: one column per
+// cumulative count in, one column per result out. Its loops have no data dependent branches and no
+// calls other than expf and sqrtf, so compilers vectorize them (GCC: -O3 -ffast-math).
+
+#define APC1_DISTRIBUTION_BINS              (6)
+#define APC1_DISTRIBUTION_DEFAULT_DENSITY   (1.65f)     // g/cm³; typical for ambient aerosol
+#define APC1_DISTRIBUTION_DIAMETERS         { 0.3873f, 0.7071f, 1.5811f, 3.5355f, 7.0711f, 14.142f }
+
+typedef struct Apc1_Distribution
+{
+    uint16_t    counts[APC1_DISTRIBUTION_BINS];         // particles per 0.1 L per bin
+    float       number[APC1_DISTRIBUTION_BINS];         // particles per m³ per bin
+    float       mass[APC1_DISTRIBUTION_BINS];           // µg/m³ per bin
+    float       numberTotal;                            // particles > 0.3 µm per m³
+    float       massTotal;                              // µg/m³
+    float       gmd;                                    // µm; 0 without particles
+    float       gsd;                                    // 1 for a single bin; 0 without particles
+} Apc1_Distribution;
+
+typedef struct Apc1_DistributionColumns
+{
+    const uint16_t* cumulative[APC1_DISTRIBUTION_BINS]; // in: particles > 0.3 ... > 10 µm per 0.1 L, one column each
+    float*          number[APC1_DISTRIBUTION_BINS];     // out: particles per m³ per bin; a column may be NULL
+    float*          mass[APC1_DISTRIBUTION_BINS];       // out: µg/m³ per bin; a column may be NULL
+    float*          numberTotal;                        // out; required
+    float*          massTotal;                          // out; required
+    float*          gmd;                                // out; required
+    float*          gsd;                                // out; required
+} Apc1_DistributionColumns;
+
+static inline void  Apc1_Distribution_FromFrame (const uint8_t* measurementData, const float density, Apc1_Distribution* distribution);        // computes the distribution of a validated measurement frame
+static inline void  Apc1_Distribution_Batch     (const Apc1_DistributionColumns* columns, const size_t count, const float density);         // computes the distributions of count rows
+
+#include "ScioSense_Apc1_Distribution.inl.h"
+#endif // SCIOSENSE_APC1_DISTRIBUTION_C_H
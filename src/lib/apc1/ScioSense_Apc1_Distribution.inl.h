@@ -0,0 +1,131 @@
+#ifndef SCIOSENSE_APC1_DISTRIBUTION_C_INL
+#define SCIOSENSE_APC1_DISTRIBUTION_C_INL
+
+#include <math.h>
+
+#include "ScioSense_Apc1_Distribution.h"
+
+// particles per 0.1 L -> per m³
+#define APC1_DISTRIBUTION_PER_M3            (10000.0f)
+
+// pi/6 * d³ in µm³ and ln(d) of APC1_DISTRIBUTION_DIAMETERS
+#define APC1_DISTRIBUTION_VOLUMES           { 0.030419f, 0.18512f, 2.0696f, 23.139f, 185.12f, 1480.9f }
+#define APC1_DISTRIBUTION_LOG_DIAMETERS     { -0.94856f, -0.34658f, 0.45812f, 1.26285f, 1.95602f, 2.64915f }
+
+static inline void Apc1_Distribution_Batch(const Apc1_DistributionColumns* columns, const size_t count, const float density)
+{
+    static const float volumes[APC1_DISTRIBUTION_BINS]      = APC1_DISTRIBUTION_VOLUMES;
+    static const float logDiameter[APC1_DISTRIBUTION_BINS]  = APC1_DISTRIBUTION_LOG_DIAMETERS;
+    float massPerParticle[APC1_DISTRIBUTION_BINS];          // µg: µm³ * g/cm³ = 10^-6 µg
+
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        massPerParticle[b] = density * volumes[b] * 1e-6f;
+    }
+
+    // one pass per column, so each loop is a plain stream
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        const uint16_t* larger  = columns->cumulative[b];
+        float* mass             = columns->mass[b];
+        float* number           = (columns->number[b] != NULL) ? columns->number[b] : mass;
+
+        if (number == NULL)
+        {
+            continue;
+        }
+
+        if (b + 1 < APC1_DISTRIBUTION_BINS)
+        {
+            const uint16_t* next = columns->cumulative[b + 1];
+            for (size_t i = 0; i < count; i++)
+            {
+                const float difference = (float)larger[i] - (float)next[i];
+                number[i] = ((difference > 0.0f) ? difference : 0.0f) * APC1_DISTRIBUTION_PER_M3;
+            }
+        }
+        else
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                number[i] = (float)larger[i] * APC1_DISTRIBUTION_PER_M3;
+            }
+        }
+
+        if (mass != NULL)
+        {
+            for (size_t i = 0; i < count; i++)
+            {
+                mass[i] = number[i] * massPerParticle[b];
+            }
+        }
+    }
+
+    {
+        const uint16_t* const* cumulative   = columns->cumulative;
+        float* numberTotals                 = columns->numberTotal;
+        float* massTotals                   = columns->massTotal;
+        float* gmd                          = columns->gmd;
+        float* gsd                          = columns->gsd;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            float numberTotal   = 0.0f;
+            float massTotal     = 0.0f;
+            float logSum        = 0.0f;
+            float logSquareSum  = 0.0f;
+
+            for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+            {
+                const float next        = (b + 1 < APC1_DISTRIBUTION_BINS) ? (float)cumulative[b + 1][i] : 0.0f;
+                const float difference  = (float)cumulative[b][i] - next;
+                const float n           = ((difference > 0.0f) ? difference : 0.0f) * APC1_DISTRIBUTION_PER_M3;
+
+                numberTotal    += n;
+                massTotal      += n * massPerParticle[b];
+                logSum         += n * logDiameter[b];
+                logSquareSum   += n * logDiameter[b] * logDiameter[b];
+            }
+
+            {
+                const float valid       = (numberTotal > 0.0f) ? 1.0f : 0.0f;
+                const float divisor     = (numberTotal > 0.0f) ? numberTotal : 1.0f;
+                const float logMean     = logSum / divisor;
+                const float variance    = logSquareSum / divisor - logMean * logMean;
+
+                numberTotals[i] = numberTotal;
+                massTotals[i]   = massTotal;
+                gmd[i]          = valid * expf(logMean);
+                gsd[i]          = valid * expf(sqrtf((variance > 0.0f) ? variance : 0.0f));
+            }
+        }
+    }
+}
+
+static inline void Apc1_Distribution_FromFrame(const uint8_t* measurementData, const float density, Apc1_Distribution* distribution)
+{
+    uint16_t cumulative[APC1_DISTRIBUTION_BINS];
+    Apc1_DistributionColumns columns;
+
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        cumulative[b]           = (uint16_t)Apc1_GetFieldValue(measurementData, APC1_FIELD_NOPARTICLES_0_3 + b);
+        columns.cumulative[b]   = &cumulative[b];
+        columns.number[b]       = &distribution->number[b];
+        columns.mass[b]         = &distribution->mass[b];
+    }
+    columns.numberTotal = &distribution->numberTotal;
+    columns.massTotal   = &distribution->massTotal;
+    columns.gmd         = &distribution->gmd;
+    columns.gsd         = &distribution->gsd;
+
+    Apc1_Distribution_Batch(&columns, 1, density);
+
+    for (uint8_t b = 0; b < APC1_DISTRIBUTION_BINS; b++)
+    {
+        const uint16_t next     = (b + 1 < APC1_DISTRIBUTION_BINS) ? cumulative[b + 1] : 0;
+        distribution->counts[b] = (cumulative[b] > next) ? cumulative[b] - next : 0;
+    }
+}
+
+#endif // SCIOSENSE_APC1_DISTRIBUTION_C_INL
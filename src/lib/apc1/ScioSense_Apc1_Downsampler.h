@@ -0,0 +1,92 @@
+#ifndef SCIOSENSE_APC1_DOWNSAMPLER_C_H
+#define SCIOSENSE_APC1_DOWNSAMPLER_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Multi-resolution history of selected fields in fixed memory
+//
+// Measurements are aggregated into tiers of buckets, e.g. 1 s -> 1 min -> 15 min -> 1 h. Each bucket
+// keeps min, max, mean and the number of samples per field. Samples go into the open bucket of the
+// first tier; when a bucket closes, it is stored in the ring of its tier and merged into the open
+// bucket of the next tier. An update costs O(fields) plus, once per bucket, O(fields) per tier.
+//
+// Each tier is a ring of `capacity` buckets, one of them open; when it is full, the oldest bucket is
+// dropped. Bucket durations must be multiples of the previous tier's, and buckets are aligned to
+// multiples of their duration, so the tiers nest. Empty buckets are not stored: after an outage, the
+// history continues with the next sample.
+//
+// Apc1_Downsampler_Query reports a time range in the finest resolution available: the oldest part
+// from the coarsest tier and each later part from the finest tier that still holds it, in time order
+// and without overlaps. Timestamps are seconds, e.g. millis() / 1000 or unix time.
+//
+// Memory per tier is capacity * APC1_DOWNSAMPLE_BUCKET_SIZE(fields) bytes; with 8 fields:
+//
+//      duration    per day         e.g. capacity   retained    bytes
+//      1 s         9.0 MB          600             10 min      62 kB
+//      1 min       150 kB          1440            1 day       150 kB
+//      15 min      10 kB           672             1 week      70 kB
+//      1 h         2.5 kB          720             30 days     75 kB
+//
+// Use APC1_DOWNSAMPLE_BYTES_PER_DAY to size the rings; small MCUs keep fewer fields or start at 1 min.
+
+#define APC1_DOWNSAMPLE_MAX_TIERS       (8)
+
+typedef struct Apc1_DownsampleBucket
+{
+    uint32_t                start;              // s; a multiple of the tier's duration
+    uint32_t                count;              // samples; 0 for an empty open bucket
+} Apc1_DownsampleBucket;
+
+typedef struct Apc1_DownsampleStats
+{
+    uint32_t                min;                // in the unit of the field in the frame (T/RH in 0.1)
+    uint32_t                max;
+    float                   mean;
+} Apc1_DownsampleStats;
+
+typedef struct Apc1_DownsampleTier
+{
+    uint32_t                duration;           // s per bucket
+    uint16_t                capacity;           // buckets in the ring, including the open one; >= 2
+    Apc1_DownsampleBucket*  buckets;            // capacity entries
+    Apc1_DownsampleStats*   stats;              // capacity * fields entries; bucket i starts at i * fields
+    uint16_t                head;               // index of the open bucket
+    uint16_t                used;               // closed buckets; at most capacity - 1
+} Apc1_DownsampleTier;
+
+// initializer for the tier table
+#define APC1_DOWNSAMPLE_TIER(duration, capacity, buckets, stats)    { (duration), (capacity), (buckets), (stats), 0, 0 }
+
+// bytes per bucket and per retained day of a tier
+#define APC1_DOWNSAMPLE_BUCKET_SIZE(fields)             (sizeof(Apc1_DownsampleBucket) + (fields) * sizeof(Apc1_DownsampleStats))
+#define APC1_DOWNSAMPLE_BYTES_PER_DAY(duration, fields) ((86400UL / (duration)) * APC1_DOWNSAMPLE_BUCKET_SIZE(fields))
+
+typedef struct Apc1_DownsampleResult
+{
+    uint8_t                     tier;
+    uint32_t                    start;          // s
+    uint32_t                    duration;       // s
+    uint32_t                    count;          // samples
+    bool                        open;           // the bucket may still receive samples
+    const Apc1_DownsampleStats* stats;          // one entry per field in fieldMask, in Apc1_Field order; see Apc1_Downsampler_GetStats
+} Apc1_DownsampleResult;
+
+typedef void (*Apc1_DownsampleCallback)(void* context, const Apc1_DownsampleResult* result);
+
+typedef struct Apc1_Downsampler
+{
+    Apc1_DownsampleTier*    tiers;
+    uint8_t                 tierCount;
+    uint32_t                fieldMask;          // APC1_FIELD_MASK of the stored fields
+    uint8_t                 fields;             // fields in fieldMask
+    uint32_t                samples;            // samples added since init
+} Apc1_Downsampler;
+
+static inline Result                        Apc1_Downsampler_Init           (Apc1_Downsampler* ds, Apc1_DownsampleTier* tiers, const uint8_t tierCount, const uint32_t fieldMask);     // checks the tiers and clears them; RESULT_INVALID for durations which do not nest, capacities < 2 or too many tiers
+static inline Result                        Apc1_Downsampler_Add            (Apc1_Downsampler* ds, const uint32_t timestamp, const uint8_t* measurementData);                         // adds a validated measurement frame; RESULT_INVALID for a timestamp before the open bucket
+static inline uint32_t                      Apc1_Downsampler_Query          (const Apc1_Downsampler* ds, const uint32_t from, const uint32_t to, Apc1_DownsampleCallback onResult, void* context); // reports the buckets overlapping [from, to) in the finest resolution available; returns their number
+static inline const Apc1_DownsampleStats*   Apc1_Downsampler_GetStats       (const Apc1_Downsampler* ds, const Apc1_DownsampleResult* result, const Apc1_Field field);               // returns the stats of a field in a result; NULL, if the field is not stored
+static inline uint32_t                      Apc1_Downsampler_GetRetention   (const Apc1_Downsampler* ds, const uint8_t tier);                                                         // returns the s of history a tier holds when its ring is full
+
+#include "ScioSense_Apc1_Downsampler.inl.h"
+#endif // SCIOSENSE_APC1_DOWNSAMPLER_C_H
@@ -0,0 +1,255 @@
+#ifndef SCIOSENSE_APC1_DOWNSAMPLER_C_INL
+#define SCIOSENSE_APC1_DOWNSAMPLER_C_INL
+
+#include "ScioSense_Apc1_Downsampler.h"
+
+static inline bool Apc1_Downsampler_Before(const uint32_t a, const uint32_t b)
+{
+    return (int32_t)(a - b) < 0;
+}
+
+static inline Result Apc1_Downsampler_Init(Apc1_Downsampler* ds, Apc1_DownsampleTier* tiers, const uint8_t tierCount, const uint32_t fieldMask)
+{
+    ds->tiers       = tiers;
+    ds->tierCount   = 0;
+    ds->fieldMask   = fieldMask & APC1_FIELD_MASK_ALL;
+    ds->fields      = 0;
+    ds->samples     = 0;
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        ds->fields += (ds->fieldMask & APC1_FIELD_MASK(field)) ? 1 : 0;
+    }
+
+    if (tierCount == 0 || tierCount > APC1_DOWNSAMPLE_MAX_TIERS || ds->fields == 0)
+    {
+        return RESULT_INVALID;
+    }
+
+    for (uint8_t i = 0; i < tierCount; i++)
+    {
+        if
+        (
+            tiers[i].duration == 0
+         || tiers[i].capacity < 2
+         || (i > 0 && tiers[i].duration % tiers[i - 1].duration != 0)
+        )
+        {
+            return RESULT_INVALID;
+        }
+
+        tiers[i].head   = 0;
+        tiers[i].used   = 0;
+        tiers[i].buckets[0].count = 0;
+    }
+
+    ds->tierCount = tierCount;
+
+    return RESULT_OK;
+}
+
+static inline uint32_t Apc1_Downsampler_GetRetention(const Apc1_Downsampler* ds, const uint8_t tier)
+{
+    return (tier < ds->tierCount) ? (uint32_t)(ds->tiers[tier].capacity - 1) * ds->tiers[tier].duration : 0;
+}
+
+static inline const Apc1_DownsampleStats* Apc1_Downsampler_GetStats(const Apc1_Downsampler* ds, const Apc1_DownsampleResult* result, const Apc1_Field field)
+{
+    uint8_t index = 0;
+
+    if (field >= APC1_FIELD_COUNT || (ds->fieldMask & APC1_FIELD_MASK(field)) == 0)
+    {
+        return NULL;
+    }
+
+    for (Apc1_Field f = 0; f < field; f++)
+    {
+        index += (ds->fieldMask & APC1_FIELD_MASK(f)) ? 1 : 0;
+    }
+
+    return result->stats + index;
+}
+
+static inline void Apc1_Downsampler_Merge(Apc1_Downsampler* ds, const uint8_t tier, const uint32_t start, const uint32_t count, const Apc1_DownsampleStats* stats);
+
+static inline void Apc1_Downsampler_Close(Apc1_Downsampler* ds, const uint8_t tier)
+{
+    Apc1_DownsampleTier* t              = &ds->tiers[tier];
+    const Apc1_DownsampleBucket* bucket = &t->buckets[t->head];
+
+    if (tier + 1 < ds->tierCount)
+    {
+        Apc1_Downsampler_Merge(ds, tier + 1, bucket->start, bucket->count, &t->stats[(size_t)t->head * ds->fields]);
+    }
+
+    // the open bucket takes the slot of the oldest one
+    t->head = (uint16_t)((t->head + 1) % t->capacity);
+    t->used = (t->used < t->capacity - 1) ? t->used + 1 : t->used;
+    t->buckets[t->head].count = 0;
+}
+
+static inline void Apc1_Downsampler_Merge(Apc1_Downsampler* ds, const uint8_t tier, const uint32_t start, const uint32_t count, const Apc1_DownsampleStats* stats)
+{
+    Apc1_DownsampleTier* t          = &ds->tiers[tier];
+    const uint32_t aligned          = start - start % t->duration;
+    Apc1_DownsampleBucket* bucket   = &t->buckets[t->head];
+    Apc1_DownsampleStats* open;
+
+    if (bucket->count > 0 && bucket->start != aligned)
+    {
+        Apc1_Downsampler_Close(ds, tier);
+        bucket = &t->buckets[t->head];
+    }
+
+    open = &t->stats[(size_t)t->head * ds->fields];
+
+    if (bucket->count == 0)
+    {
+        bucket->start = aligned;
+        for (uint8_t i = 0; i < ds->fields; i++)
+        {
+            open[i] = stats[i];
+        }
+    }
+    else
+    {
+        // the mean weighted by the sample counts, without sums which could overflow
+        const float weight = (float)count / (float)(bucket->count + count);
+        for (uint8_t i = 0; i < ds->fields; i++)
+        {
+            open[i].min     = (stats[i].min < open[i].min) ? stats[i].min : open[i].min;
+            open[i].max     = (stats[i].max > open[i].max) ? stats[i].max : open[i].max;
+            open[i].mean   += (stats[i].mean - open[i].mean) * weight;
+        }
+    }
+
+    bucket->count += count;
+}
+
+static inline Result Apc1_Downsampler_Add(Apc1_Downsampler* ds, const uint32_t timestamp, const uint8_t* measurementData)
+{
+    Apc1_DownsampleTier* t;
+    Apc1_DownsampleBucket* bucket;
+    Apc1_DownsampleStats* open;
+    uint8_t i = 0;
+
+    if (ds->tierCount == 0)
+    {
+        return RESULT_NOT_ALLOWED;
+    }
+
+    t       = &ds->tiers[0];
+    bucket  = &t->buckets[t->head];
+
+    if (bucket->count > 0 && Apc1_Downsampler_Before(timestamp, bucket->start))
+    {
+        return RESULT_INVALID;
+    }
+
+    if (bucket->count > 0 && timestamp - bucket->start >= t->duration)
+    {
+        Apc1_Downsampler_Close(ds, 0);
+        bucket = &t->buckets[t->head];
+    }
+
+    if (bucket->count == 0)
+    {
+        bucket->start = timestamp - timestamp % t->duration;
+    }
+
+    open = &t->stats[(size_t)t->head * ds->fields];
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if ((ds->fieldMask & APC1_FIELD_MASK(field)) == 0)
+        {
+            continue;
+        }
+
+        const uint32_t value = Apc1_GetFieldValue(measurementData, field);
+        if (bucket->count == 0)
+        {
+            open[i].min     = value;
+            open[i].max     = value;
+            open[i].mean    = (float)value;
+        }
+        else
+        {
+            open[i].min     = (value < open[i].min) ? value : open[i].min;
+            open[i].max     = (value > open[i].max) ? value : open[i].max;
+            open[i].mean   += ((float)value - open[i].mean) / (float)(bucket->count + 1);
+        }
+        i++;
+    }
+
+    bucket->count++;
+    ds->samples++;
+
+    return RESULT_OK;
+}
+
+static inline bool Apc1_Downsampler_Oldest(const Apc1_DownsampleTier* t, uint32_t* start)
+{
+    if (t->used > 0)
+    {
+        *start = t->buckets[(t->head + t->capacity - t->used) % t->capacity].start;
+        return true;
+    }
+    if (t->buckets[t->head].count > 0)
+    {
+        *start = t->buckets[t->head].start;
+        return true;
+    }
+
+    return false;
+}
+
+static inline uint32_t Apc1_Downsampler_Query(const Apc1_Downsampler* ds, const uint32_t from, const uint32_t to, Apc1_DownsampleCallback onResult, void* context)
+{
+    Apc1_DownsampleResult result;
+    uint32_t reported   = from;         // end of the last reported bucket
+    uint32_t count      = 0;
+
+    for (uint8_t tier = ds->tierCount; tier-- > 0; )
+    {
+        const Apc1_DownsampleTier* t = &ds->tiers[tier];
+        uint32_t finer = 0;
+        // buckets from which on a finer tier has data are left to that tier; all of them, if it never dropped a bucket
+        const bool hasFiner = (tier > 0) && Apc1_Downsampler_Oldest(&ds->tiers[tier - 1], &finer);
+        const bool complete = hasFiner && ds->tiers[tier - 1].used < ds->tiers[tier - 1].capacity - 1;
+
+        for (uint16_t n = 0; n <= t->used; n++)
+        {
+            const uint16_t index                = (uint16_t)((t->head + t->capacity - t->used + n) % t->capacity);
+            const Apc1_DownsampleBucket* bucket = &t->buckets[index];
+            const uint32_t end                  = bucket->start + t->duration;
+
+            if
+            (
+                bucket->count == 0
+             || Apc1_Downsampler_Before(bucket->start, reported - reported % t->duration)
+             || !Apc1_Downsampler_Before(reported, end)
+             || !Apc1_Downsampler_Before(bucket->start, to)
+             || complete
+             || (hasFiner && !Apc1_Downsampler_Before(bucket->start, finer))
+            )
+            {
+                continue;
+            }
+
+            result.tier     = tier;
+            result.start    = bucket->start;
+            result.duration = t->duration;
+            result.count    = bucket->count;
+            result.open     = (index == t->head);
+            result.stats    = &t->stats[(size_t)index * ds->fields];
+            onResult(context, &result);
+
+            reported = end;
+            count++;
+        }
+    }
+
+    return count;
+}
+
+#endif // SCIOSENSE_APC1_DOWNSAMPLER_C_INL
@@ -0,0 +1,118 @@
+#ifndef SCIOSENSE_APC1_PIPELINE_C_H
+#define SCIOSENSE_APC1_PIPELINE_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Telemetry pipeline: acquisition, transform stages and several sinks with backpressure
+//
+// Frames live in a pool of APC1_PIPELINE_POOL_SIZE slots with reference counts. The stages pass
+// slot indices only, so a frame is copied once, when Apc1_Pipeline_Push takes it from the driver.
+//
+//      acquisition     stage 0; Apc1_Pipeline_Push takes a validated frame into a free slot
+//      transform       runs in Push, in the order added and before any sink gets the frame; it
+//                      may change the frame in place. A result other than RESULT_OK drops the
+//                      frame, so a transform can be a filter
+//      sink            has a queue of `length` frames, emptied by Apc1_Pipeline_Service, which
+//                      calls the sink outside of the lock. A result other than RESULT_OK (e.g. the
+//                      radio is busy) keeps the frame for the next Service call
+//
+// Push never waits for a sink. If a queue is full, its policy decides:
+//
+//      DROP_OLDEST     the oldest queued frame is dropped
+//      COALESCE        the newest queued frame is replaced; with length 1 the sink gets the latest value
+//      BLOCK           Push refuses the frame with RESULT_NOT_ALLOWED, before any queue takes it. For
+//                      lossless sinks which keep up on average, e.g. a flash store; it holds back the
+//                      acquisition, so a slow sink (a radio) takes one of the other policies
+//
+// Push may run in another task than the sinks, if lock callbacks are set; each sink is serviced
+// by one task. The lock guards queue and pool updates only, never a transform or a sink. The stats
+// of every stage count frames and drops, and log2 histograms of the latency in ms: of Push for
+// the acquisition, of the call for a transform, and from Push to the delivery for a sink.
+
+#ifndef APC1_PIPELINE_POOL_SIZE
+#define APC1_PIPELINE_POOL_SIZE         (8)         // frame slots; must cover length + 1 of every sink, and one for Push
+#endif
+#ifndef APC1_PIPELINE_MAX_STAGES
+#define APC1_PIPELINE_MAX_STAGES        (8)         // including the acquisition
+#endif
+#define APC1_PIPELINE_QUEUE_LENGTH      (4)         // max length of a sink queue
+#define APC1_PIPELINE_NONE              (0xFF)      // no stage, no slot
+
+typedef uint8_t Apc1_PipelineStageKind;
+#define APC1_PIPELINE_STAGE_ACQUISITION (0)
+#define APC1_PIPELINE_STAGE_TRANSFORM   (1)
+#define APC1_PIPELINE_STAGE_SINK        (2)
+
+typedef uint8_t Apc1_PipelinePolicy;
+#define APC1_PIPELINE_POLICY_DROP_OLDEST (0)
+#define APC1_PIPELINE_POLICY_COALESCE   (1)
+#define APC1_PIPELINE_POLICY_BLOCK      (2)
+
+typedef struct Apc1_PipelineFrame
+{
+    uint8_t     measurementData[APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH];
+    uint32_t    timestamp;                                      // of the caller, e.g. s of a RTC; passed through
+    uint32_t    pushed;                                         // ms of the pipeline clock at Push
+    uint32_t    sequence;                                       // counts the frames taken by Push; gaps show frames a sink did not get
+    uint8_t     references;                                     // queues and deliveries holding the slot
+} Apc1_PipelineFrame;
+
+typedef Result (*Apc1_PipelineTransform)(void* context, Apc1_PipelineFrame* frame);
+typedef Result (*Apc1_PipelineSink)     (void* context, const Apc1_PipelineFrame* frame);
+
+typedef struct Apc1_PipelineLock
+{
+    void    (*lock)     (void* context);                        // e.g. takes a mutex, or disables interrupts
+    void    (*unlock)   (void* context);
+    void*   context;
+} Apc1_PipelineLock;
+
+typedef struct Apc1_PipelineStats
+{
+    uint32_t    frames;                                         // taken by Push, passed by a transform, delivered by a sink
+    uint32_t    dropped;                                        // dropped by the policy or a transform; no free slot in Push
+    uint32_t    coalesced;                                      // queued frames replaced by a newer one
+    uint32_t    blocked;                                        // Push refused, for the acquisition and the full BLOCK sinks
+    uint32_t    retries;                                        // sink calls which kept the frame
+    uint32_t    latencyMax;                                     // ms
+    uint16_t    latency[APC1_STATS_LATENCY_BUCKETS];            // see APC1_STATS_LATENCY_BUCKETS
+} Apc1_PipelineStats;
+
+typedef struct Apc1_PipelineStage
+{
+    Apc1_PipelineStageKind  kind;
+    Apc1_PipelinePolicy     policy;
+    uint8_t                 length;                             // queue length of a sink
+    uint8_t                 head;                               // oldest queued frame
+    uint8_t                 count;                              // queued frames
+    uint8_t                 current;                            // slot in delivery or to be retried; APC1_PIPELINE_NONE
+    uint8_t                 queue[APC1_PIPELINE_QUEUE_LENGTH];  // slots
+    Apc1_PipelineTransform  transform;
+    Apc1_PipelineSink       sink;
+    void*                   context;
+    Apc1_PipelineStats      stats;
+} Apc1_PipelineStage;
+
+typedef struct Apc1_Pipeline
+{
+    Apc1_PipelineFrame  pool[APC1_PIPELINE_POOL_SIZE];
+    Apc1_PipelineStage  stages[APC1_PIPELINE_MAX_STAGES];
+    uint8_t             stageCount;
+    uint8_t             slots;                                  // slots the sink queues and deliveries may hold
+    uint32_t            sequence;
+    Apc1_PipelineLock   lock;
+    uint32_t            (*millis)(void);                        // optional; enables the latency statistics if set
+} Apc1_Pipeline;
+
+static inline void      Apc1_Pipeline_Init          (Apc1_Pipeline* pipeline, uint32_t (*millis)(void), const Apc1_PipelineLock* lock);                                          // millis and lock may be NULL; starts with the acquisition stage only
+static inline uint8_t   Apc1_Pipeline_AddTransform  (Apc1_Pipeline* pipeline, Apc1_PipelineTransform transform, void* context);                                                  // returns the stage; APC1_PIPELINE_NONE if there are APC1_PIPELINE_MAX_STAGES
+static inline uint8_t   Apc1_Pipeline_AddSink       (Apc1_Pipeline* pipeline, Apc1_PipelineSink sink, void* context, const Apc1_PipelinePolicy policy, const uint8_t length);   // returns the stage; APC1_PIPELINE_NONE for too many stages, an unknown policy, a length of 0 or above APC1_PIPELINE_QUEUE_LENGTH, or too few slots in the pool
+static inline Result    Apc1_Pipeline_Push          (Apc1_Pipeline* pipeline, const uint8_t* measurementData, const uint32_t timestamp);                                         // takes a validated frame; RESULT_NOT_ALLOWED if a BLOCK sink is full, RESULT_NO_NEW_DATA if a transform dropped it
+static inline uint8_t   Apc1_Pipeline_Service       (Apc1_Pipeline* pipeline, const uint8_t stage, const uint8_t maxFrames);                                                     // delivers up to maxFrames queued frames to a sink; returns the number delivered
+static inline uint8_t   Apc1_Pipeline_ServiceAll    (Apc1_Pipeline* pipeline, const uint8_t maxFrames);                                                                          // services every sink; for a single task
+static inline uint8_t   Apc1_Pipeline_GetPending    (Apc1_Pipeline* pipeline, const uint8_t stage);                                                                              // returns the frames a sink has yet to deliver
+static inline void      Apc1_Pipeline_GetStats      (Apc1_Pipeline* pipeline, const uint8_t stage, Apc1_PipelineStats* snapshot);                                                // copies the counters of a stage to snapshot
+static inline void      Apc1_Pipeline_ResetStats    (Apc1_Pipeline* pipeline);                                                                                                   // sets the counters of all stages to zero
+
+#include "ScioSense_Apc1_Pipeline.inl.h"
+#endif // SCIOSENSE_APC1_PIPELINE_C_H
@@ -0,0 +1,359 @@
+#ifndef SCIOSENSE_APC1_PIPELINE_C_INL
+#define SCIOSENSE_APC1_PIPELINE_C_INL
+
+#include "ScioSense_Apc1_Pipeline.h"
+
+#define lock()              if (pipeline->lock.lock) { pipeline->lock.lock(pipeline->lock.context); }
+#define unlock()            if (pipeline->lock.unlock) { pipeline->lock.unlock(pipeline->lock.context); }
+
+static inline uint32_t Apc1_Pipeline_Millis(Apc1_Pipeline* pipeline)
+{
+    return (pipeline->millis != NULL) ? pipeline->millis() : 0;
+}
+
+static inline void Apc1_Pipeline_RecordLatency(Apc1_Pipeline* pipeline, Apc1_PipelineStats* stats, const uint32_t start)
+{
+    if (pipeline->millis == NULL)
+    {
+        return;
+    }
+
+    const uint32_t duration = pipeline->millis() - start;
+    uint8_t bucket          = 0;
+    for (uint32_t bound = 1; bucket < APC1_STATS_LATENCY_BUCKETS - 1 && duration >= bound; bound <<= 1)
+    {
+        bucket++;
+    }
+
+    if (stats->latency[bucket] != UINT16_MAX)
+    {
+        stats->latency[bucket]++;
+    }
+    if (duration > stats->latencyMax)
+    {
+        stats->latencyMax = duration;
+    }
+}
+
+static inline void Apc1_Pipeline_ClearStats(Apc1_PipelineStats* stats)
+{
+    uint8_t* bytes = (uint8_t*)stats;
+    for (size_t i = 0; i < sizeof(Apc1_PipelineStats); i++)
+    {
+        bytes[i] = 0;
+    }
+}
+
+static inline uint8_t Apc1_Pipeline_AddStage(Apc1_Pipeline* pipeline, const Apc1_PipelineStageKind kind)
+{
+    if (pipeline->stageCount >= APC1_PIPELINE_MAX_STAGES)
+    {
+        return APC1_PIPELINE_NONE;
+    }
+
+    Apc1_PipelineStage* stage = &pipeline->stages[pipeline->stageCount];
+    stage->kind         = kind;
+    stage->policy       = APC1_PIPELINE_POLICY_DROP_OLDEST;
+    stage->length       = 0;
+    stage->head         = 0;
+    stage->count        = 0;
+    stage->current      = APC1_PIPELINE_NONE;
+    stage->transform    = NULL;
+    stage->sink         = NULL;
+    stage->context      = NULL;
+    Apc1_Pipeline_ClearStats(&stage->stats);
+
+    return pipeline->stageCount++;
+}
+
+static inline void Apc1_Pipeline_Init(Apc1_Pipeline* pipeline, uint32_t (*millis)(void), const Apc1_PipelineLock* lock)
+{
+    pipeline->stageCount    = 0;
+    pipeline->slots         = 1;    // the frame in Push
+    pipeline->sequence      = 0;
+    pipeline->millis        = millis;
+
+    pipeline->lock.lock     = NULL;
+    pipeline->lock.unlock   = NULL;
+    pipeline->lock.context  = NULL;
+    if (lock != NULL)
+    {
+        pipeline->lock = *lock;
+    }
+
+    for (uint8_t slot = 0; slot < APC1_PIPELINE_POOL_SIZE; slot++)
+    {
+        pipeline->pool[slot].references = 0;
+    }
+
+    Apc1_Pipeline_AddStage(pipeline, APC1_PIPELINE_STAGE_ACQUISITION);
+}
+
+static inline uint8_t Apc1_Pipeline_AddTransform(Apc1_Pipeline* pipeline, Apc1_PipelineTransform transform, void* context)
+{
+    const uint8_t stage = (transform != NULL) ? Apc1_Pipeline_AddStage(pipeline, APC1_PIPELINE_STAGE_TRANSFORM) : APC1_PIPELINE_NONE;
+
+    if (stage != APC1_PIPELINE_NONE)
+    {
+        pipeline->stages[stage].transform   = transform;
+        pipeline->stages[stage].context     = context;
+    }
+
+    return stage;
+}
+
+static inline uint8_t Apc1_Pipeline_AddSink(Apc1_Pipeline* pipeline, Apc1_PipelineSink sink, void* context, const Apc1_PipelinePolicy policy, const uint8_t length)
+{
+    // every sink may hold its queue and the frame in delivery
+    if
+    (
+        sink == NULL
+     || policy > APC1_PIPELINE_POLICY_BLOCK
+     || length == 0
+     || length > APC1_PIPELINE_QUEUE_LENGTH
+     || pipeline->slots + length + 1 > APC1_PIPELINE_POOL_SIZE
+    )
+    {
+        return APC1_PIPELINE_NONE;
+    }
+
+    const uint8_t stage = Apc1_Pipeline_AddStage(pipeline, APC1_PIPELINE_STAGE_SINK);
+    if (stage != APC1_PIPELINE_NONE)
+    {
+        pipeline->stages[stage].sink    = sink;
+        pipeline->stages[stage].context = context;
+        pipeline->stages[stage].policy  = policy;
+        pipeline->stages[stage].length  = length;
+        pipeline->slots                += length + 1;
+    }
+
+    return stage;
+}
+
+// both with the lock held
+static inline void Apc1_Pipeline_Release(Apc1_Pipeline* pipeline, const uint8_t slot)
+{
+    pipeline->pool[slot].references--;
+}
+
+static inline void Apc1_Pipeline_Enqueue(Apc1_Pipeline* pipeline, Apc1_PipelineStage* stage, const uint8_t slot)
+{
+    if (stage->count == stage->length)
+    {
+        if (stage->policy == APC1_PIPELINE_POLICY_COALESCE)
+        {
+            uint8_t* newest = &stage->queue[(stage->head + stage->count - 1) % stage->length];
+            Apc1_Pipeline_Release(pipeline, *newest);
+            *newest = slot;
+            pipeline->pool[slot].references++;
+            stage->stats.coalesced++;
+            return;
+        }
+
+        // APC1_PIPELINE_POLICY_DROP_OLDEST; a full BLOCK sink refused the frame before
+        Apc1_Pipeline_Release(pipeline, stage->queue[stage->head]);
+        stage->head = (stage->head + 1) % stage->length;
+        stage->count--;
+        stage->stats.dropped++;
+    }
+
+    stage->queue[(stage->head + stage->count) % stage->length] = slot;
+    stage->count++;
+    pipeline->pool[slot].references++;
+}
+
+static inline Result Apc1_Pipeline_Push(Apc1_Pipeline* pipeline, const uint8_t* measurementData, const uint32_t timestamp)
+{
+    Apc1_PipelineStats* acquisition = &pipeline->stages[0].stats;
+    const uint32_t start            = Apc1_Pipeline_Millis(pipeline);
+    Apc1_PipelineFrame* frame       = NULL;
+    bool blocked                    = false;
+    uint8_t slot;
+
+    lock();
+    for (uint8_t i = 1; i < pipeline->stageCount; i++)
+    {
+        Apc1_PipelineStage* stage = &pipeline->stages[i];
+        if (stage->kind == APC1_PIPELINE_STAGE_SINK && stage->policy == APC1_PIPELINE_POLICY_BLOCK && stage->count == stage->length)
+        {
+            stage->stats.blocked++;
+            blocked = true;
+        }
+    }
+    for (slot = 0; !blocked && slot < APC1_PIPELINE_POOL_SIZE; slot++)
+    {
+        if (pipeline->pool[slot].references == 0)
+        {
+            frame               = &pipeline->pool[slot];
+            frame->references   = 1;
+            frame->sequence     = pipeline->sequence++;
+            acquisition->frames++;
+            break;
+        }
+    }
+    if (frame == NULL)
+    {
+        // without a block, the pool only runs out while a sink is serviced by more than one task
+        if (blocked)
+        {
+            acquisition->blocked++;
+        }
+        else
+        {
+            acquisition->dropped++;
+        }
+        unlock();
+        return RESULT_NOT_ALLOWED;
+    }
+    unlock();
+
+    // the slot is held by Push alone until it is queued
+    for (uint8_t i = 0; i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH; i++)
+    {
+        frame->measurementData[i] = measurementData[i];
+    }
+    frame->timestamp    = timestamp;
+    frame->pushed       = start;
+
+    for (uint8_t i = 1; i < pipeline->stageCount; i++)
+    {
+        Apc1_PipelineStage* stage = &pipeline->stages[i];
+        if (stage->kind != APC1_PIPELINE_STAGE_TRANSFORM)
+        {
+            continue;
+        }
+
+        const uint32_t begin    = Apc1_Pipeline_Millis(pipeline);
+        const Result result     = stage->transform(stage->context, frame);
+
+        lock();
+        Apc1_Pipeline_RecordLatency(pipeline, &stage->stats, begin);
+        if (result != RESULT_OK)
+        {
+            stage->stats.dropped++;
+            Apc1_Pipeline_Release(pipeline, slot);
+            unlock();
+            return RESULT_NO_NEW_DATA;
+        }
+        stage->stats.frames++;
+        unlock();
+    }
+
+    lock();
+    for (uint8_t i = 1; i < pipeline->stageCount; i++)
+    {
+        if (pipeline->stages[i].kind == APC1_PIPELINE_STAGE_SINK)
+        {
+            Apc1_Pipeline_Enqueue(pipeline, &pipeline->stages[i], slot);
+        }
+    }
+    Apc1_Pipeline_Release(pipeline, slot);
+    Apc1_Pipeline_RecordLatency(pipeline, acquisition, start);
+    unlock();
+
+    return RESULT_OK;
+}
+
+static inline uint8_t Apc1_Pipeline_Service(Apc1_Pipeline* pipeline, const uint8_t stage, const uint8_t maxFrames)
+{
+    uint8_t delivered = 0;
+
+    if (stage >= pipeline->stageCount || pipeline->stages[stage].kind != APC1_PIPELINE_STAGE_SINK)
+    {
+        return 0;
+    }
+
+    Apc1_PipelineStage* sink = &pipeline->stages[stage];
+    while (delivered < maxFrames)
+    {
+        lock();
+        if (sink->current == APC1_PIPELINE_NONE)
+        {
+            if (sink->count == 0)
+            {
+                unlock();
+                break;
+            }
+
+            // the queue hands its reference over to the delivery
+            sink->current   = sink->queue[sink->head];
+            sink->head      = (sink->head + 1) % sink->length;
+            sink->count--;
+        }
+        const uint8_t slot = sink->current;
+        unlock();
+
+        const Result result = sink->sink(sink->context, &pipeline->pool[slot]);
+
+        lock();
+        if (result != RESULT_OK)
+        {
+            sink->stats.retries++;
+            unlock();
+            break;
+        }
+        sink->stats.frames++;
+        Apc1_Pipeline_RecordLatency(pipeline, &sink->stats, pipeline->pool[slot].pushed);
+        Apc1_Pipeline_Release(pipeline, slot);
+        sink->current = APC1_PIPELINE_NONE;
+        unlock();
+
+        delivered++;
+    }
+
+    return delivered;
+}
+
+static inline uint8_t Apc1_Pipeline_ServiceAll(Apc1_Pipeline* pipeline, const uint8_t maxFrames)
+{
+    uint8_t delivered = 0;
+
+    for (uint8_t stage = 1; stage < pipeline->stageCount; stage++)
+    {
+        delivered += Apc1_Pipeline_Service(pipeline, stage, maxFrames);
+    }
+
+    return delivered;
+}
+
+static inline uint8_t Apc1_Pipeline_GetPending(Apc1_Pipeline* pipeline, const uint8_t stage)
+{
+    uint8_t pending = 0;
+
+    if (stage < pipeline->stageCount && pipeline->stages[stage].kind == APC1_PIPELINE_STAGE_SINK)
+    {
+        lock();
+        pending = pipeline->stages[stage].count + ((pipeline->stages[stage].current != APC1_PIPELINE_NONE) ? 1 : 0);
+        unlock();
+    }
+
+    return pending;
+}
+
+static inline void Apc1_Pipeline_GetStats(Apc1_Pipeline* pipeline, const uint8_t stage, Apc1_PipelineStats* snapshot)
+{
+    if (stage >= pipeline->stageCount)
+    {
+        Apc1_Pipeline_ClearStats(snapshot);
+        return;
+    }
+
+    lock();
+    *snapshot = pipeline->stages[stage].stats;
+    unlock();
+}
+
+static inline void Apc1_Pipeline_ResetStats(Apc1_Pipeline* pipeline)
+{
+    lock();
+    for (uint8_t stage = 0; stage < pipeline->stageCount; stage++)
+    {
+        Apc1_Pipeline_ClearStats(&pipeline->stages[stage].stats);
+    }
+    unlock();
+}
+
+#undef lock
+#undef unlock
+
+#endif // SCIOSENSE_APC1_PIPELINE_C_INL
@@ -0,0 +1,99 @@
+#ifndef SCIOSENSE_APC1_POWER_C_H
+#define SCIOSENSE_APC1_POWER_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Duty cycling of the APC1 between idle (fan off) and standard mode
+//
+// Each cycle wakes the device, discards frames until the readings settled, takes a burst of
+// frames and returns the device to idle:
+//
+//      SLEEP --wake--> WARMUP --settled--> BURST --burstLength frames--> FINISH --idle--> SLEEP
+//
+// Warm-up frames are discarded for at least warmupMin ms, then until settleCount consecutive
+// frames changed by at most settleBand, but never longer than warmupMax ms.
+//
+// The interval from one wake up to the next adapts to the readings: it is halved (down to
+// minInterval) when the burst mean moved by more than targetChange since the previous cycle and
+// grows by half (up to maxInterval) when it moved by less than half of that. If the device would
+// sleep for less than warmupMin, it stays in standard mode and the next cycle skips the warm-up.
+//
+// A failed wake up is retried after APC1_SYSTEM_TIMING_STANDARD_MEASURE ms. A failed return to
+// idle is retried once; if that fails too, the sleep is accounted as fan-on time and the next
+// cycle wakes the device again with a warm-up. Both return APC1_POWER_EVENT_ERROR.
+//
+// Apc1_PowerManager_Run never blocks; call it again after Apc1_PowerManager_GetDelay ms. All
+// times are ms of the same clock, e.g. millis(); wrap-arounds are handled.
+
+typedef uint8_t Apc1_PowerState;
+#define APC1_POWER_STATE_SLEEP          (0)
+#define APC1_POWER_STATE_WARMUP         (1)
+#define APC1_POWER_STATE_BURST          (2)
+#define APC1_POWER_STATE_FINISH         (3)
+
+typedef uint8_t Apc1_PowerEvent;
+#define APC1_POWER_EVENT_NONE           (0)     // nothing to do yet
+#define APC1_POWER_EVENT_WAKE           (1)     // the device was woken up
+#define APC1_POWER_EVENT_SETTLED        (2)     // warm-up done; the burst begins
+#define APC1_POWER_EVENT_SAMPLE         (3)     // a burst frame is in measurementData
+#define APC1_POWER_EVENT_CYCLE          (4)     // the cycle is done; see Apc1_PowerManager.cycle
+#define APC1_POWER_EVENT_ERROR          (5)     // a mode change failed; a failed idle completes the cycle anyway
+
+typedef struct Apc1_PowerConfig
+{
+    uint32_t    minInterval;                    // ms from one wake up to the next while the readings change
+    uint32_t    maxInterval;                    // ms from one wake up to the next while the readings are stable
+    uint32_t    warmupMin;                      // ms after wake up in which frames are always discarded
+    uint32_t    warmupMax;                      // ms after wake up at which the burst starts, even if not settled
+    Apc1_Field  field;                          // field judged for settling and change, e.g. APC1_FIELD_PM_2_5
+    uint16_t    settleBand;                     // max change between consecutive warm-up frames, in units of field
+    uint8_t     settleCount;                    // consecutive frames within settleBand
+    uint8_t     burstLength;                    // frames per cycle
+    uint16_t    targetChange;                   // change of the burst mean between cycles, in units of field
+    uint16_t    activePower;                    // mW in standard mode; for the energy estimate
+    uint16_t    idlePower;                      // mW in idle mode; for the energy estimate
+} Apc1_PowerConfig;
+
+typedef struct Apc1_PowerCycle
+{
+    uint32_t    start;                          // ms of the wake up
+    uint32_t    fanOnTime;                      // ms from wake up to idle
+    uint32_t    interval;                       // ms to the next wake up
+    uint32_t    energy;                         // mJ for fanOnTime in standard and the rest of interval in idle mode
+    uint8_t     discarded;                      // warm-up frames
+    uint8_t     samples;                        // burst frames
+    bool        settled;                        // false, if the burst started at warmupMax
+    float       mean;                           // burst mean of field
+    uint32_t    min;
+    uint32_t    max;
+} Apc1_PowerCycle;
+
+typedef struct Apc1_PowerManager
+{
+    Apc1_PowerConfig    config;
+    Apc1_PowerState     state;
+    bool                awake;                  // the device is in standard mode, or may be after a failed return to idle
+    uint32_t            interval;               // current interval; between minInterval and maxInterval
+    uint32_t            nextRun;                // ms at which Apc1_PowerManager_Run has work to do
+    uint32_t            lastRun;
+    uint32_t            previous;               // value of field in the previous warm-up frame
+    uint8_t             settled;                // consecutive settled warm-up frames
+    uint8_t             attempts;               // updates in the current burst
+    float               sum;
+    bool                hasMean;                // cycle.mean is set by a previous cycle
+    Apc1_PowerCycle     cycle;                  // the current cycle; complete on APC1_POWER_EVENT_CYCLE
+    uint32_t            cycles;                 // completed cycles since init
+    uint32_t            errors;                 // failed wake ups and returns to idle since init
+    uint64_t            elapsedTotal;           // ms since init
+    uint64_t            fanOnTotal;             // ms in standard mode since init
+    uint64_t            energyTotal;            // mJ since init
+} Apc1_PowerManager;
+
+static inline void              Apc1_PowerManager_DefaultConfig (Apc1_PowerConfig* config);                                                     // 1 to 15 min interval, PM2.5 based, 5 frame bursts
+static inline void              Apc1_PowerManager_Init          (Apc1_PowerManager* pm, const Apc1_PowerConfig* config, const uint32_t now);     // starts with a wake up at now and minInterval
+static inline Apc1_PowerEvent   Apc1_PowerManager_Run           (Apc1_PowerManager* pm, ScioSense_Apc1* apc1, const uint32_t now);              // does the work due at now: wake up, update, idle; returns what happened
+static inline uint32_t          Apc1_PowerManager_GetDelay      (const Apc1_PowerManager* pm, const uint32_t now);                              // returns the ms until Apc1_PowerManager_Run has work to do
+static inline uint16_t          Apc1_PowerManager_GetDutyCycle  (const Apc1_PowerManager* pm);                                                  // returns the fan-on time since init in 0.1 %
+
+#include "ScioSense_Apc1_Power.inl.h"
+#endif // SCIOSENSE_APC1_POWER_C_H
@@ -0,0 +1,251 @@
+#ifndef SCIOSENSE_APC1_POWER_C_INL
+#define SCIOSENSE_APC1_POWER_C_INL
+
+#include "ScioSense_Apc1_Power.h"
+
+static inline void Apc1_PowerManager_DefaultConfig(Apc1_PowerConfig* config)
+{
+    config->minInterval     = 60000;
+    config->maxInterval     = 900000;
+    config->warmupMin       = 8000;
+    config->warmupMax       = 30000;
+    config->field           = APC1_FIELD_PM_2_5;
+    config->settleBand      = 2;
+    config->settleCount     = 3;
+    config->burstLength     = 5;
+    config->targetChange    = 5;
+
+    // typical for fan based particle sensors at 5 V; use the values measured on your board
+    config->activePower     = 350;
+    config->idlePower       = 15;
+}
+
+static inline void Apc1_PowerManager_Init(Apc1_PowerManager* pm, const Apc1_PowerConfig* config, const uint32_t now)
+{
+    pm->config          = *config;
+    pm->state           = APC1_POWER_STATE_SLEEP;
+    pm->awake           = false;                // the fan may have run before; warm up anyway
+    pm->interval        = config->minInterval;
+    pm->nextRun         = now;
+    pm->lastRun         = now;
+    pm->previous        = 0;
+    pm->settled         = 0;
+    pm->attempts        = 0;
+    pm->sum             = 0.0f;
+    pm->hasMean         = false;
+    pm->cycles          = 0;
+    pm->errors          = 0;
+    pm->elapsedTotal    = 0;
+    pm->fanOnTotal      = 0;
+    pm->energyTotal     = 0;
+
+    pm->cycle.start     = now;
+    pm->cycle.fanOnTime = 0;
+    pm->cycle.interval  = 0;
+    pm->cycle.energy    = 0;
+    pm->cycle.discarded = 0;
+    pm->cycle.samples   = 0;
+    pm->cycle.settled   = false;
+    pm->cycle.mean      = 0.0f;
+    pm->cycle.min       = 0;
+    pm->cycle.max       = 0;
+}
+
+static inline uint32_t Apc1_PowerManager_GetDelay(const Apc1_PowerManager* pm, const uint32_t now)
+{
+    const int32_t delay = (int32_t)(pm->nextRun - now);
+    return (delay > 0) ? (uint32_t)delay : 0;
+}
+
+static inline uint16_t Apc1_PowerManager_GetDutyCycle(const Apc1_PowerManager* pm)
+{
+    return (pm->elapsedTotal > 0) ? (uint16_t)(pm->fanOnTotal * 1000 / pm->elapsedTotal) : 0;
+}
+
+static inline Apc1_PowerEvent Apc1_PowerManager_Finish(Apc1_PowerManager* pm, ScioSense_Apc1* apc1, const uint32_t now)
+{
+    Apc1_PowerCycle* cycle  = &pm->cycle;
+    const float previous    = cycle->mean;
+    Apc1_PowerEvent event   = APC1_POWER_EVENT_CYCLE;
+    uint32_t sleep;
+
+    cycle->mean = (cycle->samples > 0) ? pm->sum / cycle->samples : previous;
+
+    // adapts the interval to the change since the previous cycle
+    if (pm->hasMean && cycle->samples > 0)
+    {
+        const float change = (cycle->mean > previous) ? cycle->mean - previous : previous - cycle->mean;
+        if (change > pm->config.targetChange)
+        {
+            pm->interval /= 2;
+        }
+        else if (change * 2 < pm->config.targetChange)
+        {
+            pm->interval += pm->interval / 2;
+        }
+        pm->interval = (pm->interval < pm->config.minInterval) ? pm->config.minInterval : pm->interval;
+        pm->interval = (pm->interval > pm->config.maxInterval) ? pm->config.maxInterval : pm->interval;
+    }
+    pm->hasMean = pm->hasMean || cycle->samples > 0;
+
+    cycle->fanOnTime    = now - cycle->start;
+    cycle->interval     = pm->interval;
+    sleep               = (cycle->interval > cycle->fanOnTime) ? cycle->interval - cycle->fanOnTime : 0;
+
+    // a short sleep would cost a full warm-up; stay in standard mode instead
+    if (sleep >= pm->config.warmupMin)
+    {
+        Result result = Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_IDLE);
+        if (result != RESULT_OK)
+        {
+            // retry
+            if (apc1->io.clear)
+            {
+                apc1->io.clear(apc1->io.config);
+            }
+            result = Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_IDLE);
+        }
+
+        if (result == RESULT_OK)
+        {
+            pm->awake = false;
+        }
+        else
+        {
+            // the fan may still run; the next cycle wakes the device again, as it is not in standard mode
+            cycle->fanOnTime   += sleep;
+            sleep               = 0;
+            pm->errors++;
+            event               = APC1_POWER_EVENT_ERROR;
+        }
+    }
+    else
+    {
+        cycle->fanOnTime   += sleep;
+        sleep               = 0;
+    }
+
+    // ms * mW = µJ
+    cycle->energy = (uint32_t)(((uint64_t)cycle->fanOnTime * pm->config.activePower + (uint64_t)sleep * pm->config.idlePower) / 1000);
+    pm->energyTotal += cycle->energy;
+    pm->cycles++;
+
+    pm->state   = APC1_POWER_STATE_SLEEP;
+    pm->nextRun = cycle->start + cycle->interval;
+    if ((int32_t)(pm->nextRun - now) < 0)
+    {
+        pm->nextRun = now;
+    }
+
+    return event;
+}
+
+static inline Apc1_PowerEvent Apc1_PowerManager_Run(Apc1_PowerManager* pm, ScioSense_Apc1* apc1, const uint32_t now)
+{
+    Apc1_PowerCycle* cycle = &pm->cycle;
+    const uint32_t elapsed = now - pm->lastRun;
+    Apc1_PowerEvent event  = APC1_POWER_EVENT_NONE;
+    Result result;
+    uint32_t value;
+
+    pm->elapsedTotal   += elapsed;
+    pm->fanOnTotal     += pm->awake ? elapsed : 0;
+    pm->lastRun         = now;
+
+    if ((int32_t)(now - pm->nextRun) < 0)
+    {
+        return APC1_POWER_EVENT_NONE;
+    }
+
+    switch (pm->state)
+    {
+        case APC1_POWER_STATE_SLEEP:
+            cycle->start        = now;
+            cycle->discarded    = 0;
+            cycle->samples      = 0;
+            cycle->settled      = true;
+            cycle->min          = 0xFFFFFFFF;
+            cycle->max          = 0;
+            pm->settled         = 0;
+            pm->attempts        = 0;
+            pm->sum             = 0.0f;
+
+            if (pm->awake && apc1->operatingMode == APC1_OPERATING_MODE_STANDARD)
+            {
+                // still in standard mode from the previous cycle; the readings are settled
+                pm->state   = APC1_POWER_STATE_BURST;
+                pm->nextRun = now;
+                event       = APC1_POWER_EVENT_WAKE;
+            }
+            else if (Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD) == RESULT_OK)
+            {
+                pm->awake   = true;
+                pm->state   = APC1_POWER_STATE_WARMUP;
+                pm->nextRun = now + APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+                event       = APC1_POWER_EVENT_WAKE;
+            }
+            else
+            {
+                // stays in SLEEP; the fan time is not counted until a wake up succeeded
+                pm->errors++;
+                pm->nextRun = now + APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+                event       = APC1_POWER_EVENT_ERROR;
+            }
+            break;
+
+        case APC1_POWER_STATE_WARMUP:
+            if (Apc1_Update(apc1) == RESULT_OK)
+            {
+                value = Apc1_GetFieldValue(apc1->measurementData, pm->config.field);
+                if (now - cycle->start >= pm->config.warmupMin && cycle->discarded > 0)
+                {
+                    const uint32_t change = (value > pm->previous) ? value - pm->previous : pm->previous - value;
+                    pm->settled = (change <= pm->config.settleBand) ? pm->settled + 1 : 0;
+                }
+                pm->previous = value;
+                cycle->discarded++;
+            }
+
+            if (pm->settled >= pm->config.settleCount || now - cycle->start >= pm->config.warmupMax)
+            {
+                cycle->settled  = pm->settled >= pm->config.settleCount;
+                pm->state       = APC1_POWER_STATE_BURST;
+                event           = APC1_POWER_EVENT_SETTLED;
+            }
+            pm->nextRun = now + APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+            break;
+
+        case APC1_POWER_STATE_BURST:
+            result = Apc1_Update(apc1);
+            pm->attempts++;
+            if (result == RESULT_OK)
+            {
+                value       = Apc1_GetFieldValue(apc1->measurementData, pm->config.field);
+                pm->sum    += (float)value;
+                cycle->min  = (value < cycle->min) ? value : cycle->min;
+                cycle->max  = (value > cycle->max) ? value : cycle->max;
+                cycle->samples++;
+                event       = APC1_POWER_EVENT_SAMPLE;
+            }
+
+            // failed updates are retried, but a cycle takes at most twice the burst length
+            if (cycle->samples >= pm->config.burstLength || pm->attempts >= 2 * pm->config.burstLength)
+            {
+                pm->state   = APC1_POWER_STATE_FINISH;
+                pm->nextRun = now;
+            }
+            else
+            {
+                pm->nextRun = now + APC1_SYSTEM_TIMING_STANDARD_MEASURE;
+            }
+            break;
+
+        default:
+            event = Apc1_PowerManager_Finish(pm, apc1, now);
+            break;
+    }
+
+    return event;
+}
+
+#endif // SCIOSENSE_APC1_POWER_C_INL
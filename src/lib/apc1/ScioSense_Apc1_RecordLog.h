@@ -0,0 +1,104 @@
+#ifndef SCIOSENSE_APC1_RECORD_LOG_C_H
+#define SCIOSENSE_APC1_RECORD_LOG_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Append-only log of compact measurement records on a flash or SD block device
+//
+// The log is a ring of pages. A page is filled in RAM and sealed (its header programmed) when it is
+// full. Apc1_RecordLog_Flush programs the records of the open page without its header, so the page
+// stays open and later records fill it up; Mount recovers the records of a flushed page. As every
+// Flush programs the page again, devices with a limit of partial programs per page (NAND) should
+// flush seldom. Erase blocks are erased only right before the head enters them, so every block is
+// erased once per wrap of the ring (even wear) and the oldest records are dropped first.
+//
+// Page layout (little endian):
+//      0   u16 magic           APC1_RECORD_LOG_MAGIC
+//      2   u16 used            bytes used by header and records
+//      4   u32 pageSequence    increments by one per page; orders the pages of the ring
+//      8   u32 firstSequence   sequence number of the first record
+//     12   u32 firstTimestamp
+//     16   u32 lastTimestamp
+//     20   u32 fieldMask       APC1_FIELD_MASK of the stored fields
+//     24   u16 recordCount
+//     26   u16 crc             CRC-16/CCITT over the header (without crc) and the records
+//     28   records
+//
+// A record is u8 stream (the sensor; 0xFF marks the end of a flushed page), varint(timestamp delta)
+// and zigzag varint(value delta) per stored field. Deltas are taken to the previous record of the
+// same page, of any stream, so every page decodes on its own; the first record of a page holds its
+// absolute timestamp. Most deltas take 1 or 2 bytes: about 21 bytes per record for PM, particle
+// counts, TVOC, eCO2, compensated T/RH, AQI and error code (64 bytes raw). At 1 Hz, 4 MiB of flash
+// hold about 2.5 days; for months, store fewer fields or downsampled records.
+//
+// The page headers form a sparse time index: Apc1_RecordLog_Seek binary searches them,
+// so range queries read O(log pages) headers instead of scanning the log. Mount reads the header of
+// the first page of every erase block and binary searches the newest block.
+
+#define APC1_RECORD_LOG_MAGIC           (0xA1C1)
+#define APC1_RECORD_LOG_HEADER_SIZE     (28)
+#define APC1_RECORD_LOG_MAX_RECORD_SIZE (1 + 5 + 5 * APC1_FIELD_COUNT)
+#define APC1_RECORD_LOG_STREAM_END      (0xFF)      // not a valid stream
+
+typedef struct ScioSense_Apc1_BlockDevice
+{
+    Result      (*read)     (void* config, const uint32_t address, uint8_t* data, const size_t size);
+    Result      (*program)  (void* config, const uint32_t address, const uint8_t* data, const size_t size);
+    Result      (*erase)    (void* config, const uint32_t address);                 // erases eraseSize bytes at address
+    uint32_t    size;                                                               // bytes; multiple of eraseSize
+    uint32_t    eraseSize;                                                          // bytes; multiple of pageSize
+    uint16_t    pageSize;                                                           // bytes programmed at once; >= APC1_RECORD_LOG_HEADER_SIZE + APC1_RECORD_LOG_MAX_RECORD_SIZE
+    void*       config;
+} ScioSense_Apc1_BlockDevice;
+
+typedef struct Apc1_LogRecord
+{
+    uint32_t    sequence;
+    uint32_t    timestamp;
+    uint8_t     stream;                                                             // sensor or stream id given to Append
+    uint32_t    values[APC1_FIELD_COUNT];                                           // see Apc1_Field; fields not stored are 0
+} Apc1_LogRecord;
+
+typedef struct Apc1_RecordLog
+{
+    ScioSense_Apc1_BlockDevice  device;
+    uint8_t*                    page;                                               // buffer of device.pageSize bytes for the open page
+    uint32_t                    fieldMask;
+    uint32_t                    pageCount;
+    uint32_t                    pagesPerBlock;
+    uint32_t                    headPage;                                           // physical page the open page will be programmed to
+    uint32_t                    tailPage;                                           // physical page of the oldest sealed page
+    uint32_t                    sealedPages;                                        // number of sealed pages from tailPage to headPage
+    uint32_t                    pageSequence;                                       // pageSequence of the open page
+    uint32_t                    recordSequence;                                     // sequence of the next record
+    uint16_t                    used;
+    uint16_t                    programmed;                                         // bytes of the open page programmed by Flush; 0 if none
+    uint16_t                    recordCount;
+    uint32_t                    firstTimestamp;
+    uint32_t                    lastTimestamp;
+    uint32_t                    previous[APC1_FIELD_COUNT];                         // delta encoder state of the open page
+    uint32_t                    erases;                                             // erase operations since mount
+    uint32_t                    corruptPages;                                       // pages skipped because of a CRC mismatch
+} Apc1_RecordLog;
+
+typedef struct Apc1_RecordLogCursor
+{
+    uint8_t*                    page;                                               // buffer of device.pageSize bytes
+    uint32_t                    logicalPage;                                        // 0 is the oldest page; sealedPages is the open page
+    uint32_t                    from;                                               // records before this timestamp are skipped
+    uint16_t                    offset;
+    uint16_t                    remaining;                                          // records left in the loaded page
+    uint32_t                    fieldMask;                                          // fieldMask of the loaded page
+    bool                        loaded;
+    Apc1_LogRecord              record;                                             // decoder state; the last returned record
+} Apc1_RecordLogCursor;
+
+static inline Result    Apc1_RecordLog_Mount            (Apc1_RecordLog* log, const ScioSense_Apc1_BlockDevice* device, uint8_t* page, const uint32_t fieldMask);   // finds the newest page and continues the log after it, or in the flushed open page
+static inline Result    Apc1_RecordLog_Append           (Apc1_RecordLog* log, const uint8_t stream, const uint32_t timestamp, const uint8_t* measurementData);       // appends the fields of a validated measurement frame of a sensor; RESULT_NOT_ALLOWED for APC1_RECORD_LOG_STREAM_END
+static inline Result    Apc1_RecordLog_Flush            (Apc1_RecordLog* log);                                                                                      // programs the records of the open page without sealing it
+static inline Result    Apc1_RecordLog_Seek             (Apc1_RecordLog* log, Apc1_RecordLogCursor* cursor, uint8_t* page, const uint32_t from);                   // positions the cursor at the first record with timestamp >= from
+static inline bool      Apc1_RecordLog_Next             (Apc1_RecordLog* log, Apc1_RecordLogCursor* cursor, Apc1_LogRecord* record);                               // returns the next record in log order; false at the end of the log
+static inline void      Apc1_RecordLog_ToMeasurementData(const Apc1_LogRecord* record, uint8_t* measurementData);                                                   // rebuilds a valid measurement frame for the Apc1_Get* functions
+
+#include "ScioSense_Apc1_RecordLog.inl.h"
+#endif // SCIOSENSE_APC1_RECORD_LOG_C_H
@@ -0,0 +1,633 @@
+#ifndef SCIOSENSE_APC1_RECORD_LOG_C_INL
+#define SCIOSENSE_APC1_RECORD_LOG_C_INL
+
+#include "ScioSense_Apc1_RecordLog.h"
+
+#define memcpy(a, b, s)     for(size_t i = 0; i < s; i++) {a[i] = b[i];}
+
+static inline void Apc1_RecordLog_Put16(uint8_t* data, const uint16_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+}
+
+static inline void Apc1_RecordLog_Put32(uint8_t* data, const uint32_t value)
+{
+    data[0] = (uint8_t)value;
+    data[1] = (uint8_t)(value >> 8);
+    data[2] = (uint8_t)(value >> 16);
+    data[3] = (uint8_t)(value >> 24);
+}
+
+static inline uint16_t Apc1_RecordLog_Get16(const uint8_t* data)
+{
+    return (uint16_t)data[0] | ((uint16_t)data[1] << 8);
+}
+
+static inline uint32_t Apc1_RecordLog_Get32(const uint8_t* data)
+{
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) | ((uint32_t)data[3] << 24);
+}
+
+static inline uint16_t Apc1_RecordLog_Crc(uint16_t crc, const uint8_t* data, const size_t size)
+{
+    // CRC-16/CCITT, bitwise to keep the flash footprint small
+    for (size_t i = 0; i < size; i++)
+    {
+        crc ^= (uint16_t)data[i] << 8;
+        for (uint8_t bit = 0; bit < 8; bit++)
+        {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+
+    return crc;
+}
+
+static inline uint16_t Apc1_RecordLog_PageCrc(const uint8_t* page, const uint16_t used)
+{
+    const uint16_t crc = Apc1_RecordLog_Crc(0xFFFF, page, APC1_RECORD_LOG_HEADER_SIZE - 2);
+    return Apc1_RecordLog_Crc(crc, page + APC1_RECORD_LOG_HEADER_SIZE, used - APC1_RECORD_LOG_HEADER_SIZE);
+}
+
+static inline uint8_t Apc1_RecordLog_PutVarint(uint8_t* data, uint32_t value)
+{
+    uint8_t size = 0;
+    while (value >= 0x80)
+    {
+        data[size++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    data[size++] = (uint8_t)value;
+
+    return size;
+}
+
+static inline uint8_t Apc1_RecordLog_GetVarint(const uint8_t* data, const size_t size, uint32_t* value)
+{
+    *value = 0;
+    for (uint8_t i = 0; i < 5 && i < size; i++)
+    {
+        *value |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if ((data[i] & 0x80) == 0)
+        {
+            return i + 1;
+        }
+    }
+
+    return 0; // truncated or corrupt
+}
+
+static inline uint32_t Apc1_RecordLog_ZigZag(const uint32_t delta)
+{
+    return (delta << 1) ^ (uint32_t)((int32_t)delta >> 31);
+}
+
+static inline uint32_t Apc1_RecordLog_UnZigZag(const uint32_t value)
+{
+    return (value >> 1) ^ (0 - (value & 1));
+}
+
+static inline void Apc1_RecordLog_Begin(Apc1_RecordLog* log, const uint32_t timestamp)
+{
+    log->used           = APC1_RECORD_LOG_HEADER_SIZE;
+    log->recordCount    = 0;
+    log->firstTimestamp = timestamp;
+    log->lastTimestamp  = timestamp;
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        log->previous[field] = 0;
+    }
+}
+
+static inline uint8_t Apc1_RecordLog_Encode(Apc1_RecordLog* log, const uint8_t stream, const uint32_t timestamp, const uint8_t* measurementData, uint8_t* record)
+{
+    // the first record of a page holds its absolute timestamp, so a flushed page decodes without its header
+    const uint32_t base = (log->recordCount == 0) ? 0 : log->lastTimestamp;
+    uint8_t size        = 0;
+
+    record[size++]  = stream;
+    size           += Apc1_RecordLog_PutVarint(record + size, (timestamp > base) ? timestamp - base : 0);
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (log->fieldMask & APC1_FIELD_MASK(field))
+        {
+            const uint32_t value = Apc1_GetFieldValue(measurementData, field);
+            size += Apc1_RecordLog_PutVarint(record + size, Apc1_RecordLog_ZigZag(value - log->previous[field]));
+        }
+    }
+
+    return size;
+}
+
+static inline size_t Apc1_RecordLog_Decode(const uint8_t* data, const size_t size, const uint32_t fieldMask, Apc1_LogRecord* record)
+{
+    // returns the length of the record, or 0 at the end of a flushed page and for a truncated record
+    uint32_t value;
+    size_t length;
+    uint8_t n;
+
+    if (size == 0 || data[0] == APC1_RECORD_LOG_STREAM_END)
+    {
+        return 0;
+    }
+
+    n       = Apc1_RecordLog_GetVarint(data + 1, size - 1, &value);
+    length  = 1 + n;
+
+    record->stream      = data[0];
+    record->timestamp  += value;
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT && n != 0; field++)
+    {
+        if (fieldMask & APC1_FIELD_MASK(field))
+        {
+            n = Apc1_RecordLog_GetVarint(data + length, size - length, &value);
+            record->values[field] += Apc1_RecordLog_UnZigZag(value);
+            length += n;
+        }
+    }
+
+    return (n != 0) ? length : 0;
+}
+
+static inline Result Apc1_RecordLog_ReadHeader(Apc1_RecordLog* log, const uint32_t physicalPage, uint8_t* header)
+{
+    Result result = log->device.read(log->device.config, physicalPage * log->device.pageSize, header, APC1_RECORD_LOG_HEADER_SIZE);
+
+    if (result == RESULT_OK && Apc1_RecordLog_Get16(header) != APC1_RECORD_LOG_MAGIC)
+    {
+        result = RESULT_INVALID;
+    }
+
+    return result;
+}
+
+static inline Result Apc1_RecordLog_Program(Apc1_RecordLog* log)
+{
+    Result result;
+
+    for (uint16_t i = log->used; i < log->device.pageSize; i++)
+    {
+        log->page[i] = 0xFF; // leave the unused tail unprogrammed
+    }
+
+    if (log->programmed == 0 && log->headPage % log->pagesPerBlock == 0)
+    {
+        // entering a block: erase it, dropping the oldest pages if the ring has wrapped
+        result = log->device.erase(log->device.config, log->headPage * log->device.pageSize);
+        if (result != RESULT_OK)
+        {
+            return result;
+        }
+        log->erases++;
+
+        const uint32_t offset = (log->tailPage + log->pageCount - log->headPage) % log->pageCount;
+        if (log->sealedPages > 0 && offset < log->pagesPerBlock)
+        {
+            const uint32_t dropped  = log->pagesPerBlock - offset;
+            log->sealedPages        = (dropped < log->sealedPages) ? log->sealedPages - dropped : 0;
+            log->tailPage           = (log->headPage + log->pagesPerBlock) % log->pageCount;
+        }
+    }
+
+    // programmed bytes are programmed again with the same value, which flash allows
+    result = log->device.program(log->device.config, log->headPage * log->device.pageSize, log->page, log->device.pageSize);
+    if (result == RESULT_OK)
+    {
+        log->programmed = log->used;
+    }
+
+    return result;
+}
+
+static inline Result Apc1_RecordLog_Seal(Apc1_RecordLog* log)
+{
+    Result result;
+    uint8_t* page = log->page;
+
+    if (log->recordCount == 0)
+    {
+        return RESULT_OK;
+    }
+
+    Apc1_RecordLog_Put16(page +  0, APC1_RECORD_LOG_MAGIC);
+    Apc1_RecordLog_Put16(page +  2, log->used);
+    Apc1_RecordLog_Put32(page +  4, log->pageSequence);
+    Apc1_RecordLog_Put32(page +  8, log->recordSequence - log->recordCount);
+    Apc1_RecordLog_Put32(page + 12, log->firstTimestamp);
+    Apc1_RecordLog_Put32(page + 16, log->lastTimestamp);
+    Apc1_RecordLog_Put32(page + 20, log->fieldMask);
+    Apc1_RecordLog_Put16(page + 24, log->recordCount);
+    Apc1_RecordLog_Put16(page + 26, Apc1_RecordLog_PageCrc(page, log->used));
+
+    result = Apc1_RecordLog_Program(log);
+    if (result != RESULT_OK)
+    {
+        return result;
+    }
+
+    if (log->sealedPages == 0)
+    {
+        log->tailPage = log->headPage;
+    }
+
+    log->sealedPages++;
+    log->headPage   = (log->headPage + 1) % log->pageCount;
+    log->programmed = 0;
+    log->pageSequence++;
+    Apc1_RecordLog_Begin(log, log->lastTimestamp);
+
+    return RESULT_OK;
+}
+
+static inline Result Apc1_RecordLog_Recover(Apc1_RecordLog* log)
+{
+    // A page which was flushed but not sealed has records, but an erased header. Its records are
+    // decoded to continue the open page; a record torn by a power loss ends it.
+    uint8_t* page = log->page;
+    Apc1_LogRecord record;
+    size_t length;
+
+    Result result = log->device.read(log->device.config, log->headPage * log->device.pageSize, page, log->device.pageSize);
+    if (result != RESULT_OK || Apc1_RecordLog_Get16(page) != 0xFFFF || page[APC1_RECORD_LOG_HEADER_SIZE] == APC1_RECORD_LOG_STREAM_END)
+    {
+        return result;
+    }
+
+    record.timestamp = 0;
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        record.values[field] = 0;
+    }
+
+    while ((length = Apc1_RecordLog_Decode(page + log->used, log->device.pageSize - log->used, log->fieldMask, &record)) != 0)
+    {
+        if (log->recordCount == 0)
+        {
+            log->firstTimestamp = record.timestamp;
+        }
+        log->used          += (uint16_t)length;
+        log->lastTimestamp  = record.timestamp;
+        log->recordCount++;
+        log->recordSequence++;
+    }
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        log->previous[field] = record.values[field];
+    }
+    log->programmed = log->used;
+
+    // the header stays erased until the page is sealed
+    for (uint8_t i = 0; i < APC1_RECORD_LOG_HEADER_SIZE; i++)
+    {
+        page[i] = 0xFF;
+    }
+
+    if (log->used < log->device.pageSize && page[log->used] != APC1_RECORD_LOG_STREAM_END)
+    {
+        // bytes of a torn record are programmed already; later records must not be programmed over them
+        result = Apc1_RecordLog_Seal(log);
+    }
+
+    return result;
+}
+
+static inline Result Apc1_RecordLog_Mount(Apc1_RecordLog* log, const ScioSense_Apc1_BlockDevice* device, uint8_t* page, const uint32_t fieldMask)
+{
+    bool found              = false;
+    uint32_t newestPage     = 0;
+    uint32_t newestSequence = 0;
+    uint32_t oldestPage     = 0;
+    uint32_t oldestSequence = 0;
+    Result result;
+
+    log->device             = *device;
+    log->page               = page;
+    log->fieldMask          = fieldMask & APC1_FIELD_MASK_ALL;
+    log->pageCount          = device->size / device->pageSize;
+    log->pagesPerBlock      = device->eraseSize / device->pageSize;
+    log->programmed         = 0;
+    log->erases             = 0;
+    log->corruptPages       = 0;
+
+    if (log->pageCount == 0 || log->pagesPerBlock == 0 || device->pageSize < APC1_RECORD_LOG_HEADER_SIZE + APC1_RECORD_LOG_MAX_RECORD_SIZE)
+    {
+        return RESULT_NOT_ALLOWED;
+    }
+
+    // A block is erased whole and filled in order, so the first page of each block orders the
+    // blocks; the pageSequence gives the order of the ring. A block is dropped whole, so the oldest
+    // page starts a block.
+    for (uint32_t p = 0; p < log->pageCount; p += log->pagesPerBlock)
+    {
+        result = Apc1_RecordLog_ReadHeader(log, p, page);
+        if (result == RESULT_IO_ERROR)
+        {
+            return result;
+        }
+
+        if (result == RESULT_OK)
+        {
+            const uint32_t sequence = Apc1_RecordLog_Get32(page + 4);
+            if (!found || (int32_t)(sequence - newestSequence) > 0)
+            {
+                newestSequence  = sequence;
+                newestPage      = p;
+            }
+            if (!found || (int32_t)(sequence - oldestSequence) < 0)
+            {
+                oldestSequence  = sequence;
+                oldestPage      = p;
+            }
+            found = true;
+        }
+    }
+
+    if (found)
+    {
+        // the pages of the newest block continue its first page up to the first erased one
+        const uint32_t first    = newestPage;
+        const uint32_t sequence = newestSequence;
+        uint32_t end            = first + log->pagesPerBlock;
+
+        while (end - newestPage > 1)
+        {
+            const uint32_t mid = newestPage + (end - newestPage) / 2;
+
+            result = Apc1_RecordLog_ReadHeader(log, mid, page);
+            if (result == RESULT_IO_ERROR)
+            {
+                return result;
+            }
+
+            if (result == RESULT_OK && Apc1_RecordLog_Get32(page + 4) == sequence + (mid - first))
+            {
+                newestPage = mid;
+            }
+            else
+            {
+                end = mid;
+            }
+        }
+        newestSequence = sequence + (newestPage - first);
+
+        Apc1_RecordLog_ReadHeader(log, newestPage, page);
+
+        log->headPage       = (newestPage + 1) % log->pageCount;
+        log->tailPage       = oldestPage;
+        log->sealedPages    = newestSequence - oldestSequence + 1;
+        log->sealedPages    = (log->sealedPages > log->pageCount) ? log->pageCount : log->sealedPages;
+        log->pageSequence   = newestSequence + 1;
+        log->recordSequence = Apc1_RecordLog_Get32(page + 8) + Apc1_RecordLog_Get16(page + 24);
+        Apc1_RecordLog_Begin(log, Apc1_RecordLog_Get32(page + 16));
+    }
+    else
+    {
+        log->headPage       = 0;
+        log->tailPage       = 0;
+        log->sealedPages    = 0;
+        log->pageSequence   = 1;
+        log->recordSequence = 0;
+        Apc1_RecordLog_Begin(log, 0);
+    }
+
+    return Apc1_RecordLog_Recover(log);
+}
+
+static inline Result Apc1_RecordLog_Append(Apc1_RecordLog* log, const uint8_t stream, const uint32_t timestamp, const uint8_t* measurementData)
+{
+    uint8_t record[APC1_RECORD_LOG_MAX_RECORD_SIZE];
+    uint8_t size;
+
+    if (stream == APC1_RECORD_LOG_STREAM_END)
+    {
+        return RESULT_NOT_ALLOWED;
+    }
+
+    if (log->recordCount == 0)
+    {
+        Apc1_RecordLog_Begin(log, timestamp);
+    }
+
+    size = Apc1_RecordLog_Encode(log, stream, timestamp, measurementData, record);
+    if (log->used + size > log->device.pageSize)
+    {
+        Result result = Apc1_RecordLog_Seal(log);
+        if (result != RESULT_OK)
+        {
+            return result;
+        }
+
+        Apc1_RecordLog_Begin(log, timestamp);
+        size = Apc1_RecordLog_Encode(log, stream, timestamp, measurementData, record);
+    }
+
+    uint8_t* data = log->page + log->used;
+    memcpy(data, record, size);
+    log->used          += size;
+    log->recordCount++;
+    log->recordSequence++;
+    log->lastTimestamp  = (timestamp > log->lastTimestamp) ? timestamp : log->lastTimestamp;
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (log->fieldMask & APC1_FIELD_MASK(field))
+        {
+            log->previous[field] = Apc1_GetFieldValue(measurementData, field);
+        }
+    }
+
+    return RESULT_OK;
+}
+
+static inline Result Apc1_RecordLog_Flush(Apc1_RecordLog* log)
+{
+    if (log->used == log->programmed)
+    {
+        return RESULT_OK;
+    }
+
+    // the header stays erased, so the page can still be sealed
+    for (uint8_t i = 0; i < APC1_RECORD_LOG_HEADER_SIZE; i++)
+    {
+        log->page[i] = 0xFF;
+    }
+
+    return Apc1_RecordLog_Program(log);
+}
+
+static inline uint32_t Apc1_RecordLog_FirstTimestamp(Apc1_RecordLog* log, const uint32_t logicalPage, uint8_t* header)
+{
+    if (logicalPage == log->sealedPages)
+    {
+        return log->firstTimestamp;
+    }
+
+    // corrupt headers sort first; their records are skipped when read
+    if (Apc1_RecordLog_ReadHeader(log, (log->tailPage + logicalPage) % log->pageCount, header) != RESULT_OK)
+    {
+        return 0;
+    }
+
+    return Apc1_RecordLog_Get32(header + 12);
+}
+
+static inline Result Apc1_RecordLog_Seek(Apc1_RecordLog* log, Apc1_RecordLogCursor* cursor, uint8_t* page, const uint32_t from)
+{
+    // binary search for the last page starting at or before from
+    uint32_t lo = 0;
+    uint32_t hi = log->sealedPages + ((log->recordCount > 0) ? 1 : 0);
+
+    while (hi - lo > 1)
+    {
+        const uint32_t mid = lo + (hi - lo) / 2;
+        if (Apc1_RecordLog_FirstTimestamp(log, mid, page) <= from)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    cursor->page        = page;
+    cursor->logicalPage = lo;
+    cursor->from        = from;
+    cursor->loaded      = false;
+    cursor->remaining   = 0;
+
+    return RESULT_OK;
+}
+
+static inline bool Apc1_RecordLog_Load(Apc1_RecordLog* log, Apc1_RecordLogCursor* cursor)
+{
+    uint8_t* page = cursor->page;
+
+    if (cursor->logicalPage == log->sealedPages)
+    {
+        // the open page is not programmed yet
+        memcpy(page, log->page, log->used);
+        cursor->fieldMask           = log->fieldMask;
+        cursor->remaining           = log->recordCount;
+        cursor->record.sequence     = log->recordSequence - log->recordCount;
+    }
+    else
+    {
+        const uint32_t physicalPage = (log->tailPage + cursor->logicalPage) % log->pageCount;
+        if (log->device.read(log->device.config, physicalPage * log->device.pageSize, page, log->device.pageSize) != RESULT_OK)
+        {
+            return false;
+        }
+
+        const uint16_t used = Apc1_RecordLog_Get16(page + 2);
+        if
+        (
+            Apc1_RecordLog_Get16(page) != APC1_RECORD_LOG_MAGIC
+         || used < APC1_RECORD_LOG_HEADER_SIZE
+         || used > log->device.pageSize
+         || Apc1_RecordLog_Get16(page + 26) != Apc1_RecordLog_PageCrc(page, used)
+        )
+        {
+            log->corruptPages++;
+            return false;
+        }
+
+        cursor->fieldMask           = Apc1_RecordLog_Get32(page + 20);
+        cursor->remaining           = Apc1_RecordLog_Get16(page + 24);
+        cursor->record.sequence     = Apc1_RecordLog_Get32(page + 8);
+    }
+
+    cursor->record.timestamp = 0;   // the first record holds its absolute timestamp
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        cursor->record.values[field] = 0;
+    }
+
+    cursor->record.sequence--;  // incremented per decoded record
+    cursor->offset = APC1_RECORD_LOG_HEADER_SIZE;
+    cursor->loaded = true;
+
+    return true;
+}
+
+static inline bool Apc1_RecordLog_Next(Apc1_RecordLog* log, Apc1_RecordLogCursor* cursor, Apc1_LogRecord* record)
+{
+    for (;;)
+    {
+        if (!cursor->loaded)
+        {
+            if (cursor->logicalPage > log->sealedPages || (cursor->logicalPage == log->sealedPages && log->recordCount == 0))
+            {
+                return false;
+            }
+
+            if (!Apc1_RecordLog_Load(log, cursor))
+            {
+                cursor->logicalPage++;
+                continue;
+            }
+        }
+
+        if (cursor->remaining == 0)
+        {
+            cursor->loaded = false;
+            cursor->logicalPage++;
+            continue;
+        }
+
+        const size_t length = Apc1_RecordLog_Decode(cursor->page + cursor->offset, log->device.pageSize - cursor->offset, cursor->fieldMask, &cursor->record);
+        if (length == 0)
+        {
+            // truncated record; skip the rest of the page
+            log->corruptPages++;
+            cursor->remaining = 0;
+            continue;
+        }
+
+        cursor->offset += (uint16_t)length;
+        cursor->remaining--;
+        cursor->record.sequence++;
+
+        if (cursor->record.timestamp >= cursor->from)
+        {
+            *record = cursor->record;
+            return true;
+        }
+    }
+}
+
+static inline void Apc1_RecordLog_ToMeasurementData(const Apc1_LogRecord* record, uint8_t* measurementData)
+{
+    // fields which were not stored are 0; with AQI not stored, Apc1_CheckMeasurementData rejects the frame
+    uint16_t checksum = 0;
+
+    for (uint8_t i = 0; i < APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH; i++)
+    {
+        measurementData[i] = 0;
+    }
+
+    measurementData[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_1]     = APC1_COMMAND_ADDRESS_START_BYTE_1;
+    measurementData[APC1_COMMAND_RESPONSE_START_BYTE_ADDRESS_2]     = APC1_COMMAND_ADDRESS_START_BYTE_2;
+    measurementData[APC1_COMMAND_RESPONSE_FRAME_LENGTH_ADDRESS_L]   = APC1_COMMAND_RESPONSE_MEASUREMENT_PAYLOAD_LENGTH;
+
+    for (uint8_t field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        Apc1_SetFieldValue(measurementData, field, record->values[field]);
+    }
+
+    for (uint8_t i = 0; i < APC1_RESULT_ADDRESS_CHECKSUM_H; i++)
+    {
+        checksum += measurementData[i];
+    }
+    measurementData[APC1_RESULT_ADDRESS_CHECKSUM_H] = (uint8_t)(checksum >> 8);
+    measurementData[APC1_RESULT_ADDRESS_CHECKSUM_L] = (uint8_t)checksum;
+}
+
+#undef memcpy
+
+#endif // SCIOSENSE_APC1_RECORD_LOG_C_INL
@@ -0,0 +1,41 @@
+#ifndef SCIOSENSE_APC1_SERIALIZER_C_H
+#define SCIOSENSE_APC1_SERIALIZER_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Formats a measurement frame as one line of text in a caller-provided buffer
+//
+// All fields of the field mask are written in one pass, without heap or printf, so a sample goes
+// out with a single write() instead of one print() per value. Temperature and humidity are
+// written with one decimal; all other fields are integers. Every line ends with '\n'.
+//
+//      CSV             12,15,...,21.3,45.0\n                       see Apc1_SerializeHeader
+//      JSON            {"pm1_0":12,"pm2_5":15,...}\n
+//      line protocol   apc1,room=lab pm1_0=12i,...,t_comp=21.3 1700000000000000000\n
+//
+// With hasTimestamp, the timestamp is written as the first CSV column (0 included, so the columns
+// stay aligned with the header), as "ts" in JSON and as the line protocol timestamp; it is written
+// as given, so its unit must match the consumer's precision. A line protocol point needs at least
+// one field, so an empty field mask writes nothing in that format.
+
+typedef uint8_t Apc1_Format;
+#define APC1_FORMAT_CSV                 (0)
+#define APC1_FORMAT_JSON                (1)
+#define APC1_FORMAT_LINE_PROTOCOL       (2)
+
+#define APC1_SERIALIZER_BUFFER_SIZE     (512)   // fits every format with all fields, a timestamp and up to 128 characters of measurement
+
+typedef struct Apc1_Serializer
+{
+    Apc1_Format     format;
+    uint32_t        fieldMask;                  // APC1_FIELD_MASK of the fields to write
+    bool            hasTimestamp;               // writes the timestamp given to Apc1_Serialize and the "ts" CSV column
+    const char*     measurement;                // line protocol measurement and tag set, e.g. "apc1,room=lab"; NULL selects "apc1"
+} Apc1_Serializer;
+
+static inline const char*   Apc1_GetFieldName       (const Apc1_Field field);                                                                                                   // returns the key of a field in JSON, line protocol and the CSV header
+static inline size_t        Apc1_Serialize          (const Apc1_Serializer* serializer, const uint8_t* measurementData, const uint64_t timestamp, char* buffer, const size_t size);  // returns the length of the line without the terminating 0; 0 if the buffer is too small, or for line protocol without fields
+static inline size_t        Apc1_SerializeHeader    (const Apc1_Serializer* serializer, char* buffer, const size_t size);                                                      // writes the CSV header line; returns its length, 0 if the buffer is too small
+
+#include "ScioSense_Apc1_Serializer.inl.h"
+#endif // SCIOSENSE_APC1_SERIALIZER_C_H
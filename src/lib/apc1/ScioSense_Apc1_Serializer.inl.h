@@ -0,0 +1,262 @@
+#ifndef SCIOSENSE_APC1_SERIALIZER_C_INL
+#define SCIOSENSE_APC1_SERIALIZER_C_INL
+
+#include "ScioSense_Apc1_Serializer.h"
+
+typedef struct Apc1_SerializerOutput
+{
+    char*   position;
+    char*   end;                                // one before the end of the buffer; keeps room for the terminating 0
+    bool    overflow;
+} Apc1_SerializerOutput;
+
+static inline const char* Apc1_GetFieldName(const Apc1_Field field)
+{
+    static const char* const names[APC1_FIELD_COUNT] =
+    {
+        "pm1_0", "pm2_5", "pm10", "pm1_0_air", "pm2_5_air", "pm10_air",
+        "n0_3", "n0_5", "n1_0", "n2_5", "n5_0", "n10",
+        "tvoc", "eco2", "no2", "t_comp", "rh_comp", "t_raw", "rh_raw",
+        "rs0", "rs1", "rs2", "rs3", "aqi", "error"
+    };
+
+    return (field < APC1_FIELD_COUNT) ? names[field] : "";
+}
+
+static inline bool Apc1_SerializerHasDecimal(const Apc1_Field field)
+{
+    return field >= APC1_FIELD_T_COMP && field <= APC1_FIELD_RH_RAW;
+}
+
+static inline void Apc1_SerializerPutChar(Apc1_SerializerOutput* out, const char c)
+{
+    if (out->position < out->end)
+    {
+        *out->position++ = c;
+    }
+    else
+    {
+        out->overflow = true;
+    }
+}
+
+static inline void Apc1_SerializerPutString(Apc1_SerializerOutput* out, const char* text)
+{
+    while (*text)
+    {
+        Apc1_SerializerPutChar(out, *text++);
+    }
+}
+
+static inline void Apc1_SerializerPutUInt(Apc1_SerializerOutput* out, uint32_t value, const uint8_t minDigits)
+{
+    // counts the digits first and fills them backwards; no reversal, no 64 bit division
+    uint8_t digits  = 1;
+    uint32_t limit  = 10;
+    while (digits < 10 && value >= limit)
+    {
+        digits++;
+        limit = (digits < 10) ? limit * 10 : limit;
+    }
+    digits = (digits < minDigits) ? minDigits : digits;
+
+    if (out->end - out->position < digits)
+    {
+        out->overflow = true;
+        return;
+    }
+
+    char* p = out->position + digits;
+    if (value <= 0xFFFF)
+    {
+        uint16_t small = (uint16_t)value;       // 16 bit division is much cheaper on 8 bit targets
+        while (p > out->position)
+        {
+            *--p = (char)('0' + small % 10);
+            small /= 10;
+        }
+    }
+    else
+    {
+        while (p > out->position)
+        {
+            *--p = (char)('0' + value % 10);
+            value /= 10;
+        }
+    }
+    out->position += digits;
+}
+
+static inline void Apc1_SerializerPutUInt64(Apc1_SerializerOutput* out, const uint64_t value)
+{
+    if (value <= 0xFFFFFFFF)
+    {
+        Apc1_SerializerPutUInt(out, (uint32_t)value, 1);
+    }
+    else if (value < 1000000000ULL * 1000000000ULL)
+    {
+        Apc1_SerializerPutUInt(out, (uint32_t)(value / 1000000000), 1);
+        Apc1_SerializerPutUInt(out, (uint32_t)(value % 1000000000), 9);
+    }
+    else
+    {
+        Apc1_SerializerPutUInt(out, (uint32_t)(value / 1000000000000000000ULL), 1);
+        Apc1_SerializerPutUInt(out, (uint32_t)(value / 1000000000 % 1000000000), 9);
+        Apc1_SerializerPutUInt(out, (uint32_t)(value % 1000000000), 9);
+    }
+}
+
+static inline void Apc1_SerializerPutValue(Apc1_SerializerOutput* out, const Apc1_Field field, const uint32_t value)
+{
+    if (Apc1_SerializerHasDecimal(field))
+    {
+        // T and RH are in 0.1 units
+        Apc1_SerializerPutUInt(out, value / 10, 1);
+        Apc1_SerializerPutChar(out, '.');
+        Apc1_SerializerPutChar(out, (char)('0' + value % 10));
+    }
+    else
+    {
+        Apc1_SerializerPutUInt(out, value, 1);
+    }
+}
+
+static inline size_t Apc1_SerializerFinish(Apc1_SerializerOutput* out, char* buffer)
+{
+    Apc1_SerializerPutChar(out, '\n');
+    if (out->overflow)
+    {
+        buffer[0] = 0;
+        return 0;
+    }
+
+    *out->position = 0;
+    return (size_t)(out->position - buffer);
+}
+
+static inline size_t Apc1_Serialize(const Apc1_Serializer* serializer, const uint8_t* measurementData, const uint64_t timestamp, char* buffer, const size_t size)
+{
+    Apc1_SerializerOutput out;
+    bool first = true;
+
+    if (size == 0 || (serializer->format == APC1_FORMAT_LINE_PROTOCOL && (serializer->fieldMask & APC1_FIELD_MASK_ALL) == 0))
+    {
+        return 0;
+    }
+
+    out.position    = buffer;
+    out.end         = buffer + size - 1;
+    out.overflow    = false;
+
+    if (serializer->format == APC1_FORMAT_CSV)
+    {
+        if (serializer->hasTimestamp)
+        {
+            Apc1_SerializerPutUInt64(&out, timestamp);
+            first = false;
+        }
+    }
+    else if (serializer->format == APC1_FORMAT_JSON)
+    {
+        Apc1_SerializerPutChar(&out, '{');
+        if (serializer->hasTimestamp)
+        {
+            Apc1_SerializerPutString(&out, "\"ts\":");
+            Apc1_SerializerPutUInt64(&out, timestamp);
+            first = false;
+        }
+    }
+    else
+    {
+        Apc1_SerializerPutString(&out, serializer->measurement ? serializer->measurement : "apc1");
+        Apc1_SerializerPutChar(&out, ' ');
+    }
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (!(serializer->fieldMask & APC1_FIELD_MASK(field)))
+        {
+            continue;
+        }
+
+        if (!first)
+        {
+            Apc1_SerializerPutChar(&out, ',');
+        }
+        first = false;
+
+        const uint32_t value = Apc1_GetFieldValue(measurementData, field);
+        switch (serializer->format)
+        {
+            case APC1_FORMAT_CSV:
+                Apc1_SerializerPutValue(&out, field, value);
+                break;
+
+            case APC1_FORMAT_JSON:
+                Apc1_SerializerPutChar(&out, '"');
+                Apc1_SerializerPutString(&out, Apc1_GetFieldName(field));
+                Apc1_SerializerPutString(&out, "\":");
+                Apc1_SerializerPutValue(&out, field, value);
+                break;
+
+            default:
+                Apc1_SerializerPutString(&out, Apc1_GetFieldName(field));
+                Apc1_SerializerPutChar(&out, '=');
+                Apc1_SerializerPutValue(&out, field, value);
+                if (!Apc1_SerializerHasDecimal(field))
+                {
+                    Apc1_SerializerPutChar(&out, 'i');
+                }
+                break;
+        }
+    }
+
+    if (serializer->format == APC1_FORMAT_JSON)
+    {
+        Apc1_SerializerPutChar(&out, '}');
+    }
+    else if (serializer->format == APC1_FORMAT_LINE_PROTOCOL && serializer->hasTimestamp)
+    {
+        Apc1_SerializerPutChar(&out, ' ');
+        Apc1_SerializerPutUInt64(&out, timestamp);
+    }
+
+    return Apc1_SerializerFinish(&out, buffer);
+}
+
+static inline size_t Apc1_SerializeHeader(const Apc1_Serializer* serializer, char* buffer, const size_t size)
+{
+    Apc1_SerializerOutput out;
+    bool first = !serializer->hasTimestamp;
+
+    if (size == 0)
+    {
+        return 0;
+    }
+
+    out.position    = buffer;
+    out.end         = buffer + size - 1;
+    out.overflow    = false;
+
+    if (serializer->hasTimestamp)
+    {
+        Apc1_SerializerPutString(&out, "ts");
+    }
+
+    for (Apc1_Field field = 0; field < APC1_FIELD_COUNT; field++)
+    {
+        if (serializer->fieldMask & APC1_FIELD_MASK(field))
+        {
+            if (!first)
+            {
+                Apc1_SerializerPutChar(&out, ',');
+            }
+            first = false;
+            Apc1_SerializerPutString(&out, Apc1_GetFieldName(field));
+        }
+    }
+
+    return Apc1_SerializerFinish(&out, buffer);
+}
+
+#endif // SCIOSENSE_APC1_SERIALIZER_C_INL
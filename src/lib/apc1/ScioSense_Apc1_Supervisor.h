@@ -0,0 +1,89 @@
+#ifndef SCIOSENSE_APC1_SUPERVISOR_C_H
+#define SCIOSENSE_APC1_SUPERVISOR_C_H
+
+#include "ScioSense_Apc1.h"
+
+//// Automatic recovery of a failing APC1
+//
+// Apc1_Supervisor_Update wraps Apc1_Update and classifies its failures:
+//
+//      transport   RESULT_IO_ERROR                                     recovery starts at CLEAR
+//      checksum    RESULT_CHECKSUM_ERROR, RESULT_INVALID               recovery starts at RESYNC
+//      fault       valid frames with one of the faultMask bits set     recovery starts at POWER_CYCLE
+//
+// After failureThreshold failed updates (or faultThreshold fault frames) in a row, it runs the
+// next recovery action and escalates with every further action:
+//
+//      CLEAR           clears the IO buffers
+//      RESYNC          clears, waits until the line is quiet and clears again
+//      MODES           re-issues the operating and measurement mode commands
+//      RESET           Apc1_Reset; the measurement mode is restored
+//      POWER_CYCLE     idle (fan off), one measurement interval, standard mode
+//
+// Recovery actions are spaced by an exponential backoff. If the sensor still fails after a power
+// cycle, the circuit breaker opens: updates return RESULT_NOT_ALLOWED without any IO, so a dead
+// sensor costs nothing, until a cooldown (doubling up to cooldownMax) has passed. Then a single
+// trial with Apc1_Reset closes the breaker on success; after a failure, or an update which says
+// nothing about the health (e.g. RESULT_NO_NEW_DATA), it opens it again.
+//
+// The first valid frame without fault bits returns the supervisor to healthy. Recovery actions
+// block for as long as the commands they send; all times are ms of the same clock, e.g. millis().
+
+typedef uint8_t Apc1_FailureClass;
+#define APC1_FAILURE_NONE               (0)
+#define APC1_FAILURE_TRANSPORT          (1)
+#define APC1_FAILURE_CHECKSUM           (2)
+#define APC1_FAILURE_FAULT              (3)
+
+typedef uint8_t Apc1_RecoveryAction;
+#define APC1_RECOVERY_CLEAR             (0)
+#define APC1_RECOVERY_RESYNC            (1)
+#define APC1_RECOVERY_MODES             (2)
+#define APC1_RECOVERY_RESET             (3)
+#define APC1_RECOVERY_POWER_CYCLE       (4)
+#define APC1_RECOVERY_ACTIONS           (5)
+
+typedef uint8_t Apc1_SupervisorState;
+#define APC1_SUPERVISOR_STATE_HEALTHY   (0)
+#define APC1_SUPERVISOR_STATE_RECOVERING (1)
+#define APC1_SUPERVISOR_STATE_OPEN      (2)     // circuit breaker open; the sensor is not polled
+
+// faults which an idle/wake cycle of the fan may resolve
+#define APC1_SUPERVISOR_DEFAULT_FAULT_MASK  (APC1_ERROR_CODE_TOO_MANY_FAN_RESTARTS | APC1_ERROR_CODE_FAN_SPEED_TOO_LOW | APC1_ERROR_CODE_FAN_STARTUP_ERROR)
+
+typedef struct Apc1_SupervisorConfig
+{
+    uint8_t         failureThreshold;           // failed updates in a row before a recovery action
+    uint8_t         faultThreshold;             // fault frames in a row before a recovery action
+    Apc1_ErrorCode  faultMask;                  // Apc1_ErrorCode bits treated as faults
+    uint32_t        backoffMin;                 // ms after the first recovery action
+    uint32_t        backoffMax;
+    uint32_t        cooldownMin;                // ms the breaker stays open the first time
+    uint32_t        cooldownMax;
+} Apc1_SupervisorConfig;
+
+typedef struct Apc1_Supervisor
+{
+    Apc1_SupervisorConfig   config;
+    Apc1_SupervisorState    state;
+    Apc1_FailureClass       lastFailure;
+    Apc1_RecoveryAction     nextAction;                                 // action of the next recovery
+    uint8_t                 failures;                                   // failed updates in a row
+    uint8_t                 faults;                                     // fault frames in a row
+    uint32_t                backoff;                                    // ms to the next recovery action
+    uint32_t                nextRecovery;                               // ms at which the next recovery action may run
+    uint32_t                cooldown;                                   // ms the breaker stays open the next time
+    uint32_t                retryAt;                                    // ms at which an open breaker allows a trial
+    uint32_t                recoveries[APC1_RECOVERY_ACTIONS];          // recovery actions run, per action
+    uint32_t                failuresByClass[APC1_FAILURE_FAULT + 1];    // failed updates and fault frames, per Apc1_FailureClass
+    uint32_t                breakerOpens;
+    uint32_t                skippedUpdates;                             // updates refused while the breaker was open
+} Apc1_Supervisor;
+
+static inline void      Apc1_Supervisor_DefaultConfig   (Apc1_SupervisorConfig* config);                                          // 3 failures, 1 s to 1 min backoff, 1 min to 1 h cooldown
+static inline void      Apc1_Supervisor_Init            (Apc1_Supervisor* supervisor, const Apc1_SupervisorConfig* config);       // starts healthy with all counters at zero
+static inline Result    Apc1_Supervisor_Update          (Apc1_Supervisor* supervisor, ScioSense_Apc1* apc1, const uint32_t now);  // Apc1_Update with recovery; RESULT_NOT_ALLOWED without IO while the breaker is open
+static inline bool      Apc1_Supervisor_IsAvailable     (const Apc1_Supervisor* supervisor, const uint32_t now);                  // returns false, while the breaker is open and its cooldown has not passed
+
+#include "ScioSense_Apc1_Supervisor.inl.h"
+#endif // SCIOSENSE_APC1_SUPERVISOR_C_H
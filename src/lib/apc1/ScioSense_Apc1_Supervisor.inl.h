@@ -0,0 +1,218 @@
+#ifndef SCIOSENSE_APC1_SUPERVISOR_C_INL
+#define SCIOSENSE_APC1_SUPERVISOR_C_INL
+
+#include "ScioSense_Apc1_Supervisor.h"
+
+static inline void Apc1_Supervisor_DefaultConfig(Apc1_SupervisorConfig* config)
+{
+    config->failureThreshold    = 3;
+    config->faultThreshold      = 3;
+    config->faultMask           = APC1_SUPERVISOR_DEFAULT_FAULT_MASK;
+    config->backoffMin          = 1000;
+    config->backoffMax          = 60000;
+    config->cooldownMin         = 60000;
+    config->cooldownMax         = 3600000;
+}
+
+static inline void Apc1_Supervisor_Init(Apc1_Supervisor* supervisor, const Apc1_SupervisorConfig* config)
+{
+    supervisor->config          = *config;
+    supervisor->state           = APC1_SUPERVISOR_STATE_HEALTHY;
+    supervisor->lastFailure     = APC1_FAILURE_NONE;
+    supervisor->nextAction      = APC1_RECOVERY_CLEAR;
+    supervisor->failures        = 0;
+    supervisor->faults          = 0;
+    supervisor->backoff         = config->backoffMin;
+    supervisor->nextRecovery    = 0;
+    supervisor->cooldown        = config->cooldownMin;
+    supervisor->retryAt         = 0;
+    supervisor->breakerOpens    = 0;
+    supervisor->skippedUpdates  = 0;
+
+    for (uint8_t i = 0; i < APC1_RECOVERY_ACTIONS; i++)
+    {
+        supervisor->recoveries[i] = 0;
+    }
+    for (uint8_t i = 0; i <= APC1_FAILURE_FAULT; i++)
+    {
+        supervisor->failuresByClass[i] = 0;
+    }
+}
+
+static inline bool Apc1_Supervisor_IsAvailable(const Apc1_Supervisor* supervisor, const uint32_t now)
+{
+    return supervisor->state != APC1_SUPERVISOR_STATE_OPEN || (int32_t)(now - supervisor->retryAt) >= 0;
+}
+
+static inline void Apc1_Supervisor_Recover(ScioSense_Apc1* apc1, const Apc1_RecoveryAction action)
+{
+    const Apc1_MeasurementMode measurementMode = apc1->measurementMode;
+
+    switch (action)
+    {
+        case APC1_RECOVERY_CLEAR:
+            if (apc1->io.clear) { apc1->io.clear(apc1->io.config); }
+#ifndef APC1_NO_STATS
+            apc1->stats.resyncs++;
+#endif
+            break;
+
+        case APC1_RECOVERY_RESYNC:
+            // drops a frame which is still on the line
+            if (apc1->io.clear) { apc1->io.clear(apc1->io.config); }
+            apc1->io.wait(APC1_SYSTEM_TIMING_COMMAND_EXEC);
+            if (apc1->io.clear) { apc1->io.clear(apc1->io.config); }
+#ifndef APC1_NO_STATS
+            apc1->stats.resyncs++;
+#endif
+            break;
+
+        case APC1_RECOVERY_MODES:
+            Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD);
+            Apc1_SetMeasurementMode(apc1, measurementMode);
+            break;
+
+        case APC1_RECOVERY_RESET:
+            Apc1_Reset(apc1);
+            if (apc1->measurementMode != measurementMode)
+            {
+                Apc1_SetMeasurementMode(apc1, measurementMode);
+            }
+            break;
+
+        default:
+            Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_IDLE);
+            apc1->io.wait(APC1_SYSTEM_TIMING_STANDARD_MEASURE);
+            Apc1_SetOperatingMode(apc1, APC1_OPERATING_MODE_STANDARD);
+            Apc1_SetMeasurementMode(apc1, measurementMode);
+            break;
+    }
+
+    // the next frame must not be suppressed as a duplicate of the one before the recovery
+    Apc1_ForgetFrame(apc1);
+}
+
+static inline void Apc1_Supervisor_Open(Apc1_Supervisor* supervisor, const uint32_t now)
+{
+    supervisor->state       = APC1_SUPERVISOR_STATE_OPEN;
+    supervisor->retryAt     = now + supervisor->cooldown;
+    supervisor->cooldown    = (supervisor->cooldown > supervisor->config.cooldownMax / 2) ? supervisor->config.cooldownMax : supervisor->cooldown * 2;
+    supervisor->breakerOpens++;
+}
+
+static inline void Apc1_Supervisor_Heal(Apc1_Supervisor* supervisor)
+{
+    supervisor->state       = APC1_SUPERVISOR_STATE_HEALTHY;
+    supervisor->lastFailure = APC1_FAILURE_NONE;
+    supervisor->nextAction  = APC1_RECOVERY_CLEAR;
+    supervisor->failures    = 0;
+    supervisor->faults      = 0;
+    supervisor->backoff     = supervisor->config.backoffMin;
+    supervisor->cooldown    = supervisor->config.cooldownMin;
+}
+
+static inline Result Apc1_Supervisor_Update(Apc1_Supervisor* supervisor, ScioSense_Apc1* apc1, const uint32_t now)
+{
+    Apc1_FailureClass failure;
+    Result result;
+
+    if (supervisor->state == APC1_SUPERVISOR_STATE_OPEN)
+    {
+        if ((int32_t)(now - supervisor->retryAt) < 0)
+        {
+            supervisor->skippedUpdates++;
+            return RESULT_NOT_ALLOWED;
+        }
+
+        // trial: the sensor may have been replaced or powered up again
+        Apc1_Supervisor_Recover(apc1, APC1_RECOVERY_RESET);
+        supervisor->recoveries[APC1_RECOVERY_RESET]++;
+    }
+
+    result = Apc1_Update(apc1);
+
+    switch (result)
+    {
+        case RESULT_OK:
+            failure = (apc1->measurementData[APC1_RESULT_ADDRESS_ERROR_CODE] & supervisor->config.faultMask) ? APC1_FAILURE_FAULT : APC1_FAILURE_NONE;
+            break;
+        case RESULT_IO_ERROR:
+            failure = APC1_FAILURE_TRANSPORT;
+            break;
+        case RESULT_CHECKSUM_ERROR:
+        case RESULT_INVALID:
+            failure = APC1_FAILURE_CHECKSUM;
+            break;
+        default:
+            // duplicates and updates in idle mode say nothing about the health; a trial without a
+            // verdict keeps the breaker open for another cooldown, so the next call does not reset again
+            if (supervisor->state == APC1_SUPERVISOR_STATE_OPEN)
+            {
+                Apc1_Supervisor_Open(supervisor, now);
+            }
+            return result;
+    }
+
+    if (failure == APC1_FAILURE_NONE)
+    {
+        Apc1_Supervisor_Heal(supervisor);
+        return result;
+    }
+
+    supervisor->failuresByClass[failure]++;
+    supervisor->lastFailure = failure;
+    if (failure == APC1_FAILURE_FAULT)
+    {
+        supervisor->faults++;
+        supervisor->failures = 0;
+    }
+    else
+    {
+        supervisor->failures++;
+        supervisor->faults = 0;
+    }
+
+    if (supervisor->state == APC1_SUPERVISOR_STATE_OPEN)
+    {
+        // the trial failed
+        Apc1_Supervisor_Open(supervisor, now);
+        return result;
+    }
+
+    if (supervisor->failures < supervisor->config.failureThreshold && supervisor->faults < supervisor->config.faultThreshold)
+    {
+        return result;
+    }
+
+    if (supervisor->state == APC1_SUPERVISOR_STATE_RECOVERING && (int32_t)(now - supervisor->nextRecovery) < 0)
+    {
+        return result;
+    }
+
+    if (supervisor->nextAction >= APC1_RECOVERY_ACTIONS)
+    {
+        // every action failed
+        Apc1_Supervisor_Open(supervisor, now);
+        return result;
+    }
+
+    // escalates from the first action suitable for the failure
+    if (supervisor->state == APC1_SUPERVISOR_STATE_HEALTHY)
+    {
+        supervisor->nextAction  = (failure == APC1_FAILURE_FAULT) ? APC1_RECOVERY_POWER_CYCLE : (failure == APC1_FAILURE_CHECKSUM) ? APC1_RECOVERY_RESYNC : APC1_RECOVERY_CLEAR;
+        supervisor->backoff     = supervisor->config.backoffMin;
+        supervisor->state       = APC1_SUPERVISOR_STATE_RECOVERING;
+    }
+
+    Apc1_Supervisor_Recover(apc1, supervisor->nextAction);
+    supervisor->recoveries[supervisor->nextAction]++;
+    supervisor->nextAction++;
+    supervisor->failures        = 0;
+    supervisor->faults          = 0;
+    supervisor->nextRecovery    = now + supervisor->backoff;
+    supervisor->backoff         = (supervisor->backoff > supervisor->config.backoffMax / 2) ? supervisor->config.backoffMax : supervisor->backoff * 2;
+
+    return result;
+}
+
+#endif // SCIOSENSE_APC1_SUPERVISOR_C_INL
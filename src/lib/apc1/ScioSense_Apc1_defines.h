@@ -38,6 +38,37 @@ typedef uint8_t ResultAddress;
 #define APC1_RESULT_ADDRESS_CHECKSUM_H                  (0x3E)       // Frame (0x00 – 0x3D) checksum High byte
 #define APC1_RESULT_ADDRESS_CHECKSUM_L                  (0x3F)       // Frame (0x00 – 0x3D) checksum Low byte
 
+//// Measurement fields; generic access to the values of the measurement data struct with Apc1_GetFieldValue
+typedef uint8_t Apc1_Field;
+#define APC1_FIELD_PM_1_0                               (0)
+#define APC1_FIELD_PM_2_5                               (1)
+#define APC1_FIELD_PM_10                                (2)
+#define APC1_FIELD_PMINAIR_1_0                          (3)
+#define APC1_FIELD_PMINAIR_2_5                          (4)
+#define APC1_FIELD_PMINAIR_10                           (5)
+#define APC1_FIELD_NOPARTICLES_0_3                      (6)
+#define APC1_FIELD_NOPARTICLES_0_5                      (7)
+#define APC1_FIELD_NOPARTICLES_1_0                      (8)
+#define APC1_FIELD_NOPARTICLES_2_5                      (9)
+#define APC1_FIELD_NOPARTICLES_5_0                      (10)
+#define APC1_FIELD_NOPARTICLES_10                       (11)
+#define APC1_FIELD_TVOC                                 (12)
+#define APC1_FIELD_ECO2                                 (13)
+#define APC1_FIELD_NO2                                  (14)
+#define APC1_FIELD_T_COMP                               (15)        // in 0.1 °C
+#define APC1_FIELD_RH_COMP                              (16)        // in 0.1 %
+#define APC1_FIELD_T_RAW                                (17)        // in 0.1 °C
+#define APC1_FIELD_RH_RAW                               (18)        // in 0.1 %
+#define APC1_FIELD_RS0                                  (19)
+#define APC1_FIELD_RS1                                  (20)
+#define APC1_FIELD_RS2                                  (21)
+#define APC1_FIELD_RS3                                  (22)
+#define APC1_FIELD_AQI                                  (23)
+#define APC1_FIELD_ERROR_CODE                           (24)
+#define APC1_FIELD_COUNT                                (25)
+#define APC1_FIELD_MASK(field)                          (1UL << (field))
+#define APC1_FIELD_MASK_ALL                             ((1UL << APC1_FIELD_COUNT) - 1)
+
 //// I2C interface register addresses
 #define APC1_REGISTER_ADDRESS_COMMAND_WRITE             (0x40)
 #define APC1_REGISTER_ADDRESS_COMMAND_RESULT            (0x47)
@@ -91,6 +122,7 @@ typedef const uint8_t Apc1_Command[APC1_COMMAND_LENGTH];
 typedef uint8_t Apc1_CommandResponse;
 #define APC1_COMMAND_RESPONSE_DEFAULT_LENGTH                (8)     // Command response default length
 #define APC1_COMMAND_RESPONSE_SENSOR_VERSION_LENGTH         (23)    // Command response length for "ReadSensorVersion" command
+#define APC1_COMMAND_RESPONSE_SENSOR_VERSION_PAYLOAD_LENGTH (19)    // Sensor version struct payload length
 #define APC1_COMMAND_RESPONSE_MODULE_NAME_LENGTH            (6)    // Command response length for the module name part of the "ReadSensorVersion" command
 #define APC1_COMMAND_RESPONSE_MEASUREMENT_LENGTH            (64)    // Command response length for "RequestMeasurement" command
 #define APC1_COMMAND_RESPONSE_MEASUREMENT_PAYLOAD_LENGTH    (60)    // Measurement data struct payload length
@@ -102,6 +134,20 @@ typedef uint8_t Apc1_CommandResponse;
 #define APC1_COMMAND_RESPONSE_COMMAND_ADDRESS               (4)    // Command address
 #define APC1_COMMAND_RESPONSE_DATA_ADDRESS                  (5)    // Data start address
 
+//// Update options
+typedef uint8_t Apc1_UpdateOption;
+#define APC1_UPDATE_OPTION_NONE                 (0)
+#define APC1_UPDATE_OPTION_SUPPRESS_DUPLICATES  (1 << 0)    // Apc1_Update returns RESULT_NO_NEW_DATA if the frame checksum and CRC equal the previous ones
+#define APC1_UPDATE_OPTION_PEEK_CHECKSUM        (1 << 1)    // I2C only; reads the 2 checksum bytes first and skips the 64 byte read if unchanged; a pre-filter which misses compensating byte changes
+
+//// Identity cache states
+typedef uint8_t Apc1_IdentityState;
+#define APC1_IDENTITY_STATE_READ                (0)         // identity was read from the device
+#define APC1_IDENTITY_STATE_CACHED              (1)         // identity was loaded from the cache; not yet validated with a measurement frame
+#define APC1_IDENTITY_STATE_VALIDATED           (2)         // cached identity matches the low byte of the firmware version in a measurement frame
+#define APC1_IDENTITY_STATE_MISMATCH            (3)         // cached identity does not match a measurement frame; the next Apc1_Reset reads it from the device
+#define APC1_IDENTITY_CHECKSUM_SEED             (0xA5)
+
 //// IO Protocol
 typedef uint8_t Apc1_Protocol;
 #define APC1_PROTOCOL_UART      (0)
@@ -110,6 +156,20 @@ typedef uint8_t Apc1_Protocol;
 //// SystemTiming in ms
 #define APC1_SYSTEM_TIMING_STANDARD_MEASURE     (1000)
 #define APC1_SYSTEM_TIMING_COMMAND_EXEC         (200)
+#define APC1_SYSTEM_TIMING_POLL_INTERVAL        (10)        // default interval of readiness polls
+
+//// UART stream realignment
+#define APC1_UART_REALIGN_LIMIT                 (64)        // max bytes Apc1_Update skips per call to find the start of a frame
+
+//// Refresh phase tracking in ms
+#define APC1_PHASE_LOCK_WINDOW                  (100)       // the refresh phase is considered known, if its uncertainty window is smaller
+#define APC1_PHASE_REQUEST_MARGIN               (20)        // requests are scheduled this long after the latest possible refresh
+#define APC1_PHASE_DRIFT_ALLOWANCE              (2)         // widening of the phase window per elapsed period to follow clock drift
+#define APC1_SAMPLE_AGE_UNKNOWN                 (0xFFFFFFFF)
+
+//// Statistics
+#define APC1_STATS_LATENCY_BUCKETS              (12)        // log2 latency histogram buckets in ms: [0,1), [1,2), [2,4), ... , [1024,inf)
+#define APC1_STATS_ERROR_CODE_BITS              (7)         // number of Apc1_ErrorCode bits counted
 
 //// UBA Air Quality Index
 #ifndef SCIOSENSE_AQI_UBA_CODES
@@ -134,4 +194,8 @@ typedef int8_t Result;
 #define RESULT_OK               (0)     // All OK; The value was read, the checksum matches, and data is valid.
 #endif
 
+#ifndef RESULT_NO_NEW_DATA
+#define RESULT_NO_NEW_DATA      (5)     // The value was read and is valid, but it is the same as the previous one.
+#endif
+
 #endif // SCIOSENSE_APC1_DEFINES_C_H
\ No newline at end of file
@@ -68,4 +68,9 @@ static inline void ScioSense_Arduino_I2c_Wait(uint32_t ms)
     delay(ms);
 }
 
+static inline uint32_t ScioSense_Arduino_I2c_Millis()
+{
+    return millis();
+}
+
 #endif // SCIOSENSE_IO_INTERFACE_ARDUINO_I2C_H
\ No newline at end of file
@@ -54,4 +54,9 @@ static inline void ScioSense_Arduino_Serial_Wait(uint32_t ms)
     delay(ms);
 }
 
+static inline uint32_t ScioSense_Arduino_Serial_Millis()
+{
+    return millis();
+}
+
 #endif // SCIOSENSE_IO_INTERFACE_ARDUINO_SERIAL_H
\ No newline at end of file
@@ -0,0 +1,102 @@
+#ifndef SCIOSENSE_IO_INTERFACE_POSIX_FILE_H
+#define SCIOSENSE_IO_INTERFACE_POSIX_FILE_H
+
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//// Block device implementation backed by a file; emulates a flash part for host tests and tools
+
+typedef struct ScioSense_Posix_File_Config
+{
+    int         fd;
+    uint32_t    eraseSize;
+} ScioSense_Posix_File_Config;
+
+// Opens or creates the file; a new file is sized and filled like an erased flash (0xFF)
+static inline int8_t ScioSense_Posix_File_Open(ScioSense_Posix_File_Config* config, const char* path, const uint32_t size, const uint32_t eraseSize)
+{
+    struct stat info;
+    uint8_t erased[256];
+
+    config->eraseSize   = eraseSize;
+    config->fd          = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (config->fd < 0 || fstat(config->fd, &info) != 0)
+    {
+        return 1; // RESULT_IO_ERROR;
+    }
+
+    for (size_t i = 0; i < sizeof(erased); i++)
+    {
+        erased[i] = 0xFF;
+    }
+
+    for (uint32_t address = (uint32_t)info.st_size; address < size; address += sizeof(erased))
+    {
+        const size_t n = (size - address < sizeof(erased)) ? size - address : sizeof(erased);
+        if (pwrite(config->fd, erased, n, address) != (ssize_t)n)
+        {
+            return 1; // RESULT_IO_ERROR;
+        }
+    }
+
+    return 0; // RESULT_OK;
+}
+
+static inline void ScioSense_Posix_File_Close(ScioSense_Posix_File_Config* config)
+{
+    if (config->fd >= 0)
+    {
+        close(config->fd);
+        config->fd = -1;
+    }
+}
+
+static inline int8_t ScioSense_Posix_File_Read(void* config, const uint32_t address, uint8_t* data, const size_t size)
+{
+    ScioSense_Posix_File_Config* _config = (ScioSense_Posix_File_Config*)config;
+
+    if (pread(_config->fd, data, size, address) == (ssize_t)size)
+    {
+        return 0; // RESULT_OK
+    }
+
+    return 1; // RESULT_IO_ERROR;
+}
+
+static inline int8_t ScioSense_Posix_File_Program(void* config, const uint32_t address, const uint8_t* data, const size_t size)
+{
+    ScioSense_Posix_File_Config* _config = (ScioSense_Posix_File_Config*)config;
+
+    if (pwrite(_config->fd, data, size, address) == (ssize_t)size)
+    {
+        return 0; // RESULT_OK
+    }
+
+    return 1; // RESULT_IO_ERROR;
+}
+
+static inline int8_t ScioSense_Posix_File_Erase(void* config, const uint32_t address)
+{
+    ScioSense_Posix_File_Config* _config = (ScioSense_Posix_File_Config*)config;
+    uint8_t erased[256];
+
+    for (size_t i = 0; i < sizeof(erased); i++)
+    {
+        erased[i] = 0xFF;
+    }
+
+    for (uint32_t offset = 0; offset < _config->eraseSize; offset += sizeof(erased))
+    {
+        const size_t n = (_config->eraseSize - offset < sizeof(erased)) ? _config->eraseSize - offset : sizeof(erased);
+        if (pwrite(_config->fd, erased, n, address + offset) != (ssize_t)n)
+        {
+            return 1; // RESULT_IO_ERROR;
+        }
+    }
+
+    return 0; // RESULT_OK
+}
+
+#endif // SCIOSENSE_IO_INTERFACE_POSIX_FILE_H
@@ -0,0 +1,165 @@
+#ifndef SCIOSENSE_IO_INTERFACE_POSIX_TERMIOS_H
+#define SCIOSENSE_IO_INTERFACE_POSIX_TERMIOS_H
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdint.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+//// IO Interface implementation for serial ports on Linux and other POSIX systems
+
+typedef struct ScioSense_Posix_Termios_Config
+{
+    int         fd;
+    uint32_t    timeout;    // ms to wait for the bytes of a single read
+} ScioSense_Posix_Termios_Config;
+
+static inline uint32_t ScioSense_Posix_Termios_Millis()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)((uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000);
+}
+
+// Opens the serial port non-blocking and configures it for the APC1 (9600 baud, 8N1, raw)
+static inline int8_t ScioSense_Posix_Termios_Open(ScioSense_Posix_Termios_Config* config, const char* path, const uint32_t timeout)
+{
+    struct termios tty;
+
+    config->timeout = timeout;
+    config->fd      = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (config->fd < 0)
+    {
+        return 1; // RESULT_IO_ERROR;
+    }
+
+    if (tcgetattr(config->fd, &tty) != 0)
+    {
+        close(config->fd);
+        config->fd = -1;
+        return 1; // RESULT_IO_ERROR;
+    }
+
+    cfmakeraw(&tty);
+    cfsetispeed(&tty, B9600);
+    cfsetospeed(&tty, B9600);
+    tty.c_cflag    |= (CLOCAL | CREAD);
+    tty.c_cflag    &= ~(CSTOPB | PARENB);
+    tty.c_cc[VMIN]  = 0;
+    tty.c_cc[VTIME] = 0;
+
+    if (tcsetattr(config->fd, TCSANOW, &tty) != 0)
+    {
+        close(config->fd);
+        config->fd = -1;
+        return 1; // RESULT_IO_ERROR;
+    }
+
+    tcflush(config->fd, TCIOFLUSH);
+
+    return 0; // RESULT_OK;
+}
+
+static inline void ScioSense_Posix_Termios_Close(ScioSense_Posix_Termios_Config* config)
+{
+    if (config->fd >= 0)
+    {
+        close(config->fd);
+        config->fd = -1;
+    }
+}
+
+static inline int8_t ScioSense_Posix_Termios_Read(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    ScioSense_Posix_Termios_Config* _config = (ScioSense_Posix_Termios_Config*)config;
+    const uint32_t start                    = ScioSense_Posix_Termios_Millis();
+    size_t len                              = 0;
+
+    while (len < size)
+    {
+        const uint32_t elapsed = ScioSense_Posix_Termios_Millis() - start;
+        if (elapsed >= _config->timeout)
+        {
+            return 1; // RESULT_IO_ERROR;
+        }
+
+        struct pollfd pfd = { _config->fd, POLLIN, 0 };
+        int ready = poll(&pfd, 1, (int)(_config->timeout - elapsed));
+        if (ready < 0 && errno != EINTR)
+        {
+            return 1; // RESULT_IO_ERROR;
+        }
+
+        if (ready > 0)
+        {
+            ssize_t n = read(_config->fd, data + len, size - len);
+            if (n > 0)
+            {
+                len += (size_t)n;
+            }
+            else if (n == 0 || (errno != EAGAIN && errno != EINTR))
+            {
+                return 1; // RESULT_IO_ERROR;
+            }
+        }
+    }
+
+    return 0; // RESULT_OK;
+}
+
+static inline int8_t ScioSense_Posix_Termios_Write(void* config, const uint16_t address, uint8_t* data, const size_t size)
+{
+    ScioSense_Posix_Termios_Config* _config = (ScioSense_Posix_Termios_Config*)config;
+    size_t len                              = 0;
+
+    while (len < size)
+    {
+        ssize_t n = write(_config->fd, data + len, size - len);
+        if (n > 0)
+        {
+            len += (size_t)n;
+        }
+        else if (n < 0 && errno == EAGAIN)
+        {
+            // the output buffer is full; a timeout means the line does not drain
+            struct pollfd pfd = { _config->fd, POLLOUT, 0 };
+            int ready = poll(&pfd, 1, (int)_config->timeout);
+            if (ready == 0 || (ready < 0 && errno != EINTR))
+            {
+                return 1; // RESULT_IO_ERROR;
+            }
+        }
+        else if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else
+        {
+            return 1; // RESULT_IO_ERROR;
+        }
+    }
+
+    return 0; // RESULT_OK;
+}
+
+static inline int8_t ScioSense_Posix_Termios_Clear(void* config)
+{
+    ScioSense_Posix_Termios_Config* _config = (ScioSense_Posix_Termios_Config*)config;
+
+    tcdrain(_config->fd);
+    tcflush(_config->fd, TCIFLUSH);
+
+    return 0; // RESULT_OK
+}
+
+static inline void ScioSense_Posix_Termios_Wait(uint32_t ms)
+{
+    struct timespec duration = { (time_t)(ms / 1000), (long)(ms % 1000) * 1000000L };
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR) { }
+}
+
+#endif // SCIOSENSE_IO_INTERFACE_POSIX_TERMIOS_H